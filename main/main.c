@@ -10,6 +10,7 @@
 #include "time_sync.h"
 #include "log_hook.h"
 #include "nrf24/nrf24.h"
+#include "xiaomi/xiaomi_remotes.h"
 
 static const char* TAG = "MAIN";
 const char* APP_NAME;
@@ -20,11 +21,6 @@ void initialize_components(void) {
 
     log_hook_init();
 
-    esp_err_t nrf_err = nrf24_check_connection();
-    if (nrf_err != ESP_OK) {
-        ESP_LOGW(TAG, "NRF24 check failed: %d", nrf_err);
-    }
-
     esp_err_t err = esp_event_loop_create_default();
     if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
         ESP_LOGE(TAG, "Error on default event loop creation : %d", err);
@@ -37,6 +33,22 @@ void initialize_components(void) {
         esp_deep_sleep_start();
     }
 
+    if (xiaomi_remotes_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Xiaomi remote registry unavailable");
+    }
+
+    // Calibration persists the SPI clock, so the radio comes up once NVS is ready
+    esp_err_t nrf_err = nrf24_init();
+    if (nrf_err == ESP_OK) {
+        nrf_err = nrf24_calibrate_spi();
+    }
+    if (nrf_err == ESP_OK) {
+        nrf_err = nrf24_check_connection();
+    }
+    if (nrf_err != ESP_OK) {
+        ESP_LOGW(TAG, "NRF24 check failed: %d", nrf_err);
+    }
+
     if (wireless_Init() != true) {
         ESP_LOGE(TAG, "wireless initialization failed. Restarting...");
         esp_restart();
@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -11,14 +12,139 @@
 #include <esp_log.h>
 #include <esp_random.h>
 #include <esp_rom_sys.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/queue.h>
 #include <freertos/semphr.h>
 
+#include "nrf24_capture.h"
+#include "nrf24_hal.h"
+#include "nrf24_trace.h"
+#include "nvs.h"
+#include "xiaomi_codec.h"
+#include "xiaomi_events.h"
+#include "xiaomi_state.h"
+#include "xiaomi_topk.h"
+
 static const char* TAG = "NRF24";
 
-// Mutex to protect SPI access from multiple tasks
-static SemaphoreHandle_t nrf24_mutex = NULL;
+// Radio owner task, the only context allowed to touch SPI and CE
+#define NRF24_TASK_STACK 4096
+#define NRF24_TASK_PRIORITY 5
+#define NRF24_QUEUE_LEN 8
+#define NRF24_URGENT_QUEUE_LEN 4
+#define NRF24_JOB_POOL_SIZE 8
+
+// Upper bounds used by the blocking wrappers when waiting on their job
+#define NRF24_TX_WAIT_MS 5000
+#define NRF24_CHECK_WAIT_MS 500
+#define NRF24_BENCH_WAIT_MS 2000
+#define NRF24_CALIBRATE_WAIT_MS 2000
+#define NRF24_SCAN_WAIT_MARGIN_MS 2000
+
+// Scan scheduling: listening goes in dwells of NRF24_SCAN_DWELL_MS, an adaptive scan keeps NRF24_SCAN_EXPLORE_PCT
+// of its time spread evenly over the channels and starts each channel at one frame per NRF24_SCAN_PRIOR_MS
+#define NRF24_SCAN_DWELL_MS 20
+#define NRF24_SCAN_EXPLORE_PCT 20
+#define NRF24_SCAN_PRIOR_MS 200
+
+// Background RPD survey, opt-in: once the radio queue stayed idle for NRF24_SURVEY_IDLE_MS one channel is sampled
+// every NRF24_SURVEY_STEP_MS, the task sleeps in between
+#define NRF24_SURVEY_SAMPLES 16
+#define NRF24_SURVEY_IDLE_MS 100
+#define NRF24_SURVEY_STEP_MS 10
+#define NRF24_SURVEY_EWMA_SHIFT 3
+// RX settling (130 us) plus the 40 us the RPD needs to latch a carrier
+#define NRF24_RPD_SETTLE_US 170
+
+// Idle sniffer channel dwell, and how often it gives way to one survey channel
+#define NRF24_SNIFF_DWELL_MS 20
+#define NRF24_SNIFF_SURVEY_PERIOD_MS 125
+#define NRF24_SNIFF_RETRY_MS 1000
+
+// Upper bound for one frame to leave the TX FIFO, a frame takes ~130 us PLL settling plus ~100 us on air at 2 Mbps
+#define NRF24_TX_DONE_TIMEOUT_US 1000
+#define NRF24_TX_FIFO_DEPTH 3
+
+// A hold is released after this long even without a stop, like a remote whose button got stuck
+#define NRF24_HOLD_MAX_MS 10000
+
+// Period of the background health check, run by the radio task between commands and sniffer dwells
+#define NRF24_HEALTH_PERIOD_MS 30000
+
+// Crystal oscillator startup when PWR_UP is set from power down (Tpd2stby), the chip ignores CE until it is over
+#define NRF24_PWR_UP_US 1500
+
+typedef enum {
+    NRF24_CMD_CHECK,
+    NRF24_CMD_TX_BURST,
+    NRF24_CMD_SCAN,
+    NRF24_CMD_BENCH_SPI,
+    NRF24_CMD_CALIBRATE_SPI,
+    NRF24_CMD_SURVEY,
+    NRF24_CMD_SNIFFER,
+    NRF24_CMD_HOLD,
+    NRF24_CMD_POWER,
+    NRF24_CMD_MULTIPIPE,
+} nrf24_cmd_type_t;
+
+typedef struct {
+    nrf24_cmd_type_t type;
+    nrf24_job_t* job;
+    int64_t queued_us;
+    union {
+        struct {
+            uint32_t remote_ids[NRF24_XIAOMI_GROUP_MAX];
+            uint8_t remote_count;
+            uint8_t count;
+            xiaomi_action_t actions[NRF24_XIAOMI_BURST_MAX];
+        } tx;
+        struct {
+            uint32_t duration_ms;
+            nrf24_scan_options_t options;
+            bool resume;   // Continue a scan preempted by an interactive command
+            bool save_id;  // Store the remote found in NVS once the scan completes
+        } scan;
+        struct {
+            bool enable;
+        } survey;
+        struct {
+            bool enable;
+        } sniffer;
+        struct {
+            bool enable;
+        } multipipe;
+        struct {
+            uint32_t id;
+            uint32_t remote_ids[NRF24_XIAOMI_GROUP_MAX];
+            uint8_t remote_count;
+            uint8_t command;
+            uint16_t steps;
+            uint32_t period_ms;
+        } hold;
+        struct {
+            uint32_t idle_ms;
+        } power;
+    };
+} nrf24_cmd_t;
+
+/// Completion handle shared between the radio task and the submitter
+struct nrf24_job {
+    bool in_use;
+    uint8_t refs;
+    volatile bool done;
+    volatile bool abandoned;  // The submitter stopped waiting, the radio task drops the command if not started
+    esp_err_t result;
+    SemaphoreHandle_t done_sem;
+};
+
+static TaskHandle_t radio_task = NULL;
+static QueueHandle_t radio_queue = NULL;
+// Interactive transmissions (bursts, holds) bypass radio_queue and preempt a running scan at its next channel
+static QueueHandle_t radio_urgent_queue = NULL;
+static nrf24_job_t job_pool[NRF24_JOB_POOL_SIZE];
+static portMUX_TYPE job_lock = portMUX_INITIALIZER_UNLOCKED;
 
 // NRF24L01+ pin definitions
 // Pinout for ESP32 DevKitC
@@ -27,6 +153,7 @@ static SemaphoreHandle_t nrf24_mutex = NULL;
 // SCK  - GPIO18
 // CS   - GPIO5
 // CE   - GPIO4
+// IRQ  - GPIO22 (active low, optional: scans fall back to polling when not wired)
 // GND  - GND
 // VCC  - 3.3V
 
@@ -35,11 +162,46 @@ static SemaphoreHandle_t nrf24_mutex = NULL;
 #define PIN_NUM_CLK 18
 #define PIN_NUM_CS 5
 #define PIN_NUM_CE 4
+#define PIN_NUM_IRQ 22
 
 #define NRF_SPI_HOST SPI3_HOST
 
+// Transfers up to this size use polling transactions, longer ones (payloads) go through the interrupt path
+#define NRF24_SPI_POLL_MAX_BYTES 8
+// Largest prebuilt transaction list, also the device queue depth
+#define NRF24_SPI_BATCH_MAX 32
+#define NRF24_SPI_BENCH_ITERATIONS 256
+// Write/readback rounds a clock must pass to be considered reliable, and the single round of a routine probe
+#define NRF24_SPI_VERIFY_ROUNDS 8
+#define NRF24_SPI_PROBE_ROUNDS 1
+// Consecutive good health checks after a fallback before the configured clock is tried again
+#define NRF24_SPI_CLOCK_RETRY_CHECKS 10
+
+// Clock ladder walked by the calibration, the nRF24L01+ is specified up to 10 MHz
+static const int spi_clock_steps_hz[] = {1000000, 2000000, 4000000, 5000000, 8000000, 10000000};
+#define NRF24_SPI_CLOCK_STEPS (sizeof(spi_clock_steps_hz) / sizeof(spi_clock_steps_hz[0]))
+
+static int spi_clock_hz = 1000000;             // 1 MHz until calibrated
+static int spi_clock_configured_hz = 1000000;  // Calibrated clock, spi_clock_hz only drops below it on fallbacks
+static uint8_t spi_clock_good_checks = 0;      // Good health checks since the last fallback or retry
+
 static spi_device_handle_t nrf_spi;
 static bool spi_bus_initialized = false;
+static bool spi_bus_acquired = false;
+static bool irq_initialized = false;
+// Installed backend, NULL while the ESP-IDF SPI/GPIO path drives the chip
+static const nrf24_hal_t* radio_hal = NULL;
+
+// Task notification bit raised by the IRQ pin ISR
+#define NRF24_NOTIFY_IRQ (1 << 0)
+// Raised on every submit so the idle sniffer yields to queued commands
+#define NRF24_NOTIFY_CMD (1 << 1)
+// Raised by the hold timer on every step deadline
+#define NRF24_NOTIFY_HOLD (1 << 2)
+
+// Task currently waiting on the IRQ line (NULL when nobody listens)
+static TaskHandle_t volatile irq_wait_task = NULL;
+static volatile int64_t irq_timestamp_us = 0;
 
 // Register map
 #define NRF_REG_CONFIG 0x00
@@ -50,14 +212,25 @@ static bool spi_bus_initialized = false;
 #define NRF_REG_RF_CH 0x05
 #define NRF_REG_RF_SETUP 0x06
 #define NRF_REG_STATUS 0x07
+#define NRF_REG_OBSERVE_TX 0x08
+#define NRF_REG_RPD 0x09
 #define NRF_REG_RX_ADDR_P0 0x0A
 #define NRF_REG_RX_ADDR_P1 0x0B
+#define NRF_REG_RX_ADDR_P2 0x0C
+#define NRF_REG_RX_ADDR_P3 0x0D
+#define NRF_REG_RX_ADDR_P4 0x0E
+#define NRF_REG_RX_ADDR_P5 0x0F
 #define NRF_REG_TX_ADDR 0x10
 #define NRF_REG_RX_PW_P0 0x11
 #define NRF_REG_RX_PW_P1 0x12
+#define NRF_REG_RX_PW_P2 0x13
+#define NRF_REG_RX_PW_P3 0x14
+#define NRF_REG_RX_PW_P4 0x15
+#define NRF_REG_RX_PW_P5 0x16
 #define NRF_REG_FIFO_STATUS 0x17
 #define NRF_REG_DYNPD 0x1C
 #define NRF_REG_FEATURE 0x1D
+#define NRF_REG_COUNT 0x1E
 
 // Commands
 #define NRF_CMD_R_REGISTER 0x00
@@ -66,21 +239,375 @@ static bool spi_bus_initialized = false;
 #define NRF_CMD_W_TX_PAYLOAD 0xA0
 #define NRF_CMD_FLUSH_TX 0xE1
 #define NRF_CMD_FLUSH_RX 0xE2
+#define NRF_CMD_NOP 0xFF
 
 // Bit helpers
 #define NRF_STATUS_RX_DR (1 << 6)
 #define NRF_STATUS_TX_DS (1 << 5)
 #define NRF_STATUS_MAX_RT (1 << 4)
+#define NRF_CONFIG_MASK_TX_DS (1 << 5)
+#define NRF_CONFIG_MASK_MAX_RT (1 << 4)
+#define NRF_CONFIG_PWR_UP (1 << 1)
+#define NRF_CONFIG_PRIM_RX (1 << 0)
+#define NRF_STATUS_TX_FULL 0x01
+#define NRF_STATUS_RX_P_NO(status) (((status) >> 1) & 0x07)
 #define NRF_FIFO_RX_EMPTY 0x01
+#define NRF_FIFO_TX_EMPTY (1 << 4)
 
 static xiaomi_scan_result_t last_scan_result = {0};
+// Frequency of decoded (remote, command) pairs and of remotes during the current scan
+static xiaomi_topk_t scan_patterns;
+static xiaomi_topk_t scan_remotes;
+// Guards the ranked part of last_scan_result, which the HTTP server reads while a scan updates it
+static portMUX_TYPE scan_lock = portMUX_INITIALIZER_UNLOCKED;
+// Options of the running scan and the evidence gathered per remote against its confidence rule
+static nrf24_scan_options_t scan_options;
+static struct {
+    uint32_t remote_id;
+    uint8_t presses;        // Distinct sequence numbers heard, the repeats of one press count once
+    uint8_t last_seq;       // Sequence number of the last press counted
+    uint16_t channel_mask;  // Bit i set once heard on scan_options.channels[i]
+} scan_confirm[XIAOMI_SCAN_TOP_REMOTES];
+static size_t scan_confirm_count = 0;
+static uint32_t scan_confirmed_id = 0;
+
+// The asynchronous scan, only touched by the HTTP server task
+static struct {
+    uint32_t id;
+    nrf24_job_t* job;
+    uint32_t start_ms;
+    uint32_t duration_ms;
+    bool done;
+    esp_err_t result;
+} scan_session;
+static uint32_t scan_next_id = 1;
+// Listening time given to each channel of the running scan, and the next channel of a round robin scan
+static int64_t scan_dwell_us[NRF24_SCAN_CHANNELS_MAX];
+static size_t scan_cursor = 0;
+// Scan suspended by an interactive command, the radio task resumes it once the urgent queue is empty
+static nrf24_cmd_t scan_suspended;
+static bool scan_is_suspended = false;
+// Sequence numbers are reserved in NVS by blocks so a reboot never replays a recent one, at one write per block.
+// A hold reserves its steps up front, at most XIAOMI_SEQ_AHEAD_MAX so the resume point stays ahead in 8-bit order
+#define XIAOMI_SEQ_BLOCK 16
+#define XIAOMI_SEQ_AHEAD_MAX 128
 static uint8_t xiaomi_tx_seq = 0;
+static uint8_t xiaomi_tx_seq_reserved = 0;
+// Static frame bytes of the remotes of the last burst, slot i holds the i-th remote of the group
+static xiaomi_template_t xiaomi_tx_templates[NRF24_XIAOMI_GROUP_MAX] = {0};
+static bool xiaomi_tx_templates_valid[NRF24_XIAOMI_GROUP_MAX] = {0};
+// Frames of the command currently on air, one per remote
+static uint8_t xiaomi_tx_frames[NRF24_XIAOMI_GROUP_MAX][XIAOMI_FRAME_LEN];
+
+// Held command: the periodic timer paces the steps, the radio task publishes its timing in hold_progress
+static esp_timer_handle_t hold_timer = NULL;
+static volatile bool hold_stop = false;
+static nrf24_hold_status_t hold_progress;
+static portMUX_TYPE hold_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// The asynchronous hold, only touched by the HTTP server task. queued is reported until the radio task picks the
+// hold up and publishes it in hold_progress
+static struct {
+    uint32_t id;
+    nrf24_job_t* job;
+    nrf24_hold_status_t queued;
+} hold_session;
+static uint32_t hold_next_id = 1;
 
+/// One register assignment of a radio profile, address registers use up to 5 bytes
 typedef struct {
-    uint32_t id;
-    uint16_t cmd;
-    uint8_t seq;
-} xiaomi_packet_t;
+    uint8_t reg;
+    uint8_t len;
+    uint8_t value[5];
+} nrf24_reg_value_t;
+
+/// Named register set that puts the radio in a given mode
+typedef struct {
+    const char* name;
+    const nrf24_reg_value_t* regs;
+    size_t count;
+} nrf24_profile_t;
+
+// Xiaomi broadcast: no auto-ack, 5-byte address 67 22 .., 2 Mbps, PWR_UP in PTX mode
+static const nrf24_reg_value_t xiaomi_tx_regs[] = {
+    {NRF_REG_EN_AA, 1, {0x00}},
+    {NRF_REG_SETUP_RETR, 1, {0x00}},
+    {NRF_REG_EN_RXADDR, 1, {0x01}},
+    {NRF_REG_SETUP_AW, 1, {0x03}},
+    {NRF_REG_DYNPD, 1, {0x00}},
+    {NRF_REG_FEATURE, 1, {0x00}},
+    {NRF_REG_RF_SETUP, 1, {0x0E}},
+    {NRF_REG_RX_PW_P0, 1, {32}},
+    {NRF_REG_TX_ADDR, 5, {0x67, 0x22, 0x00, 0x00, 0x00}},
+    {NRF_REG_RX_ADDR_P0, 5, {0x67, 0x22, 0x00, 0x00, 0x00}},
+    {NRF_REG_CONFIG, 1, {0x02}},
+};
+
+// Xiaomi sniffer: AA AA .. address trick on pipe 0, 32-byte payloads, PRIM_RX with only RX_DR on the IRQ pin
+static const nrf24_reg_value_t xiaomi_sniff_regs[] = {
+    {NRF_REG_EN_AA, 1, {0x00}},
+    {NRF_REG_SETUP_RETR, 1, {0x00}},
+    {NRF_REG_EN_RXADDR, 1, {0x01}},
+    {NRF_REG_SETUP_AW, 1, {0x03}},
+    {NRF_REG_DYNPD, 1, {0x00}},
+    {NRF_REG_FEATURE, 1, {0x00}},
+    {NRF_REG_RF_SETUP, 1, {0x0E}},
+    {NRF_REG_RX_PW_P0, 1, {32}},
+    {NRF_REG_RX_ADDR_P0, 5, {0xAA, 0xAA, 0xAA, 0xAA, 0xAA}},
+    {NRF_REG_CONFIG, 1, {0x03 | NRF_CONFIG_MASK_TX_DS | NRF_CONFIG_MASK_MAX_RT}},
+};
+
+// Multi-pipe capture: 3-byte addresses so pipes 1..5 share a 2-byte prefix of zeros, the quiet carrier the
+// demodulator outputs before a packet, and differ in the byte that follows. On air (first byte first):
+//   P0 AA AA AA  the single pipe trick, shortened
+//   P1 00 00 55  preamble of addresses starting with a 0 bit, byte aligned
+//   P2 00 00 AA  preamble of addresses starting with a 1 bit
+//   P3 00 00 2A  0x55 preamble one bit late, or 0xAA two bits late
+//   P4 00 00 15  0x55 preamble two bits late
+//   P5 00 00 22  middle of the Xiaomi address 00 00 00 22 67, the frame follows after one byte
+// Register values are written least significant byte first, the reverse of the air order
+static const nrf24_reg_value_t xiaomi_sniff_multi_regs[] = {
+    {NRF_REG_EN_AA, 1, {0x00}},
+    {NRF_REG_SETUP_RETR, 1, {0x00}},
+    {NRF_REG_EN_RXADDR, 1, {0x3F}},
+    {NRF_REG_SETUP_AW, 1, {0x01}},
+    {NRF_REG_DYNPD, 1, {0x00}},
+    {NRF_REG_FEATURE, 1, {0x00}},
+    {NRF_REG_RF_SETUP, 1, {0x0E}},
+    {NRF_REG_RX_PW_P0, 1, {32}},
+    {NRF_REG_RX_PW_P1, 1, {32}},
+    {NRF_REG_RX_PW_P2, 1, {32}},
+    {NRF_REG_RX_PW_P3, 1, {32}},
+    {NRF_REG_RX_PW_P4, 1, {32}},
+    {NRF_REG_RX_PW_P5, 1, {32}},
+    {NRF_REG_RX_ADDR_P0, 3, {0xAA, 0xAA, 0xAA}},
+    {NRF_REG_RX_ADDR_P1, 3, {0x55, 0x00, 0x00}},
+    {NRF_REG_RX_ADDR_P2, 1, {0xAA}},
+    {NRF_REG_RX_ADDR_P3, 1, {0x2A}},
+    {NRF_REG_RX_ADDR_P4, 1, {0x15}},
+    {NRF_REG_RX_ADDR_P5, 1, {0x22}},
+    {NRF_REG_CONFIG, 1, {0x03 | NRF_CONFIG_MASK_TX_DS | NRF_CONFIG_MASK_MAX_RT}},
+};
+
+static const nrf24_profile_t profile_xiaomi_tx = {
+    .name = "xiaomi_tx",
+    .regs = xiaomi_tx_regs,
+    .count = sizeof(xiaomi_tx_regs) / sizeof(xiaomi_tx_regs[0]),
+};
+
+static const nrf24_profile_t profile_xiaomi_sniff = {
+    .name = "xiaomi_sniff",
+    .regs = xiaomi_sniff_regs,
+    .count = sizeof(xiaomi_sniff_regs) / sizeof(xiaomi_sniff_regs[0]),
+};
+
+static const nrf24_profile_t profile_xiaomi_sniff_multi = {
+    .name = "xiaomi_sniff_multi",
+    .regs = xiaomi_sniff_multi_regs,
+    .count = sizeof(xiaomi_sniff_multi_regs) / sizeof(xiaomi_sniff_multi_regs[0]),
+};
+
+// Scans, the sniffer and the survey listen through the multi-pipe profile when set
+static bool capture_multipipe = false;
+
+/// @brief Profile the radio listens with
+/// @return Multi-pipe or single pipe sniffer profile
+static const nrf24_profile_t* nrf24_listen_profile(void) {
+    return capture_multipipe ? &profile_xiaomi_sniff_multi : &profile_xiaomi_sniff;
+}
+
+// In-RAM mirror of the register file, kept in sync by every register write and read
+static uint8_t reg_shadow[NRF_REG_COUNT][5];
+static uint32_t reg_shadow_valid = 0;
+
+static nrf24_stats_t radio_stats = {.spi_clock_hz = 1000000};
+
+// Power manager: the radio task parks the chip in power down once no command came for power_idle_ms, the next
+// profile load powers it up again. power_stats is updated by the radio task and read by the HTTP server
+static uint32_t power_idle_ms = NRF24_POWER_IDLE_DEFAULT_MS;
+static bool power_parked = false;
+static bool ce_level = false;
+static int64_t power_since_us = 0;
+static int64_t power_last_cmd_us = 0;
+static nrf24_power_stats_t power_stats = {.state = NRF24_POWER_DOWN};
+static portMUX_TYPE power_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/// @brief Derives the chip state from the mirrored CONFIG and the CE level, and books the time spent in the
+/// previous one
+static void nrf24_power_track(void) {
+    if ((reg_shadow_valid & (1UL << NRF_REG_CONFIG)) == 0) {
+        return;
+    }
+
+    uint8_t config = reg_shadow[NRF_REG_CONFIG][0];
+    uint8_t state = NRF24_POWER_DOWN;
+    if (config & NRF_CONFIG_PWR_UP) {
+        state = !ce_level ? NRF24_POWER_STANDBY : ((config & NRF_CONFIG_PRIM_RX) ? NRF24_POWER_RX : NRF24_POWER_TX);
+    }
+    if (state == power_stats.state) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&power_lock);
+    power_stats.time_us[power_stats.state] += (uint64_t)(now - power_since_us);
+    power_stats.state = state;
+    power_since_us = now;
+    portEXIT_CRITICAL(&power_lock);
+}
+
+/// @brief Tells whether a register can be mirrored
+/// STATUS is write-1-to-clear and OBSERVE_TX, RPD, FIFO_STATUS change on their own, those always hit the bus
+/// @param reg Register address
+/// @return true if the shadow may be used for this register
+static bool nrf24_shadow_cacheable(uint8_t reg) {
+    return reg < NRF_REG_COUNT && reg != NRF_REG_STATUS && reg != NRF_REG_OBSERVE_TX && reg != NRF_REG_RPD &&
+           reg != NRF_REG_FIFO_STATUS;
+}
+
+/// @brief Checks if a register already holds the given value
+/// @param reg Register address
+/// @param data Value to compare against the mirror
+/// @param len Number of bytes (maximum 5)
+/// @return true if the write can be skipped
+static bool nrf24_shadow_matches(uint8_t reg, const uint8_t* data, size_t len) {
+    if (!nrf24_shadow_cacheable(reg) || (reg_shadow_valid & (1UL << reg)) == 0) {
+        return false;
+    }
+
+    return memcmp(reg_shadow[reg], data, len) == 0;
+}
+
+/// @brief Records a value known to be in a register
+/// @param reg Register address
+/// @param data Register content
+/// @param len Number of bytes (maximum 5)
+static void nrf24_shadow_store(uint8_t reg, const uint8_t* data, size_t len) {
+    if (!nrf24_shadow_cacheable(reg)) {
+        return;
+    }
+
+    memcpy(reg_shadow[reg], data, len);
+    reg_shadow_valid |= (1UL << reg);
+    if (reg == NRF_REG_CONFIG) {
+        nrf24_power_track();
+    }
+}
+
+/// @brief Forgets the whole mirror, used when the chip state is unknown (boot, reset, SPI error)
+static void nrf24_shadow_invalidate(void) { reg_shadow_valid = 0; }
+
+/// Prebuilt list of register writes executed back to back
+typedef struct {
+    spi_transaction_t trans[NRF24_SPI_BATCH_MAX];
+    uint8_t tx[NRF24_SPI_BATCH_MAX][1 + 5];
+    size_t count;
+} nrf24_spi_batch_t;
+
+static nrf24_spi_bench_t last_bench = {0};
+
+// Rolling RPD hit ratio per channel (Q16), survey_sweeps counts completed 0..125 sweeps
+static uint16_t survey_occupancy[NRF24_CHANNEL_COUNT] = {0};
+static uint8_t survey_next_channel = 0;
+static volatile uint32_t survey_sweeps = 0;
+static volatile bool survey_enabled = false;
+
+// Set by the first successful connection check, idle work (survey, sniffer) only runs on a radio that answered
+static volatile bool radio_ready = false;
+// Health record published by the radio task, the status endpoint reads it without touching the bus
+static nrf24_health_t radio_health;
+static portMUX_TYPE health_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t health_next_us = 0;
+// Continuous sniff mode, the radio listens between commands and feeds the event ring
+static volatile bool sniff_enabled = false;
+static uint8_t sniff_channel_index = 0;
+
+/// @brief Runs one SPI transaction against the radio and counts it
+/// Register sized transfers use a polling transaction, which skips the interrupt and task switch of
+/// spi_device_transmit and is cheapest while the radio task holds the bus
+/// @param t Transaction to execute
+/// @return ESP_OK on success, error code on failure
+static esp_err_t nrf24_spi_transfer(spi_transaction_t* t) {
+    esp_err_t err;
+
+    radio_stats.spi_transactions++;
+    if (radio_hal != NULL) {
+        err = radio_hal->transfer(radio_hal->ctx, t->tx_buffer, t->rx_buffer, t->length / 8);
+    } else if (t->length <= NRF24_SPI_POLL_MAX_BYTES * 8) {
+        err = spi_device_polling_transmit(nrf_spi, t);
+    } else {
+        err = spi_device_transmit(nrf_spi, t);
+    }
+
+    // Single writer, an aligned word store is atomic against the status reader
+    if (err != ESP_OK) {
+        radio_health.spi_errors++;
+    }
+    return err;
+}
+
+/// @brief Appends a register write to a batch
+/// @param batch Batch to fill
+/// @param reg The register address to write to
+/// @param data Bytes to write
+/// @param len Number of bytes (maximum 5)
+/// @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the batch is full
+static esp_err_t nrf24_batch_add_write(nrf24_spi_batch_t* batch, uint8_t reg, const uint8_t* data, size_t len) {
+    if (batch->count >= NRF24_SPI_BATCH_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (len > 5) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t* tx = batch->tx[batch->count];
+    tx[0] = NRF_CMD_W_REGISTER | (reg & 0x1F);
+    memcpy(&tx[1], data, len);
+
+    batch->trans[batch->count] = (spi_transaction_t){
+        .length = (1 + len) * 8,
+        .tx_buffer = tx,
+    };
+    batch->count++;
+
+    return ESP_OK;
+}
+
+/// @brief Queues every transaction of a batch at once and collects the results
+/// @param batch Batch to run, left untouched so it can be replayed
+/// @return ESP_OK on success, error code on the first failure
+static esp_err_t nrf24_batch_run(nrf24_spi_batch_t* batch) {
+    esp_err_t err = ESP_OK;
+    size_t queued = 0;
+
+    if (radio_hal != NULL) {
+        for (size_t i = 0; i < batch->count && err == ESP_OK; i++) {
+            err = nrf24_spi_transfer(&batch->trans[i]);
+        }
+        return err;
+    }
+
+    for (; queued < batch->count; queued++) {
+        err = spi_device_queue_trans(nrf_spi, &batch->trans[queued], portMAX_DELAY);
+        if (err != ESP_OK) {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < queued; i++) {
+        spi_transaction_t* done = NULL;
+        esp_err_t res = spi_device_get_trans_result(nrf_spi, &done, portMAX_DELAY);
+        if (res != ESP_OK && err == ESP_OK) {
+            err = res;
+        }
+    }
+
+    radio_stats.spi_transactions += queued;
+    if (err != ESP_OK) {
+        radio_health.spi_errors++;
+    }
+    return err;
+}
 
 /// @brief Writes a value to a single register of the nRF24L01+ module
 /// @param reg The register address to write to
@@ -88,6 +615,11 @@ typedef struct {
 /// @param status Pointer to store the status byte returned by the nRF24L01+ (can be NULL if not needed)
 /// @return ESP_OK on success, error code on failure
 static esp_err_t nrf24_write_register(uint8_t reg, uint8_t value, uint8_t* status) {
+    if (status == NULL && nrf24_shadow_matches(reg, &value, 1)) {
+        radio_stats.spi_saved++;
+        return ESP_OK;
+    }
+
     uint8_t tx_data[2] = {(uint8_t)(0x20 | (reg & 0x1F)), value};
     uint8_t rx_data[2] = {0};
 
@@ -97,10 +629,12 @@ static esp_err_t nrf24_write_register(uint8_t reg, uint8_t value, uint8_t* statu
         .rx_buffer = rx_data,
     };
 
-    esp_err_t err = spi_device_transmit(nrf_spi, &t);
+    esp_err_t err = nrf24_spi_transfer(&t);
     if (err != ESP_OK) {
+        nrf24_shadow_invalidate();
         return err;
     }
+    nrf24_shadow_store(reg, &value, 1);
     if (status) {
         *status = rx_data[0];
     }
@@ -119,7 +653,7 @@ static esp_err_t nrf24_command(uint8_t cmd, uint8_t* status) {
         .tx_buffer = &cmd,
         .rx_buffer = &rx,
     };
-    esp_err_t err = spi_device_transmit(nrf_spi, &t);
+    esp_err_t err = nrf24_spi_transfer(&t);
     if (err != ESP_OK) {
         return err;
     }
@@ -141,6 +675,10 @@ static esp_err_t nrf24_write_register_buf(uint8_t reg, const uint8_t* data, size
     if (len > 5) {
         return ESP_ERR_INVALID_ARG;
     }
+    if (nrf24_shadow_matches(reg, data, len)) {
+        radio_stats.spi_saved++;
+        return ESP_OK;
+    }
     tx_data[0] = NRF_CMD_W_REGISTER | (reg & 0x1F);
     for (size_t i = 0; i < len; i++) {
         tx_data[1 + i] = data[i];
@@ -152,18 +690,125 @@ static esp_err_t nrf24_write_register_buf(uint8_t reg, const uint8_t* data, size
         .rx_buffer = rx_data,
     };
 
-    return spi_device_transmit(nrf_spi, &t);
+    esp_err_t err = nrf24_spi_transfer(&t);
+    if (err != ESP_OK) {
+        nrf24_shadow_invalidate();
+        return err;
+    }
+    nrf24_shadow_store(reg, data, len);
+
+    return ESP_OK;
+}
+
+/// @brief GPIO ISR for the nRF24 IRQ pin, wakes the task waiting for radio events
+/// @param arg Unused
+static void IRAM_ATTR nrf24_irq_isr(void* arg) {
+    TaskHandle_t task = irq_wait_task;
+    if (task == NULL) {
+        return;
+    }
+
+    BaseType_t woken = pdFALSE;
+    irq_timestamp_us = esp_timer_get_time();
+    xTaskNotifyFromISR(task, NRF24_NOTIFY_IRQ, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/// @brief Reports a falling edge on the IRQ line of an installed backend, the task context twin of nrf24_irq_isr
+void nrf24_hal_irq(void) {
+    TaskHandle_t task = irq_wait_task;
+    if (task == NULL) {
+        return;
+    }
+
+    irq_timestamp_us = esp_timer_get_time();
+    xTaskNotify(task, NRF24_NOTIFY_IRQ, eSetBits);
+}
+
+/// @brief Configures the IRQ pin as a falling edge interrupt source
+/// @return ESP_OK on success, error code on failure
+static esp_err_t nrf24_init_irq(void) {
+    if (irq_initialized) {
+        return ESP_OK;
+    }
+
+    gpio_config_t irq_conf = {
+        .pin_bit_mask = BIT64(PIN_NUM_IRQ),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+    esp_err_t err = gpio_config(&irq_conf);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "GPIO ISR service install failed: %d", err);
+        return err;
+    }
+
+    err = gpio_isr_handler_add(PIN_NUM_IRQ, nrf24_irq_isr, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "IRQ handler add failed: %d", err);
+        return err;
+    }
+
+    irq_initialized = true;
+    return ESP_OK;
+}
+
+/// @brief Number of commands waiting in both radio queues
+/// @return Queued command count
+static UBaseType_t nrf24_cmd_pending(void) {
+    return uxQueueMessagesWaiting(radio_urgent_queue) + uxQueueMessagesWaiting(radio_queue);
+}
+
+/// @brief Blocks the calling task until a command is queued or the timeout expires, without taking it
+/// @param ticks Maximum time to wait
+/// @return true if a command is pending
+static bool nrf24_wait_cmd(TickType_t ticks) {
+    TickType_t start = xTaskGetTickCount();
+    while (nrf24_cmd_pending() == 0) {
+        TickType_t spent = xTaskGetTickCount() - start;
+        if (spent >= ticks) {
+            return false;
+        }
+        xTaskNotifyWait(0, NRF24_NOTIFY_CMD, NULL, ticks - spent);
+    }
+
+    return true;
+}
+
+/// @brief Blocks the calling task until the IRQ line fires or the timeout expires
+/// An interactive command ends the wait early so a scan dwell does not delay it
+/// @param ticks Maximum time to wait
+/// @return true if the IRQ fired, false on timeout or when an interactive command is queued
+static bool nrf24_wait_irq(TickType_t ticks) {
+    TickType_t start = xTaskGetTickCount();
+    for (;;) {
+        uint32_t bits = 0;
+        TickType_t spent = xTaskGetTickCount() - start;
+        if (spent >= ticks ||
+            xTaskNotifyWait(0, NRF24_NOTIFY_IRQ | NRF24_NOTIFY_CMD, &bits, ticks - spent) != pdTRUE) {
+            return false;
+        }
+        if (bits & NRF24_NOTIFY_IRQ) {
+            return true;
+        }
+        if (uxQueueMessagesWaiting(radio_urgent_queue) > 0) {
+            return false;
+        }
+    }
 }
 
 /// @brief Initializes the NRF24L01+ wireless transceiver module
 /// @return ESP_OK on success, error code on failure
 static esp_err_t nrf24_init_spi(void) {
-    if (nrf24_mutex == NULL) {
-        nrf24_mutex = xSemaphoreCreateMutex();
-        if (nrf24_mutex == NULL) {
-            ESP_LOGE(TAG, "Failed to create nrf24 mutex");
-            return ESP_ERR_NO_MEM;
-        }
+    if (nrf_spi != NULL || radio_hal != NULL) {
+        return ESP_OK;
     }
 
     gpio_config_t io_conf = {
@@ -187,10 +832,10 @@ static esp_err_t nrf24_init_spi(void) {
     };
 
     spi_device_interface_config_t devcfg = {
-        .clock_speed_hz = 1 * 1000 * 1000,  // 1 MHz for bring-up
+        .clock_speed_hz = spi_clock_hz,
         .mode = 0,
         .spics_io_num = PIN_NUM_CS,
-        .queue_size = 1,
+        .queue_size = NRF24_SPI_BATCH_MAX,
     };
 
     esp_err_t err;
@@ -211,9 +856,74 @@ static esp_err_t nrf24_init_spi(void) {
         }
     }
 
+    err = nrf24_init_irq();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "IRQ pin unavailable, RX falls back to polling: %d", err);
+    }
+
+    return ESP_OK;
+}
+
+/// @brief Initializes SPI if needed and holds the bus for a whole radio operation
+/// @return ESP_OK on success, error code on failure
+static esp_err_t nrf24_spi_acquire(void) {
+    esp_err_t err = nrf24_init_spi();
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (spi_bus_acquired || radio_hal != NULL) {
+        return ESP_OK;
+    }
+
+    err = spi_device_acquire_bus(nrf_spi, portMAX_DELAY);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "SPI bus acquire failed: %d", err);
+        return err;
+    }
+    spi_bus_acquired = true;
+
     return ESP_OK;
 }
 
+/// @brief Releases the bus taken by nrf24_spi_acquire
+static void nrf24_spi_release(void) {
+    if (spi_bus_acquired) {
+        spi_device_release_bus(nrf_spi);
+        spi_bus_acquired = false;
+    }
+}
+
+/// @brief Re-adds the SPI device with a new clock, keeping the bus held if it was
+/// The register mirror is dropped on a change, writes at the old clock may have been the ones that failed
+/// @param clock_hz New SPI clock in Hz
+/// @return ESP_OK on success, error code on failure
+static esp_err_t nrf24_spi_set_clock(int clock_hz) {
+    if (clock_hz != spi_clock_hz) {
+        nrf24_shadow_invalidate();
+    }
+    if (radio_hal != NULL) {
+        // The backend has no clock to change, the calibration still walks the ladder against it
+        spi_clock_hz = clock_hz;
+        radio_stats.spi_clock_hz = (uint32_t)clock_hz;
+        return ESP_OK;
+    }
+    if (nrf_spi != NULL && clock_hz == spi_clock_hz) {
+        return ESP_OK;
+    }
+
+    bool reacquire = spi_bus_acquired;
+    nrf24_spi_release();
+    if (nrf_spi != NULL) {
+        spi_bus_remove_device(nrf_spi);
+        nrf_spi = NULL;
+    }
+
+    spi_clock_hz = clock_hz;
+    radio_stats.spi_clock_hz = (uint32_t)clock_hz;
+
+    return reacquire ? nrf24_spi_acquire() : nrf24_init_spi();
+}
+
 /// @brief Writes a single byte value to a specified register on the nRF24L01+ device
 /// @param reg The register address to write to
 /// @param value The byte value to write to the register
@@ -229,10 +939,14 @@ static esp_err_t nrf24_read_register(uint8_t reg, uint8_t* value, uint8_t* statu
         .rx_buffer = rx_data,
     };
 
-    esp_err_t err = spi_device_transmit(nrf_spi, &t);
+    esp_err_t err = nrf24_spi_transfer(&t);
     if (err != ESP_OK) {
         return err;
     }
+    // Address registers are multi-byte, a single byte read does not describe them
+    if (reg != NRF_REG_RX_ADDR_P0 && reg != NRF_REG_RX_ADDR_P1 && reg != NRF_REG_TX_ADDR) {
+        nrf24_shadow_store(reg, &rx_data[1], 1);
+    }
 
     if (value) {
         *value = rx_data[1];
@@ -244,149 +958,282 @@ static esp_err_t nrf24_read_register(uint8_t reg, uint8_t* value, uint8_t* statu
     return ESP_OK;
 }
 
-/// @brief Computes CRC-16-CCITT checksum for given data
-/// @param data Pointer to the data buffer
-/// @param len Length of the data buffer in bytes
-/// @return Computed CRC-16 checksum
-static uint16_t nrf24_crc16(const uint8_t* data, size_t len) {
-    uint16_t crc = 0xFFFE;
-    for (size_t i = 0; i < len; i++) {
-        crc ^= (uint16_t)data[i] << 8;
-        for (int b = 0; b < 8; b++) {
-            if (crc & 0x8000) {
-                crc = (crc << 1) ^ 0x1021;
-            } else {
-                crc <<= 1;
+/// @brief Reads multiple bytes from a specified register on the nRF24L01+ device
+/// @param reg The register address to read from
+/// @param data Pointer to the buffer receiving the register content
+/// @param len The number of bytes to read (maximum 5)
+/// @return ESP_OK on success, error code on failure
+static esp_err_t nrf24_read_register_buf(uint8_t reg, uint8_t* data, size_t len) {
+    uint8_t tx_data[1 + 5];
+    uint8_t rx_data[1 + 5] = {0};
+    if (len > 5) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(tx_data, 0xFF, sizeof(tx_data));
+    tx_data[0] = NRF_CMD_R_REGISTER | (reg & 0x1F);
+
+    spi_transaction_t t = {
+        .length = (1 + len) * 8,
+        .tx_buffer = tx_data,
+        .rx_buffer = rx_data,
+    };
+
+    esp_err_t err = nrf24_spi_transfer(&t);
+    if (err != ESP_OK) {
+        return err;
+    }
+    memcpy(data, &rx_data[1], len);
+
+    return ESP_OK;
+}
+
+/// @brief Checks the link at the current clock with write/readback patterns on TX_ADDR
+/// TX_ADDR is used as a 5-byte scratch register, its shadow entry is dropped so the next profile restores it
+/// @param rounds NRF24_SPI_VERIFY_ROUNDS to qualify a clock, NRF24_SPI_PROBE_ROUNDS for a routine probe
+/// @return true if every pattern read back intact
+static bool nrf24_spi_verify(int rounds) {
+    static const uint8_t patterns[][5] = {
+        {0x55, 0xAA, 0x55, 0xAA, 0x55}, {0xAA, 0x55, 0xAA, 0x55, 0xAA}, {0x00, 0xFF, 0x00, 0xFF, 0x00},
+        {0x01, 0x02, 0x04, 0x08, 0x10}, {0xFE, 0xFD, 0xFB, 0xF7, 0xEF},
+    };
+
+    bool ok = true;
+    for (int round = 0; round < rounds && ok; round++) {
+        for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]) && ok; p++) {
+            uint8_t readback[5] = {0};
+            reg_shadow_valid &= ~(1UL << NRF_REG_TX_ADDR);
+            ok = nrf24_write_register_buf(NRF_REG_TX_ADDR, patterns[p], sizeof(patterns[p])) == ESP_OK &&
+                 nrf24_read_register_buf(NRF_REG_TX_ADDR, readback, sizeof(readback)) == ESP_OK &&
+                 memcmp(readback, patterns[p], sizeof(readback)) == 0;
+        }
+    }
+
+    reg_shadow_valid &= ~(1UL << NRF_REG_TX_ADDR);
+    return ok;
+}
+
+/// @brief Finds the fastest reliable SPI clock and persists it
+/// A previously persisted clock is verified first, the full ladder is only walked when it fails or is missing
+/// @return ESP_OK on success, ESP_FAIL if the radio does not answer even at the lowest clock
+static esp_err_t nrf24_radio_calibrate_spi(void) {
+    uint32_t stored_hz = 0;
+    if (nvs_load_nrf24_spi_clock(&stored_hz)) {
+        for (size_t i = 0; i < NRF24_SPI_CLOCK_STEPS; i++) {
+            if ((uint32_t)spi_clock_steps_hz[i] != stored_hz) {
+                continue;
             }
+            if (nrf24_spi_set_clock(spi_clock_steps_hz[i]) == ESP_OK && nrf24_spi_verify(NRF24_SPI_VERIFY_ROUNDS)) {
+                ESP_LOGI(TAG, "SPI clock %lu Hz restored from NVS", (unsigned long)stored_hz);
+                spi_clock_configured_hz = spi_clock_hz;
+                return ESP_OK;
+            }
+            ESP_LOGW(TAG, "Stored SPI clock %lu Hz failed verification, recalibrating", (unsigned long)stored_hz);
         }
     }
 
-    return crc;
-}
-
-/// @brief Applies Xiaomi whitening/scrambling to packet data
-/// @param data Pointer to data buffer (will be modified in-place)
-/// @param len Length of data buffer
-static void nrf24_xiaomi_whiten(uint8_t* data, size_t len) {
-    // Whitening pattern (18 bytes)
-    // Bytes 0-11: fixed mask; Byte 12: 0x90; Byte 13: 0x00; Byte 14: 0xBC; Bytes 15-17: 0x00
-    static const uint8_t whitening_pattern[18] = {0xFA, 0xA5, 0x9E, 0xB3, 0x92, 0x6D, 0xAE, 0x1B, 0x48,
-                                                  0x1D, 0x2E, 0x80, 0x90, 0x00, 0xBC, 0x00, 0x00, 0x00};
-
-    size_t n = (len < 18) ? len : 18;
-    for (size_t i = 0; i < n; i++) {
-        data[i] ^= whitening_pattern[i];
-    }
-}
-
-/// @brief Builds a Xiaomi packet frame (18 bytes) using CRC+whitening algorithm
-/// Structure (plaintext before whitening):
-/// [0-7]  preamble 53 39 14 DD 1C 49 34 12
-/// [8-10] remote id (MSB..LSB)
-/// [11]   0xFF
-/// [12]   sequence
-/// [13]   command (1 byte)
-/// [14]   parameter/brightness (1 byte)
-/// [15-16] CRC16-CCITT over bytes 0-14 (big-endian)
-/// [17]   padding (0x00)
-/// @param remote_id 24-bit remote id (e.g., 0x701634)
-/// @param seq Sequence value
-/// @param cmd Command byte (e.g., 0x01=ON, 0x02=OFF, 0x81/0x82=brightness)
-/// @param param Parameter/brightness byte
-/// @param output Buffer to store the 18-byte whitened frame
-/// @return ESP_OK
-static esp_err_t nrf24_build_xiaomi_frame(uint32_t remote_id, uint8_t seq, uint8_t cmd, uint8_t param,
-                                          uint8_t* output) {
-    if (output == NULL || remote_id > 0xFFFFFF) {
-        return ESP_ERR_INVALID_ARG;
+    int best_hz = 0;
+    for (size_t i = 0; i < NRF24_SPI_CLOCK_STEPS; i++) {
+        if (nrf24_spi_set_clock(spi_clock_steps_hz[i]) != ESP_OK || !nrf24_spi_verify(NRF24_SPI_VERIFY_ROUNDS)) {
+            break;
+        }
+        best_hz = spi_clock_steps_hz[i];
+    }
+
+    if (best_hz == 0) {
+        ESP_LOGE(TAG, "SPI calibration failed, radio does not answer at %d Hz", spi_clock_steps_hz[0]);
+        nrf24_spi_set_clock(spi_clock_steps_hz[0]);
+        return ESP_FAIL;
+    }
+
+    esp_err_t err = nrf24_spi_set_clock(best_hz);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    ESP_LOGI(TAG, "SPI clock calibrated to %d Hz", best_hz);
+    spi_clock_configured_hz = best_hz;
+    if (!nvs_save_nrf24_spi_clock((uint32_t)best_hz)) {
+        ESP_LOGW(TAG, "Failed to persist SPI clock");
+    }
+
+    return ESP_OK;
+}
+
+/// @brief Steps the SPI clock down until write/readback verification passes again
+/// The lower clock is not persisted, nrf24_spi_clock_retry goes back to the configured one once checks pass again
+/// @return ESP_OK if a working clock was found, ESP_FAIL otherwise
+static esp_err_t nrf24_spi_fallback(void) {
+    for (size_t i = NRF24_SPI_CLOCK_STEPS; i-- > 0;) {
+        if (spi_clock_steps_hz[i] >= spi_clock_hz) {
+            continue;
+        }
+
+        ESP_LOGW(TAG, "SPI readback failing at %d Hz, falling back to %d Hz", spi_clock_hz, spi_clock_steps_hz[i]);
+        radio_stats.spi_clock_fallbacks++;
+        spi_clock_good_checks = 0;
+        if (nrf24_spi_set_clock(spi_clock_steps_hz[i]) != ESP_OK) {
+            continue;
+        }
+        if (nrf24_spi_verify(NRF24_SPI_VERIFY_ROUNDS)) {
+            return ESP_OK;
+        }
     }
 
-    // Build plaintext packet before whitening
-    uint8_t packet[18] = {0};
+    return ESP_FAIL;
+}
 
-    // Preamble 8 bytes
-    const uint8_t preamble[8] = {0x53, 0x39, 0x14, 0xDD, 0x1C, 0x49, 0x34, 0x12};
-    memcpy(packet, preamble, 8);
+/// @brief Tries the configured SPI clock again after a run of good health checks at a fallback clock
+/// A clock that still fails the full verify is dropped again and retried after the next run
+static void nrf24_spi_clock_retry(void) {
+    if (spi_clock_hz >= spi_clock_configured_hz || ++spi_clock_good_checks < NRF24_SPI_CLOCK_RETRY_CHECKS) {
+        return;
+    }
+    spi_clock_good_checks = 0;
 
-    // Remote ID 3 bytes
-    packet[8] = (remote_id >> 16) & 0xFF;
-    packet[9] = (remote_id >> 8) & 0xFF;
-    packet[10] = remote_id & 0xFF;
+    int fallback_hz = spi_clock_hz;
+    if (nrf24_spi_set_clock(spi_clock_configured_hz) == ESP_OK && nrf24_spi_verify(NRF24_SPI_VERIFY_ROUNDS)) {
+        ESP_LOGI(TAG, "SPI clock back to %d Hz", spi_clock_hz);
+        return;
+    }
 
-    // Separator always 0xFF
-    packet[11] = 0xFF;
+    ESP_LOGW(TAG, "SPI clock %d Hz still failing, staying at %d Hz", spi_clock_configured_hz, fallback_hz);
+    nrf24_spi_set_clock(fallback_hz);
+}
 
-    // Sequence / Command / Parameter
-    packet[12] = seq;
-    packet[13] = cmd;
-    packet[14] = param;
+/// @brief Loads a radio profile, only registers whose mirrored value differs are written
+/// The differing writes are sent as one queued batch, then the oscillator startup is awaited when the profile
+/// powers the chip up from power down. That wait is the latency a command pays for finding the chip parked
+/// @param profile Profile to apply
+/// @return ESP_OK on success, error code on failure
+static esp_err_t nrf24_apply_profile(const nrf24_profile_t* profile) {
+    static nrf24_spi_batch_t batch;
+    bool was_powered =
+        (reg_shadow_valid & (1UL << NRF_REG_CONFIG)) && (reg_shadow[NRF_REG_CONFIG][0] & NRF_CONFIG_PWR_UP);
+
+    batch.count = 0;
+    for (size_t i = 0; i < profile->count; i++) {
+        const nrf24_reg_value_t* rv = &profile->regs[i];
+        if (nrf24_shadow_matches(rv->reg, rv->value, rv->len)) {
+            radio_stats.spi_saved++;
+            continue;
+        }
 
-    // Calculate CRC16 on first 15 bytes
-    uint16_t crc = nrf24_crc16(packet, 15);
-    packet[15] = (crc >> 8) & 0xFF;
-    packet[16] = crc & 0xFF;
+        esp_err_t err = nrf24_batch_add_write(&batch, rv->reg, rv->value, rv->len);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
 
-    // Padding
-    packet[17] = 0x00;
+    if (batch.count > 0) {
+        nrf24_trace(NRF24_TRACE_PROFILE, (uint8_t)batch.count, (uint16_t)profile->count);
+        esp_err_t err = nrf24_batch_run(&batch);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Profile %s: batch write failed: %d", profile->name, err);
+            nrf24_shadow_invalidate();
+            return err;
+        }
 
-    // Copy plaintext then apply whitening
-    memcpy(output, packet, 18);
+        for (size_t i = 0; i < profile->count; i++) {
+            nrf24_shadow_store(profile->regs[i].reg, profile->regs[i].value, profile->regs[i].len);
+        }
+    }
 
-    // Apply whitening to bytes 0-17
-    nrf24_xiaomi_whiten(output, 18);
+    if (!was_powered && (reg_shadow[NRF_REG_CONFIG][0] & NRF_CONFIG_PWR_UP)) {
+        // Far below one tick, a busy wait costs less than the extra tick a task delay would round up to
+        int64_t start = esp_timer_get_time();
+        esp_rom_delay_us(NRF24_PWR_UP_US);
+        uint32_t waited_us = (uint32_t)(esp_timer_get_time() - start);
+
+        portENTER_CRITICAL(&power_lock);
+        power_stats.wakeups++;
+        power_stats.last_wake_us = waited_us;
+        power_stats.wake_total_us += waited_us;
+        portEXIT_CRITICAL(&power_lock);
+    }
 
     return ESP_OK;
 }
 
-/// @brief Searches for and decodes a Xiaomi packet from raw received data
-/// @param raw Pointer to the raw data buffer
-/// @param len Length of the raw data buffer in bytes
-/// @param out Pointer to xiaomi_packet_t structure to store decoded packet (if found)
-/// @return true if a valid packet was found and decoded, false otherwise
-static bool nrf24_find_and_decode_packet(const uint8_t* raw, size_t len, xiaomi_packet_t* out) {
-    if (!raw || !out || len < 17) return false;
-
-    const uint8_t expected_preamble[8] = {0x53, 0x39, 0x14, 0xDD, 0x1C, 0x49, 0x34, 0x12};
-    for (size_t byte_off = 0; byte_off + 17 <= len; byte_off++) {
-        for (int shift = 0; shift <= 7; shift++) {
-            uint8_t aligned[17];
-            for (int i = 0; i < 17; i++) {
-                uint8_t a = raw[byte_off + i];
-                uint8_t b = (byte_off + i + 1 < len) ? raw[byte_off + i + 1] : 0;
-                aligned[i] = (shift == 0) ? a : (uint8_t)((a << shift) | (b >> (8 - shift)));
-            }
+/// @brief Measures the cost of one register write through each SPI path
+/// Writes RX_PW_P5, unused by the Xiaomi profiles, its shadow entry is dropped afterwards so the next profile
+/// load rewrites it
+/// @return ESP_OK on success, error code on failure
+static esp_err_t nrf24_radio_bench_spi(void) {
+    if (radio_hal != NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
 
-            bool preamble_ok = true;
-            for (int i = 0; i < 8; i++) {
-                if (aligned[i] != expected_preamble[i]) {
-                    preamble_ok = false;
-                    break;
-                }
-            }
-            if (!preamble_ok || aligned[11] != 0xFF) continue;
+    static nrf24_spi_batch_t batch;
+    uint8_t tx[2] = {NRF_CMD_W_REGISTER | NRF_REG_RX_PW_P5, 0};
+    spi_transaction_t t = {
+        .length = 16,
+        .tx_buffer = tx,
+    };
+    esp_err_t err = ESP_OK;
+
+    // Previous path: interrupt driven transaction with the bus arbitrated on every call
+    nrf24_spi_release();
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < NRF24_SPI_BENCH_ITERATIONS && err == ESP_OK; i++) {
+        tx[1] = i & 0x1F;
+        err = spi_device_transmit(nrf_spi, &t);
+    }
+    int64_t transmit_us = esp_timer_get_time() - start;
 
-            uint16_t crc_calc = nrf24_crc16(aligned, 15);
-            uint16_t crc_rx = ((uint16_t)aligned[15] << 8) | aligned[16];
-            if (crc_calc != crc_rx) continue;
+    esp_err_t acquired = nrf24_spi_acquire();
+    if (err != ESP_OK || acquired != ESP_OK) {
+        return err != ESP_OK ? err : acquired;
+    }
 
-            out->id = ((uint32_t)aligned[8] << 16) | ((uint32_t)aligned[9] << 8) | aligned[10];
-            out->cmd = ((uint16_t)aligned[12] << 8) | aligned[13];
-            out->seq = aligned[14];
-            return true;
-        }
+    start = esp_timer_get_time();
+    for (int i = 0; i < NRF24_SPI_BENCH_ITERATIONS && err == ESP_OK; i++) {
+        tx[1] = i & 0x1F;
+        err = spi_device_polling_transmit(nrf_spi, &t);
+    }
+    int64_t polling_us = esp_timer_get_time() - start;
+
+    batch.count = 0;
+    for (uint8_t i = 0; i < NRF24_SPI_BATCH_MAX; i++) {
+        nrf24_batch_add_write(&batch, NRF_REG_RX_PW_P5, &i, 1);
+    }
+    start = esp_timer_get_time();
+    for (int i = 0; i < NRF24_SPI_BENCH_ITERATIONS / NRF24_SPI_BATCH_MAX && err == ESP_OK; i++) {
+        err = nrf24_batch_run(&batch);
+    }
+    int64_t batch_us = esp_timer_get_time() - start;
+
+    radio_stats.spi_transactions += 2 * NRF24_SPI_BENCH_ITERATIONS;
+    reg_shadow_valid &= ~(1UL << NRF_REG_RX_PW_P5);
+    if (err != ESP_OK) {
+        return err;
     }
 
-    return false;
+    last_bench.iterations = NRF24_SPI_BENCH_ITERATIONS;
+    last_bench.transmit_ns = (uint32_t)(transmit_us * 1000 / NRF24_SPI_BENCH_ITERATIONS);
+    last_bench.polling_ns = (uint32_t)(polling_us * 1000 / NRF24_SPI_BENCH_ITERATIONS);
+    last_bench.batch_ns = (uint32_t)(batch_us * 1000 / NRF24_SPI_BENCH_ITERATIONS);
+
+    ESP_LOGI(TAG, "SPI register write: transmit %lu ns, polling %lu ns, batch %lu ns",
+             (unsigned long)last_bench.transmit_ns, (unsigned long)last_bench.polling_ns,
+             (unsigned long)last_bench.batch_ns);
+
+    return ESP_OK;
 }
 
 /// @brief Checks the connection to the NRF24L01+ module by reading and writing its CONFIG register
+/// A routine check stops at the CONFIG probe and one write/readback round while the radio does not answer. The full
+/// verify and the clock fallback run on a full check and on recovery, once a routine check finds the radio answering
+/// @param full true for the full verify (init, explicit checks), false for a routine probe
 /// @return ESP_OK on success, error code on failure
-esp_err_t nrf24_check_connection(void) {
+static esp_err_t nrf24_radio_check(bool full) {
     esp_err_t err = nrf24_init_spi();
     if (err != ESP_OK) {
         return err;
     }
 
+    // The chip may have been reset or rewired since the last check
+    nrf24_shadow_invalidate();
+
     vTaskDelay(pdMS_TO_TICKS(5));
 
     uint8_t status_nop = 0;
@@ -396,7 +1243,7 @@ esp_err_t nrf24_check_connection(void) {
         .tx_buffer = &nop_cmd,
         .rx_buffer = &status_nop,
     };
-    err = spi_device_transmit(nrf_spi, &t);
+    err = nrf24_spi_transfer(&t);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "NOP failed: %d", err);
         return err;
@@ -434,7 +1281,7 @@ esp_err_t nrf24_check_connection(void) {
         ESP_LOGI(TAG, "After write: status=0x%02X write_status=0x%02X CONFIG=0x%02X", status_after, write_status,
                  config_after);
 
-        if (config_after != 0x0B) {
+        if (config_after != 0x0B && (!full || nrf24_spi_fallback() != ESP_OK)) {
             ESP_LOGW(TAG,
                      "Write/readback mismatch; check wiring (VCC 3.3V, GND, CE=4, CSN=5, SCK=18, MOSI=23, MISO=19) and "
                      "add 10uF near module");
@@ -444,14 +1291,107 @@ esp_err_t nrf24_check_connection(void) {
         ESP_LOGI(TAG, "NRF24 appears responsive; wiring/power OK");
     }
 
+    if (!full && !nrf24_spi_verify(NRF24_SPI_PROBE_ROUNDS)) {
+        ESP_LOGW(TAG, "Write/readback probe failing");
+        return ESP_FAIL;
+    }
+
+    if (!nrf24_spi_verify(NRF24_SPI_VERIFY_ROUNDS) && nrf24_spi_fallback() != ESP_OK) {
+        ESP_LOGW(TAG, "Write/readback failing at every SPI clock");
+        return ESP_FAIL;
+    }
+
+    // Only run idle work once the radio answered, a missing module would just burn SPI time
+    radio_ready = true;
+
     return ESP_OK;
 }
 
-/// @brief Reads the payload data from the nRF24L01+ module
-/// @param data Pointer to the buffer to store the received payload
-/// @param len The length of the payload to read (maximum 32 bytes)
-/// @return Returns ESP_OK on success, or an error code on failure
-static esp_err_t nrf24_read_payload(uint8_t* data, size_t len) {
+/// @brief Publishes the outcome of a health check and schedules the next periodic one
+/// @param verdict nrf24_health_verdict_t of the check
+/// @param config CONFIG value read by the check
+static void nrf24_health_publish(uint8_t verdict, uint8_t config) {
+    int64_t now = esp_timer_get_time();
+    health_next_us = now + (int64_t)NRF24_HEALTH_PERIOD_MS * 1000;
+
+    portENTER_CRITICAL(&health_lock);
+    radio_health.connected = verdict == NRF24_HEALTH_OK;
+    radio_health.verdict = verdict;
+    radio_health.config = config;
+    radio_health.last_check_ms = (uint32_t)(now / 1000);
+    radio_health.checks++;
+    if (verdict != NRF24_HEALTH_OK) {
+        radio_health.failures++;
+    }
+    portEXIT_CRITICAL(&health_lock);
+}
+
+/// @brief Runs a connection check and publishes its outcome
+/// @param full Passed to nrf24_radio_check
+/// @return Result of nrf24_radio_check
+static esp_err_t nrf24_radio_check_publish(bool full) {
+    esp_err_t err = nrf24_radio_check(full);
+    uint8_t config = (reg_shadow_valid & (1UL << NRF_REG_CONFIG)) ? reg_shadow[NRF_REG_CONFIG][0] : 0;
+
+    uint8_t verdict = NRF24_HEALTH_OK;
+    if (err == ESP_FAIL) {
+        verdict = NRF24_HEALTH_MISMATCH;
+    } else if (err != ESP_OK) {
+        verdict = NRF24_HEALTH_SPI_ERROR;
+    }
+    nrf24_health_publish(verdict, config);
+
+    return err;
+}
+
+/// @brief Periodic health check: a routine connection check while the radio does not answer, then a read-only
+/// CONFIG probe compared against the mirror
+/// All zeros or all ones means nobody drives MISO (CONFIG bit 7 always reads 0), any other difference means the
+/// chip reset behind the driver, e.g. a brown-out. The mirror is dropped in both cases so the next profile load
+/// rewrites every register, and the radio goes back to routine checks, recovering through the full verify
+static void nrf24_health_run(void) {
+    if (!radio_ready) {
+        nrf24_radio_check_publish(false);
+        return;
+    }
+
+    bool known = (reg_shadow_valid & (1UL << NRF_REG_CONFIG)) != 0;
+    uint8_t expected = reg_shadow[NRF_REG_CONFIG][0];
+
+    uint8_t config = 0;
+    esp_err_t err = nrf24_read_register(NRF_REG_CONFIG, &config, NULL);
+
+    uint8_t verdict = NRF24_HEALTH_OK;
+    if (err != ESP_OK) {
+        verdict = NRF24_HEALTH_SPI_ERROR;
+    } else if (config == 0xFF || (config == 0x00 && !(known && expected == 0x00))) {
+        verdict = NRF24_HEALTH_NO_RESPONSE;
+    } else if (known && config != expected) {
+        verdict = NRF24_HEALTH_MISMATCH;
+    }
+
+    if (verdict != NRF24_HEALTH_OK) {
+        ESP_LOGW(TAG, "Health check: %s, CONFIG=0x%02X (expected 0x%02X)", nrf24_health_verdict_name(verdict),
+                 config, expected);
+        nrf24_shadow_invalidate();
+        radio_ready = false;
+    }
+    nrf24_health_publish(verdict, config);
+
+    if (verdict == NRF24_HEALTH_OK) {
+        nrf24_spi_clock_retry();
+    } else {
+        // Recover on the next round rather than a period later
+        health_next_us = esp_timer_get_time();
+    }
+}
+
+/// @brief Reads the payload data from the nRF24L01+ module
+/// @param data Pointer to the buffer to store the received payload
+/// @param len The length of the payload to read (maximum 32 bytes)
+/// @param status Pointer to store the status byte, its RX_P_NO field names the pipe of this payload (can be NULL)
+/// @return Returns ESP_OK on success, or an error code on failure
+static esp_err_t nrf24_read_payload(uint8_t* data, size_t len, uint8_t* status) {
     if (len > 32) {
         return ESP_ERR_INVALID_ARG;
     }
@@ -466,13 +1406,16 @@ static esp_err_t nrf24_read_payload(uint8_t* data, size_t len) {
         .tx_buffer = tx,
         .rx_buffer = rx,
     };
-    esp_err_t err = spi_device_transmit(nrf_spi, &t);
+    esp_err_t err = nrf24_spi_transfer(&t);
     if (err != ESP_OK) {
         return err;
     }
     for (size_t i = 0; i < len; i++) {
         data[i] = rx[1 + i];
     }
+    if (status) {
+        *status = rx[0];
+    }
 
     return ESP_OK;
 }
@@ -495,209 +1438,1903 @@ static esp_err_t nrf24_write_payload(const uint8_t* data, size_t len) {
         .tx_buffer = tx,
     };
 
-    return spi_device_transmit(nrf_spi, &t);
+    return nrf24_spi_transfer(&t);
 }
 
-esp_err_t nrf24_send_xiaomi_power(uint32_t remote_id) {
-    if (nrf24_mutex == NULL || xSemaphoreTake(nrf24_mutex, pdMS_TO_TICKS(5000)) == pdFALSE) {
-        ESP_LOGE(TAG, "Failed to acquire nrf24 mutex");
-        return ESP_ERR_TIMEOUT;
+/// @brief Drives CE through the installed backend or the GPIO, without tracing
+/// @param high true to raise CE
+static inline void nrf24_ce_write(bool high) {
+    if (radio_hal != NULL) {
+        radio_hal->set_ce(radio_hal->ctx, high);
+    } else {
+        gpio_set_level(PIN_NUM_CE, high ? 1 : 0);
+    }
+    if (ce_level != high) {
+        ce_level = high;
+        nrf24_power_track();
+    }
+}
+
+/// @brief Drives CE and records the edge in the trace ring together with the current channel
+/// @param high true to raise CE
+static inline void nrf24_set_ce(bool high) {
+    nrf24_ce_write(high);
+    nrf24_trace(high ? NRF24_TRACE_CE_HIGH : NRF24_TRACE_CE_LOW, reg_shadow[NRF_REG_RF_CH][0], 0);
+}
+
+/// @brief Sends one frame per remote on a channel, back to back through the 3-deep TX FIFO
+/// Up to three frames are preloaded before CE goes high, CE then stays high so the radio chains them, and further
+/// frames are written as soon as STATUS reports room. The hop ends when FIFO_STATUS reports the FIFO empty, no tick
+/// delay and no per-frame flush or STATUS clear
+/// @param channel RF channel
+/// @param frames Frame of each remote
+/// @param remote_count Number of frames to send
+/// @return true if every frame left the FIFO, false on timeout (the FIFO is flushed)
+static bool nrf24_tx_channel(uint8_t channel, const uint8_t (*frames)[XIAOMI_FRAME_LEN], size_t remote_count) {
+    nrf24_set_ce(false);
+    nrf24_write_register(NRF_REG_RF_CH, channel, NULL);
+
+    size_t queued = 0;
+    while (queued < remote_count && queued < NRF24_TX_FIFO_DEPTH) {
+        if (nrf24_write_payload(frames[queued], XIAOMI_FRAME_LEN) != ESP_OK) {
+            break;
+        }
+        queued++;
+    }
+    nrf24_set_ce(true);
+
+    // Top the FIFO up while earlier frames are on air, the NOP costs one byte and returns STATUS. Both waits read the
+    // chip once more after their deadline, a task preempted past it must not give up on a stale reading
+    int64_t deadline = esp_timer_get_time() + NRF24_TX_DONE_TIMEOUT_US;
+    bool expired = false;
+    while (queued < remote_count && !expired) {
+        expired = esp_timer_get_time() >= deadline;
+        uint8_t status = 0;
+        nrf24_command(NRF_CMD_NOP, &status);
+        if ((status & NRF_STATUS_TX_FULL) == 0) {
+            if (nrf24_write_payload(frames[queued], XIAOMI_FRAME_LEN) != ESP_OK) {
+                break;
+            }
+            queued++;
+            deadline = esp_timer_get_time() + NRF24_TX_DONE_TIMEOUT_US;
+            expired = false;
+        }
+    }
+
+    // Up to a full FIFO is still on air
+    uint8_t fifo = 0;
+    deadline = esp_timer_get_time() + NRF24_TX_DONE_TIMEOUT_US * NRF24_TX_FIFO_DEPTH;
+    expired = false;
+    while (queued == remote_count && !expired) {
+        expired = esp_timer_get_time() >= deadline;
+        nrf24_read_register(NRF_REG_FIFO_STATUS, &fifo, NULL);
+        if (fifo & NRF_FIFO_TX_EMPTY) {
+            break;
+        }
+    }
+    nrf24_set_ce(false);
+
+    if (queued < remote_count || (fifo & NRF_FIFO_TX_EMPTY) == 0) {
+        nrf24_trace(NRF24_TRACE_TX_FAIL, channel, (uint16_t)queued);
+        nrf24_command(NRF_CMD_FLUSH_TX, NULL);
+        return false;
+    }
+
+    nrf24_trace(NRF24_TRACE_TX_DS, channel, (uint16_t)queued);
+    return true;
+}
+
+/// @brief Orders channels from the quietest to the busiest according to the RPD survey
+/// Keeps the given order until the survey completed a first sweep
+/// @param channels Channels to order
+/// @param count Number of channels
+/// @param out Array receiving the ordered channels
+static void nrf24_order_channels(const uint8_t* channels, size_t count, uint8_t* out) {
+    memcpy(out, channels, count);
+    if (survey_sweeps == 0) {
+        return;
+    }
+
+    for (size_t i = 1; i < count; i++) {
+        uint8_t ch = out[i];
+        size_t j = i;
+        for (; j > 0 && survey_occupancy[out[j - 1]] > survey_occupancy[ch]; j--) {
+            out[j] = out[j - 1];
+        }
+        out[j] = ch;
     }
+}
 
+/// @brief Prepares a TX session: frame templates of every remote and the TX profile, with an empty FIFO
+/// @param remote_ids 24-bit remote ids
+/// @param remote_count Number of remotes (1..NRF24_XIAOMI_GROUP_MAX)
+/// @return ESP_OK on success, error code otherwise
+static esp_err_t nrf24_tx_session_begin(const uint32_t* remote_ids, size_t remote_count) {
     esp_err_t err = nrf24_init_spi();
     if (err != ESP_OK) {
-        xSemaphoreGive(nrf24_mutex);
         return err;
     }
 
-    static const uint8_t tx_addr[5] = {0x67, 0x22, 0x00, 0x00, 0x00};
+    for (size_t r = 0; r < remote_count; r++) {
+        if (xiaomi_tx_templates[r].remote_id != remote_ids[r] || !xiaomi_tx_templates_valid[r]) {
+            xiaomi_tx_templates_valid[r] = xiaomi_template_init(&xiaomi_tx_templates[r], remote_ids[r]);
+            if (!xiaomi_tx_templates_valid[r]) {
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
 
-    uint8_t action_payload[18] = {0};
-    uint8_t seq = xiaomi_tx_seq;  // simple rolling sequence
-    uint8_t cmd = 0x80;           // Toogle power
-    uint8_t param = 0x3C;         // param inferred from logs (whitened 0x80 => plain 0x3C)
-    nrf24_build_xiaomi_frame(remote_id, seq, cmd, param, action_payload);
+    // Configure NRF24 for Xiaomi broadcast (no auto-ack), a hop only starts on an empty FIFO
+    nrf24_set_ce(false);
+    err = nrf24_apply_profile(&profile_xiaomi_tx);
+    if (err != ESP_OK) {
+        return err;
+    }
+    nrf24_command(NRF_CMD_FLUSH_TX, NULL);
+    nrf24_write_register(NRF_REG_STATUS, NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT, NULL);
 
-    // Configure NRF24 for Xiaomi broadcast (no auto-ack)
-    gpio_set_level(PIN_NUM_CE, 0);
-    nrf24_write_register(NRF_REG_EN_AA, 0x00, NULL);
-    nrf24_write_register(NRF_REG_SETUP_RETR, 0x00, NULL);
-    nrf24_write_register(NRF_REG_EN_RXADDR, 0x01, NULL);
-    nrf24_write_register(NRF_REG_SETUP_AW, 0x03, NULL);
-    nrf24_write_register(NRF_REG_DYNPD, 0x00, NULL);
-    nrf24_write_register(NRF_REG_FEATURE, 0x00, NULL);
-    nrf24_write_register(NRF_REG_RF_SETUP, 0x0E, NULL);
-    nrf24_write_register(NRF_REG_RX_PW_P0, 32, NULL);
-    nrf24_write_register_buf(NRF_REG_TX_ADDR, tx_addr, sizeof(tx_addr));
-    nrf24_write_register_buf(NRF_REG_RX_ADDR_P0, tx_addr, sizeof(tx_addr));
+    return ESP_OK;
+}
+
+/// @brief Ends a TX session
+static void nrf24_tx_session_end(void) {
+    // TX_DS is left set by the hops, clear it so the IRQ line is released for the next RX
+    nrf24_set_ce(false);
     nrf24_write_register(NRF_REG_STATUS, NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT, NULL);
-    nrf24_command(NRF_CMD_FLUSH_TX, NULL);
-    nrf24_command(NRF_CMD_FLUSH_RX, NULL);
-    nrf24_write_register(NRF_REG_CONFIG, 0x02, NULL);
+}
 
-    vTaskDelay(pdMS_TO_TICKS(5));
+/// @brief Extends the NVS reservation so the next count sequence numbers need no further write
+/// @param count Sequence numbers about to be used, capped at XIAOMI_SEQ_AHEAD_MAX
+static void nrf24_seq_reserve(uint32_t count) {
+    uint8_t available = (uint8_t)(xiaomi_tx_seq_reserved - xiaomi_tx_seq);
+    if (count <= available) {
+        return;
+    }
 
-    static const uint8_t channels[] = {6, 15, 43, 68};
-    const int passes = 2;  // repeat through channels to improve reliability, without that many devices miss packets
-    bool sent = false;
+    uint32_t ahead = (count + XIAOMI_SEQ_BLOCK - 1) / XIAOMI_SEQ_BLOCK * XIAOMI_SEQ_BLOCK;
+    if (ahead > XIAOMI_SEQ_AHEAD_MAX) {
+        ahead = XIAOMI_SEQ_AHEAD_MAX;
+    }
+    if (ahead <= available) {
+        return;
+    }
+
+    xiaomi_tx_seq_reserved = (uint8_t)(xiaomi_tx_seq + ahead);
+    if (!nvs_save_xiaomi_seq(xiaomi_tx_seq_reserved)) {
+        ESP_LOGW(TAG, "Failed to reserve Xiaomi sequence numbers");
+    }
+}
 
-    char payload_hex[3 * 18 + 4] = {0};
-    size_t pos = 0;
-    for (int i = 0; i < 18 && pos + 3 < sizeof(payload_hex); i++) {
-        pos +=
-            snprintf(payload_hex + pos, sizeof(payload_hex) - pos, "%02X%s", action_payload[i], (i == 17 ? "" : " "));
+/// @brief Puts one command on air for every remote of the session, with a fresh sequence number
+/// For every pass the frames of all remotes are interleaved on each channel hop, the quietest surveyed channel first.
+/// The frames stay in xiaomi_tx_frames for logging
+/// @param remote_ids 24-bit remote ids, as given to nrf24_tx_session_begin
+/// @param remote_count Number of remotes
+/// @param action Command to send
+/// @param passes Sweeps over the Xiaomi channels
+/// @return Bitmask of the remotes reached, 0 if the command is invalid or no hop went out
+static uint32_t nrf24_tx_command(const uint32_t* remote_ids, size_t remote_count, const xiaomi_action_t* action,
+                                 int passes) {
+    static const uint8_t xiaomi_channels[] = {6, 15, 43, 68};
+
+    uint8_t cmd = 0;
+    uint8_t param = 0;
+    if (!xiaomi_command_encode(action, &cmd, &param)) {
+        return 0;
     }
-    ESP_LOGI(TAG, "Sending Xiaomi power toogle to 0x%06lX: %s", (unsigned long)remote_id, payload_hex);
 
+    uint8_t channels[sizeof(xiaomi_channels)];
+    nrf24_order_channels(xiaomi_channels, sizeof(xiaomi_channels), channels);
+
+    for (size_t r = 0; r < remote_count; r++) {
+        xiaomi_template_build(&xiaomi_tx_templates[r], xiaomi_tx_seq, cmd, param, xiaomi_tx_frames[r]);
+    }
+
+    // A remote counts as reached once any of its hops went out, only completed hops count as frames on air
+    uint32_t hops_sent = 0;
+    int64_t start_us = esp_timer_get_time();
     for (int pass = 0; pass < passes; pass++) {
-        for (size_t i = 0; i < (sizeof(channels) / sizeof(channels[0])); i++) {
-            nrf24_write_register(NRF_REG_RF_CH, channels[i], NULL);
-            ESP_LOGI("NRF24",
-                     "TX pass %d ch %u payload: %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X "
-                     "%02X %02X %02X %02X",
-                     pass + 1, (unsigned)channels[i], action_payload[0], action_payload[1], action_payload[2],
-                     action_payload[3], action_payload[4], action_payload[5], action_payload[6], action_payload[7],
-                     action_payload[8], action_payload[9], action_payload[10], action_payload[11], action_payload[12],
-                     action_payload[13], action_payload[14], action_payload[15], action_payload[16],
-                     action_payload[17]);
-            nrf24_command(NRF_CMD_FLUSH_TX, NULL);
-
-            err = nrf24_write_payload(action_payload, sizeof(action_payload));
-            if (err != ESP_OK) {
-                xSemaphoreGive(nrf24_mutex);
-                return err;
+        for (size_t i = 0; i < sizeof(channels); i++) {
+            if (nrf24_tx_channel(channels[i], (const uint8_t (*)[XIAOMI_FRAME_LEN])xiaomi_tx_frames, remote_count)) {
+                hops_sent++;
             }
+        }
+    }
+    radio_stats.tx_last_burst_us = (uint32_t)(esp_timer_get_time() - start_us);
+    radio_stats.tx_frames += hops_sent * (uint32_t)remote_count;
+    uint32_t reached = hops_sent > 0 ? (uint32_t)((1ULL << remote_count) - 1) : 0;
 
-            gpio_set_level(PIN_NUM_CE, 1);
-            esp_rom_delay_us(100);
-            gpio_set_level(PIN_NUM_CE, 0);
+    for (size_t r = 0; r < remote_count; r++) {
+        if (reached & (1UL << r)) {
+            xiaomi_state_apply(remote_ids[r], action);
+        }
+    }
 
-            vTaskDelay(pdMS_TO_TICKS(2));
+    xiaomi_tx_seq++;
+    if (xiaomi_tx_seq == xiaomi_tx_seq_reserved) {
+        xiaomi_tx_seq_reserved += XIAOMI_SEQ_BLOCK;
+        if (!nvs_save_xiaomi_seq(xiaomi_tx_seq_reserved)) {
+            ESP_LOGW(TAG, "Failed to reserve Xiaomi sequence numbers");
+        }
+    }
 
-            uint8_t status = 0;
-            nrf24_read_register(NRF_REG_STATUS, &status, NULL);
-            nrf24_write_register(NRF_REG_STATUS, NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT, NULL);
+    return reached;
+}
+
+/// @brief Sends an ordered list of Xiaomi commands to one or more remotes in one radio session, runs in the radio task
+/// The TX profile is loaded once for the whole burst and a group costs one channel sweep per command instead of one
+/// per remote. Frames are logged once the command is on air so the UART never delays a hop
+/// @param remote_ids 24-bit remote ids
+/// @param remote_count Number of remotes (1..NRF24_XIAOMI_GROUP_MAX)
+/// @param actions Commands to send, in order
+/// @param count Number of commands
+/// @return ESP_OK if every command went out to every remote, error code otherwise
+static esp_err_t nrf24_radio_tx_burst(const uint32_t* remote_ids, size_t remote_count, const xiaomi_action_t* actions,
+                                      size_t count) {
+    const int passes = 2;  // repeat through channels to improve reliability, without that many devices miss packets
+
+    esp_err_t err = nrf24_tx_session_begin(remote_ids, remote_count);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    esp_err_t result = ESP_OK;
+    for (size_t n = 0; n < count && result == ESP_OK; n++) {
+        uint8_t seq = xiaomi_tx_seq;
+        uint32_t reached = nrf24_tx_command(remote_ids, remote_count, &actions[n], passes);
+
+        ESP_LOGI(TAG, "Sent Xiaomi %s (%u/%u) to %u remote(s) in %lu us", xiaomi_command_name(actions[n].command),
+                 (unsigned)(n + 1), (unsigned)count, (unsigned)remote_count,
+                 (unsigned long)radio_stats.tx_last_burst_us);
+        for (size_t r = 0; r < remote_count; r++) {
+            ESP_LOGD(TAG, "Frame to 0x%06lX seq=%02X:", (unsigned long)remote_ids[r], seq);
+            ESP_LOG_BUFFER_HEX_LEVEL(TAG, xiaomi_tx_frames[r], XIAOMI_FRAME_LEN, ESP_LOG_DEBUG);
+        }
+
+        if (reached != (1UL << remote_count) - 1) {
+            result = ESP_FAIL;
+        }
+    }
+
+    nrf24_tx_session_end();
+    return result;
+}
+
+/// @brief esp_timer callback of a hold, wakes the radio task for the next step
+/// @param arg Unused
+static void nrf24_hold_tick(void* arg) { xTaskNotify(radio_task, NRF24_NOTIFY_HOLD, eSetBits); }
+
+/// @brief Repeats a stepped command at a fixed cadence like a held remote button, runs in the radio task
+/// Each tick of the periodic timer sends a one-step command on one channel sweep. The hold ends on nrf24_hold_stop,
+/// after the requested steps, after NRF24_HOLD_MAX_MS, or when an interactive command lands in the urgent queue;
+/// commands of the normal queue wait for it. Lateness of every step against its timer deadline and the spread of
+/// the intervals between steps are published in hold_progress
+/// @param hold_id Id returned by nrf24_hold_start
+/// @param remote_ids 24-bit remote ids
+/// @param remote_count Number of remotes (1..NRF24_XIAOMI_GROUP_MAX)
+/// @param command Stepped command (xiaomi_command_t)
+/// @param steps Steps to send, 0 until stopped
+/// @param period_ms Cadence in milliseconds
+/// @return ESP_OK once released or over, ESP_ERR_INVALID_STATE if an interactive command cut it short, ESP_FAIL if
+/// a step reached no remote, error code on timer or SPI failure
+static esp_err_t nrf24_radio_hold(uint32_t hold_id, const uint32_t* remote_ids, size_t remote_count, uint8_t command,
+                                  uint16_t steps, uint32_t period_ms) {
+    if (hold_timer == NULL) {
+        const esp_timer_create_args_t args = {
+            .callback = nrf24_hold_tick,
+            .name = "nrf24_hold",
+        };
+        esp_err_t err = esp_timer_create(&args, &hold_timer);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    esp_err_t err = nrf24_tx_session_begin(remote_ids, remote_count);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    portENTER_CRITICAL(&hold_lock);
+    hold_progress = (nrf24_hold_status_t){
+        .id = hold_id,
+        .command = command,
+        .steps = steps,
+        .period_ms = period_ms,
+    };
+    portEXIT_CRITICAL(&hold_lock);
+
+    const xiaomi_action_t action = {.command = command, .step = 1};
+    const int64_t period_us = (int64_t)period_ms * 1000;
+    xTaskNotifyWait(0, NRF24_NOTIFY_HOLD | NRF24_NOTIFY_CMD, NULL, 0);
+
+    // One NVS commit for the whole hold instead of one per XIAOMI_SEQ_BLOCK steps
+    nrf24_seq_reserve(steps ? steps : NRF24_HOLD_MAX_MS / period_ms + 1);
+
+    int64_t start_us = esp_timer_get_time();
+    err = esp_timer_start_periodic(hold_timer, (uint64_t)period_us);
+    if (err != ESP_OK) {
+        nrf24_tx_session_end();
+        return err;
+    }
+
+    // The first step goes out on press, the timer paces the following ones
+    esp_err_t result = ESP_OK;
+    int64_t next_tick = 0;
+    int64_t last_step_us = 0;
+    uint64_t spread_sum_us = 0;
+    uint32_t intervals = 0;
+    bool due = true;
+    bool capped = false;
+    nrf24_hold_status_t progress = {0};
+    while (!hold_stop && uxQueueMessagesWaiting(radio_urgent_queue) == 0 &&
+           (steps == 0 || progress.steps_sent < steps)) {
+        if (!due) {
+            uint32_t bits = 0;
+            if (xTaskNotifyWait(0, NRF24_NOTIFY_HOLD | NRF24_NOTIFY_CMD, &bits,
+                                pdMS_TO_TICKS(period_ms * 2 + 10)) != pdTRUE) {
+                result = ESP_ERR_TIMEOUT;
+                break;
+            }
+            if ((bits & NRF24_NOTIFY_HOLD) == 0) {
+                continue;
+            }
+        }
+        due = false;
+
+        int64_t now = esp_timer_get_time();
+        if (now - start_us >= NRF24_HOLD_MAX_MS * 1000LL) {
+            ESP_LOGW(TAG, "Hold released after %d ms without a stop", NRF24_HOLD_MAX_MS);
+            capped = true;
+            break;
+        }
 
-            if ((status & NRF_STATUS_MAX_RT) == 0) {
-                sent = true;
+        // Ticks coalesce in the notification bits while a step is still on air, count them as missed
+        int64_t tick = (now - start_us) / period_us;
+        uint32_t late_us = (uint32_t)(now - start_us - tick * period_us);
+        uint32_t missed = tick > next_tick ? (uint32_t)(tick - next_tick) : 0;
+        next_tick = tick + 1;
+
+        uint32_t reached = nrf24_tx_command(remote_ids, remote_count, &action, 1);
+        if (reached != (1UL << remote_count) - 1) {
+            result = ESP_FAIL;
+        }
+
+        progress.steps_sent++;
+        progress.missed_ticks += missed;
+        if (late_us > progress.late_max_us) {
+            progress.late_max_us = late_us;
+        }
+        if (last_step_us != 0 && missed == 0) {
+            int64_t interval = now - last_step_us;
+            uint32_t spread = (uint32_t)(interval > period_us ? interval - period_us : period_us - interval);
+            spread_sum_us += spread;
+            intervals++;
+            progress.jitter_avg_us = (uint32_t)(spread_sum_us / intervals);
+            if (spread > progress.jitter_max_us) {
+                progress.jitter_max_us = spread;
             }
         }
+        last_step_us = now;
+        progress.step_us = radio_stats.tx_last_burst_us;
+
+        portENTER_CRITICAL(&hold_lock);
+        hold_progress.steps_sent = progress.steps_sent;
+        hold_progress.missed_ticks = progress.missed_ticks;
+        hold_progress.late_max_us = progress.late_max_us;
+        hold_progress.jitter_avg_us = progress.jitter_avg_us;
+        hold_progress.jitter_max_us = progress.jitter_max_us;
+        hold_progress.step_us = progress.step_us;
+        portEXIT_CRITICAL(&hold_lock);
     }
 
-    esp_err_t result = sent ? ESP_OK : ESP_FAIL;
+    esp_timer_stop(hold_timer);
+    xTaskNotifyWait(0, NRF24_NOTIFY_HOLD, NULL, 0);
+    nrf24_tx_session_end();
 
-    if (result == ESP_OK) {
-        xiaomi_tx_seq++;
+    if (result == ESP_OK && !hold_stop && !capped && (steps == 0 || progress.steps_sent < steps)) {
+        result = ESP_ERR_INVALID_STATE;
     }
 
-    gpio_set_level(PIN_NUM_CE, 0);
-    xSemaphoreGive(nrf24_mutex);
+    ESP_LOGI(TAG, "Held Xiaomi %s for %u step(s) every %lu ms: jitter avg %lu us max %lu us, %lu missed tick(s)",
+             xiaomi_command_name(command), (unsigned)progress.steps_sent, (unsigned long)period_ms,
+             (unsigned long)progress.jitter_avg_us, (unsigned long)progress.jitter_max_us,
+             (unsigned long)progress.missed_ticks);
     return result;
 }
 
-/// @brief Quick scan for Xiaomi lightbar patterns and save results for API access
-/// @param duration_ms Duration of scan in milliseconds (e.g., 10000 for 10 seconds)
-/// @return ESP_OK if patterns found, ESP_ERR_NOT_FOUND otherwise
-esp_err_t nrf24_scan_xiaomi(uint32_t duration_ms) {
-    if (nrf24_mutex == NULL || xSemaphoreTake(nrf24_mutex, pdMS_TO_TICKS(5000)) == pdFALSE) {
-        ESP_LOGE(TAG, "Failed to acquire nrf24 mutex");
-        return ESP_ERR_TIMEOUT;
+/// @brief Fills the ranked patterns and remotes of last_scan_result from the scan counting tables
+/// The learned remote id is the one heard most often, not the last one decoded
+static void nrf24_scan_rank(void) {
+    xiaomi_topk_entry_t top[XIAOMI_TOPK_SLOTS];
+    uint8_t* pattern_bytes[XIAOMI_SCAN_TOP_PATTERNS] = {
+        last_scan_result.pattern_0,
+        last_scan_result.pattern_1,
+        last_scan_result.pattern_2,
+    };
+
+    portENTER_CRITICAL(&scan_lock);
+    size_t count = xiaomi_topk_sorted(&scan_patterns, top, XIAOMI_SCAN_TOP_PATTERNS);
+    for (size_t i = 0; i < count; i++) {
+        xiaomi_scan_hit_t* hit = &last_scan_result.patterns[i];
+        hit->remote_id = (uint32_t)(top[i].key >> 16);
+        hit->cmd = (uint8_t)(top[i].key >> 8);
+        hit->param = (uint8_t)top[i].key;
+        hit->hits = top[i].count;
+
+        uint8_t* bytes = pattern_bytes[i];
+        bytes[0] = (uint8_t)(hit->remote_id >> 16);
+        bytes[1] = (uint8_t)(hit->remote_id >> 8);
+        bytes[2] = (uint8_t)hit->remote_id;
+        bytes[3] = hit->cmd;
+        bytes[4] = hit->param;
     }
+    last_scan_result.pattern_count = (uint8_t)count;
 
-    esp_err_t err;
+    count = xiaomi_topk_sorted(&scan_remotes, top, XIAOMI_SCAN_TOP_REMOTES);
+    for (size_t i = 0; i < count; i++) {
+        last_scan_result.remotes[i] = (xiaomi_scan_hit_t){.remote_id = (uint32_t)top[i].key, .hits = top[i].count};
+    }
+    last_scan_result.remote_count = (uint8_t)count;
+    last_scan_result.remote_id = (count > 0) ? last_scan_result.remotes[0].remote_id : 0;
+    portEXIT_CRITICAL(&scan_lock);
+}
 
-    memset(&last_scan_result, 0, sizeof(last_scan_result));
-    last_scan_result.last_scan_time = esp_log_timestamp();
-    last_scan_result.id_found = 0;
-    last_scan_result.remote_id = 0;
-
-    ESP_LOGI(TAG, "Starting quick Xiaomi scan for %u ms", duration_ms);
-
-    nrf24_write_register(NRF_REG_EN_AA, 0x00, NULL);
-    nrf24_write_register(NRF_REG_SETUP_RETR, 0x00, NULL);
-    nrf24_write_register(NRF_REG_EN_RXADDR, 0x01, NULL);
-    nrf24_write_register(NRF_REG_SETUP_AW, 0x03, NULL);
-    nrf24_write_register(NRF_REG_DYNPD, 0x00, NULL);
-    nrf24_write_register(NRF_REG_FEATURE, 0x00, NULL);
-    nrf24_write_register(NRF_REG_RF_SETUP, 0x0E, NULL);
-    nrf24_write_register(NRF_REG_RX_PW_P0, 32, NULL);
-    nrf24_write_register_buf(NRF_REG_RX_ADDR_P0, (const uint8_t[]){0xAA, 0xAA, 0xAA, 0xAA, 0xAA}, 5);
-    nrf24_command(NRF_CMD_FLUSH_RX, NULL);
-    nrf24_write_register(NRF_REG_CONFIG, 0x03, NULL);
+/// @brief Accounts a decoded frame against the confidence rule of the running scan
+/// A remote repeats every press on all its channels with one sequence number, so presses are counted by sequence
+/// change and channels by any frame. Remotes are tracked in a few slots, a new remote takes over the slot with the
+/// fewest presses once they are full
+/// @param remote_id Remote the frame came from
+/// @param seq Sequence number of the frame
+/// @param channel RF channel the frame was received on
+/// @return true once that remote met the rule
+static bool nrf24_scan_confirm(uint32_t remote_id, uint8_t seq, uint8_t channel) {
+    if (scan_options.rule.frames == 0) {
+        return false;
+    }
 
-    vTaskDelay(pdMS_TO_TICKS(5));
+    size_t slot = 0;
+    while (slot < scan_confirm_count && scan_confirm[slot].remote_id != remote_id) {
+        slot++;
+    }
+    if (slot == scan_confirm_count) {
+        if (scan_confirm_count < XIAOMI_SCAN_TOP_REMOTES) {
+            scan_confirm_count++;
+        } else {
+            slot = 0;
+            for (size_t i = 1; i < scan_confirm_count; i++) {
+                if (scan_confirm[i].presses < scan_confirm[slot].presses) {
+                    slot = i;
+                }
+            }
+        }
+        scan_confirm[slot].remote_id = remote_id;
+        scan_confirm[slot].presses = 0;
+        scan_confirm[slot].channel_mask = 0;
+    }
 
-    static const uint8_t channels[] = {6, 15, 43, 68};
-    uint32_t start_ms = esp_log_timestamp();
+    bool new_press = scan_confirm[slot].presses == 0 || scan_confirm[slot].last_seq != seq;
+    if (new_press && scan_confirm[slot].presses < UINT8_MAX) {
+        scan_confirm[slot].presses++;
+        scan_confirm[slot].last_seq = seq;
+    }
+    for (size_t i = 0; i < scan_options.channel_count; i++) {
+        if (scan_options.channels[i] == channel) {
+            scan_confirm[slot].channel_mask |= (uint16_t)(1U << i);
+        }
+    }
 
-    for (;;) {
-        uint32_t elapsed = esp_log_timestamp() - start_ms;
-        if (elapsed >= duration_ms) {
-            break;
+    const nrf24_scan_rule_t* rule = &scan_options.rule;
+    int channels = __builtin_popcount(scan_confirm[slot].channel_mask);
+    return scan_confirm[slot].presses >= rule->frames && channels >= rule->channels;
+}
+
+/// @brief Drains the RX FIFO and decodes every payload it holds
+/// Follows the datasheet sequence: read payload, clear RX_DR, then check FIFO_STATUS so a packet landing
+/// while draining raises a fresh IRQ edge instead of being missed
+/// Unique presses go to the event ring, repeats of the same press on other channels are only logged at debug level
+/// Every payload, decoded or not, is kept in the raw capture ring
+/// @param channel RF channel the payloads were received on
+/// @param scanning true to also account the frames in last_scan_result
+/// @return ESP_OK on success, error code on SPI failure
+static esp_err_t nrf24_drain_rx_fifo(uint8_t channel, bool scanning) {
+    uint8_t fifo = 0;
+    xiaomi_frame_t pkt;
+    do {
+        static uint8_t raw[32] = {0};
+        uint8_t status = 0;
+        esp_err_t err = nrf24_read_payload(raw, sizeof(raw), &status);
+        if (err != ESP_OK) {
+            return err;
         }
+        nrf24_write_register(NRF_REG_STATUS, NRF_STATUS_RX_DR, NULL);
 
-        for (size_t c = 0; c < sizeof(channels); c++) {
-            nrf24_write_register(NRF_REG_RF_CH, channels[c], NULL);
-            nrf24_command(NRF_CMD_FLUSH_RX, NULL);
-            gpio_set_level(PIN_NUM_CE, 1);
-            vTaskDelay(pdMS_TO_TICKS(20));
+        uint8_t pipe = NRF_STATUS_RX_P_NO(status);
+        bool counted = pipe < NRF24_RX_PIPES;
+        if (counted) {
+            radio_stats.rx_pipe_payloads[pipe]++;
+        }
+        if (scanning) {
+            portENTER_CRITICAL(&scan_lock);
+            last_scan_result.payload_count++;
+            portEXIT_CRITICAL(&scan_lock);
+        }
 
-            uint8_t status = 0;
-            nrf24_read_register(NRF_REG_STATUS, &status, NULL);
-            if ((status & NRF_STATUS_RX_DR) == 0) {
-                gpio_set_level(PIN_NUM_CE, 0);
-                continue;
+        if (!xiaomi_decode(raw, sizeof(raw), &pkt)) {
+            nrf24_trace(NRF24_TRACE_DECODE_FAIL, channel, 0);
+            nrf24_capture_record(channel, pipe, NRF24_CAPTURE_UNDECODED, raw);
+        } else {
+            nrf24_trace(NRF24_TRACE_DECODE_OK, channel, (uint16_t)pkt.id);
+            int64_t decoded_us = esp_timer_get_time();
+            bool unique = xiaomi_events_push(&pkt, channel);
+            nrf24_capture_record(channel, pipe, unique ? NRF24_CAPTURE_XIAOMI : NRF24_CAPTURE_XIAOMI_REPEAT, raw);
+            if (counted) {
+                radio_stats.rx_pipe_decoded[pipe]++;
+            }
+            xiaomi_action_t action;
+            if (unique && xiaomi_command_decode(pkt.cmd, pkt.param, &action)) {
+                xiaomi_state_apply(pkt.id, &action);
             }
 
-            ESP_LOGI(TAG, "Data detected on channel %u (status=0x%02X)", channels[c], status);
+            if (unique) {
+                ESP_LOGI(TAG, "XIAOMI RX ch=%u: id=%06lX seq=%02X cmd=%02X param=%02X", (unsigned)channel,
+                         (unsigned long)pkt.id, pkt.seq, pkt.cmd, pkt.param);
+                ESP_LOG_BUFFER_HEX_LEVEL(TAG, raw, XIAOMI_FRAME_LEN, ESP_LOG_DEBUG);
+            } else {
+                ESP_LOGD(TAG, "XIAOMI RX ch=%u: repeat of id=%06lX seq=%02X", (unsigned)channel, (unsigned long)pkt.id,
+                         pkt.seq);
+            }
 
-            uint8_t fifo = 0;
-            xiaomi_packet_t pkt;
-            do {
-                static uint8_t raw[32] = {0};
-                err = nrf24_read_payload(raw, sizeof(raw));
-                if (err != ESP_OK) {
-                    gpio_set_level(PIN_NUM_CE, 0);
-                    xSemaphoreGive(nrf24_mutex);
-                    return err;
+            if (scanning) {
+                int64_t irq_us = irq_timestamp_us;
+                int command = xiaomi_command_classify(pkt.cmd, pkt.param);
+                bool confirmed = !last_scan_result.confirmed && nrf24_scan_confirm(pkt.id, pkt.seq, channel);
+                if (confirmed) {
+                    scan_confirmed_id = pkt.id;
                 }
 
-                if (nrf24_find_and_decode_packet(raw, sizeof(raw), &pkt)) {
-                    char raw_hex[3 * 18 + 4] = {0};
-                    size_t pos = 0;
-                    for (int i = 0; i < 18 && pos + 3 < sizeof(raw_hex); i++) {
-                        pos += snprintf(raw_hex + pos, sizeof(raw_hex) - pos, "%02X%s", raw[i], (i == 17 ? "" : " "));
+                portENTER_CRITICAL(&scan_lock);
+                if (irq_us != 0) {
+                    uint32_t latency_us = (uint32_t)(decoded_us - irq_us);
+                    if (latency_us > last_scan_result.max_decode_latency_us) {
+                        last_scan_result.max_decode_latency_us = latency_us;
                     }
+                }
+                last_scan_result.found_count++;
+                last_scan_result.id_found = 1;
+                if (command >= 0) {
+                    last_scan_result.commands_mask |= (uint8_t)(1U << command);
+                }
+                if (confirmed) {
+                    last_scan_result.confirmed = 1;
+                }
+                portEXIT_CRITICAL(&scan_lock);
 
-                    uint8_t seq = raw[11];
-                    uint8_t rolling = raw[12];
-                    uint8_t action = raw[13];
-                    ESP_LOGI(TAG, "XIAOMI RX ch=%u: %s [seq=%02X roll=%02X action=%02X]", (unsigned)channels[c],
-                             raw_hex, seq, rolling, action);
+                xiaomi_topk_add(&scan_patterns, ((uint64_t)pkt.id << 16) | ((uint64_t)pkt.cmd << 8) | pkt.param);
+                xiaomi_topk_add(&scan_remotes, pkt.id);
+                // Keep the ranking live so progress polls see remotes as they are found
+                nrf24_scan_rank();
+            }
+        }
 
-                    last_scan_result.found_count++;
-                    last_scan_result.remote_id = pkt.id;
-                    last_scan_result.id_found = 1;
-                }
+        nrf24_read_register(NRF_REG_FIFO_STATUS, &fifo, NULL);
+    } while ((fifo & NRF_FIFO_RX_EMPTY) == 0);
+
+    irq_timestamp_us = 0;
+    return ESP_OK;
+}
+
+/// @brief Picks the channel of the next dwell of an adaptive scan
+/// Each channel is owed an even part of NRF24_SCAN_EXPLORE_PCT of the listening time, the rest is shared in
+/// proportion to the decode rate of each channel, smoothed by one frame per NRF24_SCAN_PRIOR_MS so a channel that
+/// was barely listened to is not written off. The channel furthest behind what it is owed gets the dwell
+/// @return Index in the channel list of the scan
+static size_t nrf24_scan_pick_channel(void) {
+    size_t count = scan_options.channel_count;
+    float rates[NRF24_SCAN_CHANNELS_MAX];
+    float rate_sum = 0.0f;
+    int64_t total_us = NRF24_SCAN_DWELL_MS * 1000LL;
+    for (size_t i = 0; i < count; i++) {
+        rates[i] = (last_scan_result.channels[i].frames + 1.0f) / (scan_dwell_us[i] + NRF24_SCAN_PRIOR_MS * 1000.0f);
+        rate_sum += rates[i];
+        total_us += scan_dwell_us[i];
+    }
+
+    const float explore = NRF24_SCAN_EXPLORE_PCT / 100.0f;
+    size_t best = 0;
+    float best_deficit = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float share = explore / count + (1.0f - explore) * rates[i] / rate_sum;
+        float deficit = share * total_us - scan_dwell_us[i];
+        if (i == 0 || deficit > best_deficit) {
+            best = i;
+            best_deficit = deficit;
+        }
+    }
+    return best;
+}
+
+/// @brief Quick scan for Xiaomi lightbar patterns and save results for API access
+/// Each channel dwell blocks on the IRQ line and drains the FIFO as soon as RX_DR fires, the STATUS register is
+/// still checked at the end of the dwell so boards without the IRQ wire keep working. An interactive command ends
+/// the dwell early and suspends the scan at the channel boundary, the radio task resumes it afterwards with the
+/// listening time that was left. The scan ends as soon as one remote meets the confidence rule
+/// Dwells go to the channels in turn, or to the channel picked by nrf24_scan_pick_channel for an adaptive scan
+/// @param duration_ms Duration of scan in milliseconds (e.g., 10000 for 10 seconds)
+/// @param options Channel list, strategy and confidence rule of the scan
+/// @param resume true to continue a suspended scan, its results so far are kept
+/// @return ESP_OK if patterns found, ESP_ERR_NOT_FOUND otherwise, ESP_ERR_NOT_FINISHED when suspended
+static esp_err_t nrf24_radio_scan(uint32_t duration_ms, const nrf24_scan_options_t* options, bool resume) {
+    esp_err_t err = nrf24_init_spi();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    scan_options = *options;
+    if (!resume) {
+        portENTER_CRITICAL(&scan_lock);
+        memset(&last_scan_result, 0, sizeof(last_scan_result));
+        last_scan_result.last_scan_time = esp_log_timestamp();
+        last_scan_result.strategy = options->strategy;
+        last_scan_result.channel_count = options->channel_count;
+        for (size_t i = 0; i < options->channel_count; i++) {
+            last_scan_result.channels[i].channel = options->channels[i];
+        }
+        portEXIT_CRITICAL(&scan_lock);
+        xiaomi_topk_reset(&scan_patterns);
+        xiaomi_topk_reset(&scan_remotes);
+        memset(scan_dwell_us, 0, sizeof(scan_dwell_us));
+        scan_cursor = 0;
+        scan_confirm_count = 0;
+        scan_confirmed_id = 0;
+
+        ESP_LOGI(TAG, "Starting quick Xiaomi scan for %u ms on %u channels (%s)", duration_ms,
+                 (unsigned)options->channel_count, nrf24_scan_strategy_name(options->strategy));
+    }
+
+    // Every channel dwell flushes RX, the profile only has to put the radio in sniffer mode
+    nrf24_set_ce(false);
+    err = nrf24_apply_profile(nrf24_listen_profile());
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // Drop any edge left over from a previous operation before listening
+    irq_timestamp_us = 0;
+    xTaskNotifyWait(0, NRF24_NOTIFY_IRQ, NULL, 0);
+    irq_wait_task = xTaskGetCurrentTaskHandle();
+
+    bool adaptive = options->strategy == NRF24_SCAN_ADAPTIVE;
+    uint32_t start_ms = esp_log_timestamp() - last_scan_result.listened_ms;
+
+    while (!last_scan_result.confirmed && esp_log_timestamp() - start_ms < duration_ms) {
+        if (uxQueueMessagesWaiting(radio_urgent_queue) > 0) {
+            portENTER_CRITICAL(&scan_lock);
+            last_scan_result.listened_ms = esp_log_timestamp() - start_ms;
+            portEXIT_CRITICAL(&scan_lock);
+            irq_wait_task = NULL;
+            nrf24_scan_rank();
+            return ESP_ERR_NOT_FINISHED;
+        }
 
-                nrf24_read_register(NRF_REG_FIFO_STATUS, &fifo, NULL);
-            } while ((fifo & NRF_FIFO_RX_EMPTY) == 0);
+        size_t c = adaptive ? nrf24_scan_pick_channel() : scan_cursor;
+        uint8_t channel = options->channels[c];
+        uint32_t found_before = last_scan_result.found_count;
+        int64_t dwell_from_us = esp_timer_get_time();
+
+        nrf24_write_register(NRF_REG_RF_CH, channel, NULL);
+        nrf24_command(NRF_CMD_FLUSH_RX, NULL);
+        nrf24_write_register(NRF_REG_STATUS, NRF_STATUS_RX_DR, NULL);
+        nrf24_set_ce(true);
+
+        TickType_t dwell_start = xTaskGetTickCount();
+        TickType_t dwell = pdMS_TO_TICKS(NRF24_SCAN_DWELL_MS);
+        for (;;) {
+            TickType_t spent = xTaskGetTickCount() - dwell_start;
+            bool irq = (spent < dwell) && nrf24_wait_irq(dwell - spent);
+
+            uint8_t status = 0;
+            nrf24_read_register(NRF_REG_STATUS, &status, NULL);
+            if (status & NRF_STATUS_RX_DR) {
+                nrf24_trace(NRF24_TRACE_RX_DR, channel, 0);
+                ESP_LOGD(TAG, "Data detected on channel %u (status=0x%02X)", channel, status);
+
+                err = nrf24_drain_rx_fifo(channel, true);
+                if (err != ESP_OK) {
+                    nrf24_set_ce(false);
+                    irq_wait_task = NULL;
+                    nrf24_scan_rank();
+                    return err;
+                }
+                if (last_scan_result.confirmed) {
+                    portENTER_CRITICAL(&scan_lock);
+                    last_scan_result.identify_ms = esp_log_timestamp() - start_ms;
+                    portEXIT_CRITICAL(&scan_lock);
+                    break;
+                }
+            }
 
-            nrf24_write_register(NRF_REG_STATUS, NRF_STATUS_RX_DR, NULL);
-            gpio_set_level(PIN_NUM_CE, 0);
+            if (!irq) {
+                break;
+            }
         }
 
-        vTaskDelay(pdMS_TO_TICKS(5));
+        nrf24_set_ce(false);
+
+        scan_dwell_us[c] += esp_timer_get_time() - dwell_from_us;
+        portENTER_CRITICAL(&scan_lock);
+        last_scan_result.channels[c].dwell_ms = (uint32_t)(scan_dwell_us[c] / 1000);
+        last_scan_result.channels[c].frames += last_scan_result.found_count - found_before;
+        last_scan_result.listened_ms = esp_log_timestamp() - start_ms;
+        portEXIT_CRITICAL(&scan_lock);
+
+        if (!adaptive) {
+            scan_cursor = (c + 1) % options->channel_count;
+            if (scan_cursor == 0) {
+                vTaskDelay(pdMS_TO_TICKS(5));
+            }
+        }
     }
 
-    ESP_LOGI(TAG, "Quick Xiaomi scan complete. Found %u packets%s", last_scan_result.found_count,
-             last_scan_result.id_found ? ", ID decoded" : "");
+    irq_wait_task = NULL;
+    nrf24_scan_rank();
+    if (last_scan_result.confirmed) {
+        // The ranking may still favor a remote that was heard often but on a single channel
+        portENTER_CRITICAL(&scan_lock);
+        last_scan_result.remote_id = scan_confirmed_id;
+        portEXIT_CRITICAL(&scan_lock);
+        ESP_LOGI(TAG, "Remote 0x%06lX identified after %lu ms", (unsigned long)scan_confirmed_id,
+                 (unsigned long)last_scan_result.identify_ms);
+    }
 
-    xSemaphoreGive(nrf24_mutex);
+    ESP_LOGI(TAG, "Quick Xiaomi scan complete. Found %u packets%s, %lu payloads in %lu ms",
+             last_scan_result.found_count, last_scan_result.id_found ? ", ID decoded" : "",
+             (unsigned long)last_scan_result.payload_count, (unsigned long)last_scan_result.listened_ms);
+    if (last_scan_result.remote_count > 1) {
+        ESP_LOGI(TAG, "%u remotes heard, keeping 0x%06lX", last_scan_result.remote_count,
+                 (unsigned long)last_scan_result.remote_id);
+    }
 
     return last_scan_result.id_found ? ESP_OK : (last_scan_result.found_count > 0 ? ESP_OK : ESP_ERR_NOT_FOUND);
 }
 
-/// @brief Get last scan result (for API access)
-/// @return Pointer to last scan result structure
-const xiaomi_scan_result_t* nrf24_get_last_scan_result(void) { return &last_scan_result; }
+/// @brief Samples the RPD on the next channel and folds the hit ratio into the rolling histogram
+/// Runs in the radio task between commands. One channel busy-waits ~3 ms for its RX windows, the caller sleeps
+/// before the next one so a queued command and the other tasks never wait behind a whole sweep
+/// @return ESP_OK on success, error code on SPI failure
+static esp_err_t nrf24_radio_survey_channel(void) {
+    nrf24_ce_write(false);
+    esp_err_t err = nrf24_apply_profile(nrf24_listen_profile());
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    uint8_t channel = survey_next_channel;
+    err = nrf24_write_register(NRF_REG_RF_CH, channel, NULL);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // The RPD latches when CE drops, one sample per RX window
+    uint32_t hits = 0;
+    for (int s = 0; s < NRF24_SURVEY_SAMPLES; s++) {
+        nrf24_ce_write(true);
+        esp_rom_delay_us(NRF24_RPD_SETTLE_US);
+        nrf24_ce_write(false);
+
+        uint8_t rpd = 0;
+        err = nrf24_read_register(NRF_REG_RPD, &rpd, NULL);
+        if (err != ESP_OK) {
+            return err;
+        }
+        hits += rpd & 0x01;
+    }
+
+    int32_t sample = (int32_t)(hits * 0xFFFF / NRF24_SURVEY_SAMPLES);
+    if (survey_sweeps == 0) {
+        survey_occupancy[channel] = (uint16_t)sample;
+    } else {
+        int32_t occ = survey_occupancy[channel];
+        survey_occupancy[channel] = (uint16_t)(occ + ((sample - occ) >> NRF24_SURVEY_EWMA_SHIFT));
+    }
+
+    if (++survey_next_channel >= NRF24_CHANNEL_COUNT) {
+        survey_next_channel = 0;
+        survey_sweeps++;
+    }
+
+    return ESP_OK;
+}
+
+/// @brief Listens for Xiaomi frames until a command is queued, runs in the radio task while idle
+/// Hops over the Xiaomi channels with the same IRQ-driven dwell as the scan and, when the survey is enabled, samples
+/// one survey channel every NRF24_SNIFF_SURVEY_PERIOD_MS. A failed health check ends the loop so the radio task
+/// goes back to connection checks
+/// @return ESP_OK when a command is pending, sniffing was disabled or the radio was lost, error code on SPI failure
+static esp_err_t nrf24_radio_sniff(void) {
+    static const uint8_t channels[] = {6, 15, 43, 68};
+
+    nrf24_set_ce(false);
+    esp_err_t err = nrf24_apply_profile(nrf24_listen_profile());
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    irq_timestamp_us = 0;
+    xTaskNotifyWait(0, NRF24_NOTIFY_IRQ | NRF24_NOTIFY_CMD, NULL, 0);
+    irq_wait_task = xTaskGetCurrentTaskHandle();
+
+    TickType_t last_survey = xTaskGetTickCount();
+    while (sniff_enabled && radio_ready && nrf24_cmd_pending() == 0 && err == ESP_OK) {
+        uint8_t channel = channels[sniff_channel_index];
+        sniff_channel_index = (sniff_channel_index + 1) % sizeof(channels);
+
+        nrf24_write_register(NRF_REG_RF_CH, channel, NULL);
+        nrf24_command(NRF_CMD_FLUSH_RX, NULL);
+        nrf24_write_register(NRF_REG_STATUS, NRF_STATUS_RX_DR, NULL);
+        nrf24_set_ce(true);
+
+        TickType_t dwell_start = xTaskGetTickCount();
+        TickType_t dwell = pdMS_TO_TICKS(NRF24_SNIFF_DWELL_MS);
+        bool pending = false;
+        while (!pending && err == ESP_OK) {
+            uint32_t bits = 0;
+            TickType_t spent = xTaskGetTickCount() - dwell_start;
+            bool woken = (spent < dwell) &&
+                         xTaskNotifyWait(0, NRF24_NOTIFY_IRQ | NRF24_NOTIFY_CMD, &bits, dwell - spent) == pdTRUE;
+            pending = nrf24_cmd_pending() > 0;
+
+            uint8_t status = 0;
+            nrf24_read_register(NRF_REG_STATUS, &status, NULL);
+            if (status & NRF_STATUS_RX_DR) {
+                nrf24_trace(NRF24_TRACE_RX_DR, channel, 0);
+                err = nrf24_drain_rx_fifo(channel, false);
+            }
+
+            if (!woken) {
+                break;
+            }
+        }
+
+        nrf24_set_ce(false);
+
+        if (!pending && survey_enabled &&
+            xTaskGetTickCount() - last_survey >= pdMS_TO_TICKS(NRF24_SNIFF_SURVEY_PERIOD_MS)) {
+            err = nrf24_radio_survey_channel();
+            if (err == ESP_OK) {
+                err = nrf24_apply_profile(nrf24_listen_profile());
+            }
+            last_survey = xTaskGetTickCount();
+        }
+
+        if (!pending && err == ESP_OK && esp_timer_get_time() >= health_next_us) {
+            nrf24_health_run();
+            // A passing check may have moved the SPI clock and dropped the mirror, load the profile again
+            if (radio_ready) {
+                err = nrf24_apply_profile(nrf24_listen_profile());
+            }
+        }
+    }
+
+    nrf24_set_ce(false);
+    irq_wait_task = NULL;
+    return err;
+}
+
+/// @brief Parks the chip in power down, registers and FIFO contents are kept and the next profile load wakes it
+/// @return ESP_OK on success, error code on SPI failure
+static esp_err_t nrf24_power_down(void) {
+    nrf24_set_ce(false);
+
+    uint8_t config = 0;
+    esp_err_t err = nrf24_read_register(NRF_REG_CONFIG, &config, NULL);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    return nrf24_write_register(NRF_REG_CONFIG, config & ~NRF_CONFIG_PWR_UP, NULL);
+}
+
+/// @brief Runs background work until a command is queued: sniffing, one survey channel, power down, or nothing
+/// The sniffer keeps the chip in RX on purpose. Otherwise the chip is parked once no command came for
+/// power_idle_ms, the survey stops until the next command so only a command pays for the wake up
+static void nrf24_radio_idle(void) {
+    bool sniff_failed = false;
+    if (radio_ready && sniff_enabled) {
+        esp_err_t err = nrf24_spi_acquire();
+        if (err == ESP_OK) {
+            err = nrf24_radio_sniff();
+            nrf24_spi_release();
+        }
+        if (err == ESP_OK) {
+            return;
+        }
+
+        ESP_LOGW(TAG, "Sniffer interrupted: %s", esp_err_to_name(err));
+        sniff_failed = true;
+    }
+
+    // After a sniffer failure back off instead of spinning on a failing bus
+    int64_t now = esp_timer_get_time();
+    bool surveying = radio_ready && survey_enabled && !sniff_failed && !power_parked;
+    TickType_t wait = sniff_failed ? pdMS_TO_TICKS(NRF24_SNIFF_RETRY_MS) : portMAX_DELAY;
+    if (surveying) {
+        // The first channel waits for the queue to stay quiet, the next ones follow one per step
+        int64_t quiet_us = power_last_cmd_us + (int64_t)NRF24_SURVEY_IDLE_MS * 1000 - now;
+        uint32_t quiet_ms = quiet_us > 0 ? (uint32_t)(quiet_us / 1000) : 0;
+        wait = pdMS_TO_TICKS(quiet_ms > NRF24_SURVEY_STEP_MS ? quiet_ms : NRF24_SURVEY_STEP_MS);
+    }
+
+    bool parking = false;
+    if (radio_ready && !sniff_failed && !power_parked && power_idle_ms > 0) {
+        int64_t left_us = power_last_cmd_us + (int64_t)power_idle_ms * 1000 - now;
+        TickType_t left = left_us > 0 ? pdMS_TO_TICKS((uint32_t)(left_us / 1000)) : 0;
+        if (left <= wait) {
+            wait = left;
+            parking = true;
+        }
+    }
+
+    // The health check comes first, parking is picked up again on the next round
+    bool probing = false;
+    int64_t health_left_us = health_next_us - now;
+    TickType_t health_left = health_left_us > 0 ? pdMS_TO_TICKS((uint32_t)(health_left_us / 1000)) : 0;
+    if (health_left <= wait) {
+        wait = health_left;
+        probing = true;
+        parking = false;
+    }
+
+    if (nrf24_wait_cmd(wait)) {
+        return;
+    }
+
+    if (probing) {
+        if (nrf24_spi_acquire() == ESP_OK) {
+            nrf24_health_run();
+            nrf24_spi_release();
+        } else {
+            health_next_us = esp_timer_get_time() + (int64_t)NRF24_HEALTH_PERIOD_MS * 1000;
+        }
+        return;
+    }
+
+    if (parking) {
+        if (nrf24_spi_acquire() == ESP_OK) {
+            esp_err_t err = nrf24_power_down();
+            nrf24_spi_release();
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "Power down failed: %s", esp_err_to_name(err));
+            }
+        }
+        // Also on failure, a bus that keeps failing must not be retried in a loop
+        power_parked = true;
+        return;
+    }
+    if (!surveying) {
+        return;
+    }
+
+    if (nrf24_spi_acquire() == ESP_OK) {
+        nrf24_radio_survey_channel();
+        nrf24_spi_release();
+    }
+}
+
+/// @brief Takes a free completion handle from the pool
+/// @param keep_handle true if the submitter keeps a reference to wait on or poll the job
+/// @return Pointer to the job or NULL if the pool is exhausted
+static nrf24_job_t* nrf24_job_alloc(bool keep_handle) {
+    nrf24_job_t* job = NULL;
+
+    portENTER_CRITICAL(&job_lock);
+    for (size_t i = 0; i < NRF24_JOB_POOL_SIZE; i++) {
+        if (!job_pool[i].in_use) {
+            job = &job_pool[i];
+            job->in_use = true;
+            job->refs = keep_handle ? 2 : 1;
+            job->done = false;
+            job->abandoned = false;
+            job->result = ESP_ERR_NOT_FINISHED;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&job_lock);
+
+    if (job != NULL) {
+        // Drop a completion left over from a previous user of this slot
+        xSemaphoreTake(job->done_sem, 0);
+    }
+
+    return job;
+}
+
+/// @brief Drops one reference on a job, the slot returns to the pool once both sides released it
+/// @param job Job to release (NULL is ignored)
+void nrf24_job_release(nrf24_job_t* job) {
+    if (job == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&job_lock);
+    if (job->refs > 0 && --job->refs == 0) {
+        job->in_use = false;
+    }
+    portEXIT_CRITICAL(&job_lock);
+}
+
+/// @brief Publishes the result of a job and wakes a waiting submitter
+/// @param job Job to complete (NULL for fire-and-forget)
+/// @param result Result of the radio operation
+static void nrf24_job_complete(nrf24_job_t* job, esp_err_t result) {
+    if (job == NULL) {
+        return;
+    }
+
+    job->result = result;
+    job->done = true;
+    xSemaphoreGive(job->done_sem);
+    nrf24_job_release(job);
+}
+
+/// @brief Gives up on a job, the radio task drops its command unless it already started
+/// A timed out transmission must not reach the air once the caller reported the failure
+/// @param job Job handle returned by a submit call
+static void nrf24_job_abandon(nrf24_job_t* job) {
+    if (job != NULL) {
+        job->abandoned = true;
+    }
+}
+
+/// @brief Waits for a submitted job to complete
+/// @param job Job handle returned by a submit call
+/// @param timeout_ms Maximum time to wait in milliseconds
+/// @return Result of the radio operation, ESP_ERR_TIMEOUT if it is still running
+esp_err_t nrf24_job_wait(nrf24_job_t* job, uint32_t timeout_ms) {
+    if (job == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!job->done && xSemaphoreTake(job->done_sem, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return job->result;
+}
+
+/// @brief Polls a submitted job without blocking
+/// @param job Job handle returned by a submit call
+/// @param result Pointer to store the result once done (can be NULL if not needed)
+/// @return true if the job has completed, false otherwise
+bool nrf24_job_poll(const nrf24_job_t* job, esp_err_t* result) {
+    if (job == NULL || !job->done) {
+        return false;
+    }
+    if (result) {
+        *result = job->result;
+    }
+
+    return true;
+}
+
+/// @brief Queues a command for the radio task
+/// @param cmd Command to queue, its job field is filled here
+/// @param job Pointer to store the completion handle, NULL to fire and forget
+/// @return ESP_OK if queued, ESP_ERR_INVALID_STATE before nrf24_init or when the radio task failed to start,
+/// ESP_ERR_NO_MEM if the queue or pool is full
+static esp_err_t nrf24_submit(nrf24_cmd_t* cmd, nrf24_job_t** job) {
+    // Nothing would ever take the command off the queue
+    if (radio_queue == NULL || radio_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    cmd->job = nrf24_job_alloc(job != NULL);
+    if (cmd->job == NULL) {
+        ESP_LOGW(TAG, "No free radio job slot");
+        return ESP_ERR_NO_MEM;
+    }
+
+    cmd->queued_us = esp_timer_get_time();
+    bool urgent = cmd->type == NRF24_CMD_TX_BURST || cmd->type == NRF24_CMD_HOLD;
+    if (xQueueSend(urgent ? radio_urgent_queue : radio_queue, cmd, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Radio queue full, dropping command %d", cmd->type);
+        if (job) {
+            nrf24_job_release(cmd->job);
+        }
+        nrf24_job_release(cmd->job);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (job) {
+        *job = cmd->job;
+    }
+
+    xTaskNotify(radio_task, NRF24_NOTIFY_CMD, eSetBits);
+
+    return ESP_OK;
+}
+
+/// @brief Submits a connection check to the radio task
+/// @param job Pointer to store the completion handle, NULL to fire and forget
+/// @return ESP_OK if queued, error code otherwise
+esp_err_t nrf24_submit_check(nrf24_job_t** job) {
+    nrf24_cmd_t cmd = {.type = NRF24_CMD_CHECK};
+    return nrf24_submit(&cmd, job);
+}
+
+/// @brief Builds a burst command after validating every remote and action
+/// @param remote_ids 24-bit remote ids
+/// @param remote_count Number of remotes (1..NRF24_XIAOMI_GROUP_MAX)
+/// @param actions Commands to send, in order
+/// @param count Number of commands (1..NRF24_XIAOMI_BURST_MAX)
+/// @param cmd Command to fill
+/// @return ESP_OK on success, ESP_ERR_INVALID_ARG on invalid id, command or step
+static esp_err_t nrf24_prepare_burst(const uint32_t* remote_ids, size_t remote_count, const xiaomi_action_t* actions,
+                                     size_t count, nrf24_cmd_t* cmd) {
+    if (remote_ids == NULL || remote_count == 0 || remote_count > NRF24_XIAOMI_GROUP_MAX || actions == NULL ||
+        count == 0 || count > NRF24_XIAOMI_BURST_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t r = 0; r < remote_count; r++) {
+        if (remote_ids[r] > 0xFFFFFF) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t code = 0;
+        uint8_t param = 0;
+        if (!xiaomi_command_encode(&actions[i], &code, &param)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->type = NRF24_CMD_TX_BURST;
+    cmd->tx.remote_count = (uint8_t)remote_count;
+    memcpy(cmd->tx.remote_ids, remote_ids, remote_count * sizeof(remote_ids[0]));
+    cmd->tx.count = (uint8_t)count;
+    memcpy(cmd->tx.actions, actions, count * sizeof(actions[0]));
+
+    return ESP_OK;
+}
+
+/// @brief Submits a Xiaomi command burst for one or more remotes to the radio task
+/// @param remote_ids 24-bit remote ids
+/// @param remote_count Number of remotes (1..NRF24_XIAOMI_GROUP_MAX)
+/// @param actions Commands to send, in order
+/// @param count Number of commands (1..NRF24_XIAOMI_BURST_MAX)
+/// @param job Pointer to store the completion handle, NULL to fire and forget
+/// @return ESP_OK if queued, error code otherwise
+esp_err_t nrf24_submit_xiaomi_burst(const uint32_t* remote_ids, size_t remote_count, const xiaomi_action_t* actions,
+                                    size_t count, nrf24_job_t** job) {
+    nrf24_cmd_t cmd;
+    esp_err_t err = nrf24_prepare_burst(remote_ids, remote_count, actions, count, &cmd);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    return nrf24_submit(&cmd, job);
+}
+
+/// @brief Submits a Xiaomi power toggle burst to the radio task
+/// @param remote_id 24-bit remote id
+/// @param job Pointer to store the completion handle, NULL to fire and forget
+/// @return ESP_OK if queued, error code otherwise
+esp_err_t nrf24_submit_xiaomi_power(uint32_t remote_id, nrf24_job_t** job) {
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    return nrf24_submit_xiaomi_burst(&remote_id, 1, &toggle, 1, job);
+}
+
+/// @brief Fills the default scan options: the Xiaomi channels, adaptive dwell and the default confidence rule
+/// @param out Options to fill
+void nrf24_scan_options_default(nrf24_scan_options_t* out) {
+    static const uint8_t xiaomi_channels[] = {6, 15, 43, 68};
+
+    memset(out, 0, sizeof(*out));
+    out->rule.frames = NRF24_SCAN_CONFIRM_FRAMES_DEFAULT;
+    out->rule.channels = NRF24_SCAN_CONFIRM_CHANNELS_DEFAULT;
+    out->strategy = NRF24_SCAN_ADAPTIVE;
+    out->channel_count = sizeof(xiaomi_channels);
+    memcpy(out->channels, xiaomi_channels, sizeof(xiaomi_channels));
+}
+
+/// @brief Name of a scan strategy, as used by the API
+/// @param strategy nrf24_scan_strategy_t value
+/// @return Static string
+const char* nrf24_scan_strategy_name(uint8_t strategy) {
+    switch (strategy) {
+        case NRF24_SCAN_ROUND_ROBIN:
+            return "round_robin";
+        case NRF24_SCAN_ADAPTIVE:
+            return "adaptive";
+        default:
+            return "unknown";
+    }
+}
+
+/// @brief Builds a scan command, falling back to the default options
+/// A rule with 0 channels needs every channel of the list
+/// @param duration_ms Duration of scan in milliseconds
+/// @param options Channel list, strategy and confidence rule, NULL for the defaults
+/// @param out Command to fill
+/// @return ESP_OK on success, ESP_ERR_INVALID_ARG for an empty or duplicated channel list, an out of range channel,
+/// an unknown strategy or a rule asking for more channels than the list holds
+static esp_err_t nrf24_prepare_scan(uint32_t duration_ms, const nrf24_scan_options_t* options, nrf24_cmd_t* out) {
+    *out = (nrf24_cmd_t){.type = NRF24_CMD_SCAN, .scan = {.duration_ms = duration_ms}};
+    if (options == NULL) {
+        nrf24_scan_options_default(&out->scan.options);
+        return ESP_OK;
+    }
+
+    if (options->channel_count == 0 || options->channel_count > NRF24_SCAN_CHANNELS_MAX ||
+        options->strategy > NRF24_SCAN_ADAPTIVE || options->rule.channels > options->channel_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < options->channel_count; i++) {
+        if (options->channels[i] >= NRF24_CHANNEL_COUNT) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        for (size_t j = 0; j < i; j++) {
+            if (options->channels[j] == options->channels[i]) {
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
+
+    out->scan.options = *options;
+    if (out->scan.options.rule.channels == 0) {
+        out->scan.options.rule.channels = options->channel_count;
+    }
+    return ESP_OK;
+}
+
+/// @brief Submits a Xiaomi scan to the radio task
+/// @param duration_ms Duration of scan in milliseconds
+/// @param options Channel list, strategy and confidence rule, NULL for the defaults
+/// @param job Pointer to store the completion handle, NULL to fire and forget
+/// @return ESP_OK if queued, error code otherwise
+esp_err_t nrf24_submit_scan(uint32_t duration_ms, const nrf24_scan_options_t* options, nrf24_job_t** job) {
+    nrf24_cmd_t cmd;
+    esp_err_t err = nrf24_prepare_scan(duration_ms, options, &cmd);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    return nrf24_submit(&cmd, job);
+}
+
+/// @brief Submits a job and blocks until it completes
+/// @param cmd Command to run
+/// @param timeout_ms Maximum time to wait in milliseconds
+/// @return Result of the radio operation or submit/wait error
+static esp_err_t nrf24_run(nrf24_cmd_t* cmd, uint32_t timeout_ms) {
+    nrf24_job_t* job = NULL;
+    esp_err_t err = nrf24_submit(cmd, &job);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = nrf24_job_wait(job, timeout_ms);
+    if (err == ESP_ERR_TIMEOUT) {
+        nrf24_job_abandon(job);
+    }
+    nrf24_job_release(job);
+    return err;
+}
+
+/// @brief Checks the connection to the NRF24L01+ module (blocking wrapper)
+/// @return ESP_OK on success, error code on failure
+esp_err_t nrf24_check_connection(void) {
+    nrf24_cmd_t cmd = {.type = NRF24_CMD_CHECK};
+    return nrf24_run(&cmd, NRF24_CHECK_WAIT_MS);
+}
+
+/// @brief Copies the radio health record published by the radio task, no bus access
+/// @param out Pointer to the structure to fill
+void nrf24_get_health(nrf24_health_t* out) {
+    if (out == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&health_lock);
+    *out = radio_health;
+    portEXIT_CRITICAL(&health_lock);
+}
+
+/// @brief Name of a health verdict, as used by the API
+/// @param verdict nrf24_health_verdict_t value
+/// @return Static string
+const char* nrf24_health_verdict_name(uint8_t verdict) {
+    switch (verdict) {
+        case NRF24_HEALTH_OK:
+            return "ok";
+        case NRF24_HEALTH_NO_RESPONSE:
+            return "no_response";
+        case NRF24_HEALTH_MISMATCH:
+            return "mismatch";
+        case NRF24_HEALTH_SPI_ERROR:
+            return "spi_error";
+        default:
+            return "unknown";
+    }
+}
+
+/// @brief Sends the Xiaomi power toggle command (blocking wrapper)
+/// @param remote_id 24-bit remote id
+/// @return ESP_OK on success, error code on failure
+esp_err_t nrf24_send_xiaomi_power(uint32_t remote_id) {
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    return nrf24_send_xiaomi_burst(&remote_id, 1, &toggle, 1);
+}
+
+/// @brief Sends an ordered list of Xiaomi commands to one or more remotes in one radio session (blocking wrapper)
+/// @param remote_ids 24-bit remote ids
+/// @param remote_count Number of remotes (1..NRF24_XIAOMI_GROUP_MAX)
+/// @param actions Commands to send, in order
+/// @param count Number of commands (1..NRF24_XIAOMI_BURST_MAX)
+/// @return ESP_OK on success, error code on failure
+esp_err_t nrf24_send_xiaomi_burst(const uint32_t* remote_ids, size_t remote_count, const xiaomi_action_t* actions,
+                                  size_t count) {
+    nrf24_cmd_t cmd;
+    esp_err_t err = nrf24_prepare_burst(remote_ids, remote_count, actions, count, &cmd);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    return nrf24_run(&cmd, NRF24_TX_WAIT_MS);
+}
+
+/// @brief Scans for Xiaomi remotes (blocking wrapper)
+/// @param duration_ms Duration of scan in milliseconds
+/// @param options Channel list, strategy and confidence rule, NULL for the defaults
+/// @return ESP_OK if patterns found, ESP_ERR_NOT_FOUND otherwise
+esp_err_t nrf24_scan_xiaomi(uint32_t duration_ms, const nrf24_scan_options_t* options) {
+    nrf24_cmd_t cmd;
+    esp_err_t err = nrf24_prepare_scan(duration_ms, options, &cmd);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    return nrf24_run(&cmd, duration_ms + NRF24_SCAN_WAIT_MARGIN_MS);
+}
+
+/// @brief Calibrates the SPI clock in the radio task (blocking wrapper)
+/// @return ESP_OK on success, error code on failure
+esp_err_t nrf24_calibrate_spi(void) {
+    nrf24_cmd_t cmd = {.type = NRF24_CMD_CALIBRATE_SPI};
+    return nrf24_run(&cmd, NRF24_CALIBRATE_WAIT_MS);
+}
+
+/// @brief Runs the SPI microbenchmark in the radio task (blocking wrapper)
+/// @param out Pointer to store the per-write timings
+/// @return ESP_OK on success, error code on failure
+esp_err_t nrf24_benchmark_spi(nrf24_spi_bench_t* out) {
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nrf24_cmd_t cmd = {.type = NRF24_CMD_BENCH_SPI};
+    esp_err_t err = nrf24_run(&cmd, NRF24_BENCH_WAIT_MS);
+    if (err == ESP_OK) {
+        *out = last_bench;
+    }
+
+    return err;
+}
+
+/// @brief Takes the next command to run: interactive ones first, then a suspended scan, then the regular queue
+/// @param cmd Command to fill
+/// @return true if a command was taken
+static bool nrf24_next_cmd(nrf24_cmd_t* cmd) {
+    if (xQueueReceive(radio_urgent_queue, cmd, 0) == pdTRUE) {
+        return true;
+    }
+    if (scan_is_suspended) {
+        *cmd = scan_suspended;
+        scan_is_suspended = false;
+        return true;
+    }
+
+    return xQueueReceive(radio_queue, cmd, 0) == pdTRUE;
+}
+
+/// @brief Stores the remote found by the scan that just completed as the remote to address
+static void nrf24_scan_save_id(void) {
+    portENTER_CRITICAL(&scan_lock);
+    bool found = last_scan_result.id_found;
+    uint32_t remote_id = last_scan_result.remote_id;
+    portEXIT_CRITICAL(&scan_lock);
+    if (!found) {
+        return;
+    }
+
+    char remote_id_hex[16];
+    snprintf(remote_id_hex, sizeof(remote_id_hex), "0x%06lX", (unsigned long)remote_id);
+    bool saved = nvs_save_xiaomi_id(remote_id_hex);
+
+    portENTER_CRITICAL(&scan_lock);
+    last_scan_result.id_saved = saved ? 1 : 0;
+    portEXIT_CRITICAL(&scan_lock);
+}
+
+/// @brief Records how long an interactive transmission waited between its submission and the radio
+/// @param cmd Command about to run
+static void nrf24_note_tx_wait(const nrf24_cmd_t* cmd) {
+    uint32_t wait_us = (uint32_t)(esp_timer_get_time() - cmd->queued_us);
+    radio_stats.tx_wait_last_us = wait_us;
+    if (wait_us > radio_stats.tx_wait_max_us) {
+        radio_stats.tx_wait_max_us = wait_us;
+    }
+}
+
+/// @brief Radio owner task, executes queued commands one at a time with the SPI bus held
+/// @param arg Unused
+static void nrf24_radio_task(void* arg) {
+    nrf24_cmd_t cmd;
+
+    for (;;) {
+        if (!nrf24_next_cmd(&cmd)) {
+            nrf24_radio_idle();
+            continue;
+        }
+        // A resumed scan already started, everything else is dropped once its caller gave up
+        bool started = cmd.type == NRF24_CMD_SCAN && cmd.scan.resume;
+        if (!started && cmd.job != NULL && cmd.job->abandoned) {
+            ESP_LOGW(TAG, "Dropping command %d, its caller timed out", cmd.type);
+            nrf24_job_complete(cmd.job, ESP_ERR_TIMEOUT);
+            continue;
+        }
+        power_parked = false;
+
+        esp_err_t result = nrf24_spi_acquire();
+        if (result != ESP_OK) {
+            nrf24_job_complete(cmd.job, result);
+            continue;
+        }
+
+        switch (cmd.type) {
+            case NRF24_CMD_CHECK:
+                result = nrf24_radio_check_publish(true);
+                break;
+            case NRF24_CMD_TX_BURST:
+                nrf24_note_tx_wait(&cmd);
+                result = nrf24_radio_tx_burst(cmd.tx.remote_ids, cmd.tx.remote_count, cmd.tx.actions, cmd.tx.count);
+                break;
+            case NRF24_CMD_SCAN:
+                result = nrf24_radio_scan(cmd.scan.duration_ms, &cmd.scan.options, cmd.scan.resume);
+                break;
+            case NRF24_CMD_BENCH_SPI:
+                result = nrf24_radio_bench_spi();
+                break;
+            case NRF24_CMD_SURVEY:
+                survey_enabled = cmd.survey.enable;
+                result = ESP_OK;
+                break;
+            case NRF24_CMD_CALIBRATE_SPI:
+                result = nrf24_radio_calibrate_spi();
+                break;
+            case NRF24_CMD_SNIFFER:
+                sniff_enabled = cmd.sniffer.enable;
+                result = ESP_OK;
+                break;
+            case NRF24_CMD_HOLD:
+                nrf24_note_tx_wait(&cmd);
+                result = nrf24_radio_hold(cmd.hold.id, cmd.hold.remote_ids, cmd.hold.remote_count, cmd.hold.command,
+                                          cmd.hold.steps, cmd.hold.period_ms);
+                break;
+            case NRF24_CMD_MULTIPIPE:
+                capture_multipipe = cmd.multipipe.enable;
+                result = ESP_OK;
+                break;
+            case NRF24_CMD_POWER:
+                power_idle_ms = cmd.power.idle_ms;
+                portENTER_CRITICAL(&power_lock);
+                power_stats.idle_ms = power_idle_ms;
+                portEXIT_CRITICAL(&power_lock);
+                result = ESP_OK;
+                break;
+            default:
+                result = ESP_ERR_NOT_SUPPORTED;
+                break;
+        }
+
+        nrf24_spi_release();
+        power_last_cmd_us = esp_timer_get_time();
+
+        // The job stays open, the scan picks up where it stopped once the interactive commands ran
+        if (cmd.type == NRF24_CMD_SCAN && result == ESP_ERR_NOT_FINISHED) {
+            scan_suspended = cmd;
+            scan_suspended.scan.resume = true;
+            scan_is_suspended = true;
+            radio_stats.scan_preemptions++;
+            continue;
+        }
+        if (cmd.type == NRF24_CMD_SCAN && cmd.scan.save_id) {
+            nrf24_scan_save_id();
+        }
+        nrf24_job_complete(cmd.job, result);
+    }
+}
+
+/// @brief Installs a radio backend, must be called before nrf24_init
+/// @param hal Backend to use, NULL restores the ESP-IDF SPI/GPIO path
+/// @return ESP_OK on success, ESP_ERR_INVALID_ARG if a hook is missing, ESP_ERR_INVALID_STATE once the radio task
+/// is running
+esp_err_t nrf24_set_hal(const nrf24_hal_t* hal) {
+    if (radio_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (hal != NULL && (hal->transfer == NULL || hal->set_ce == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    radio_hal = hal;
+    if (hal != NULL) {
+        ESP_LOGI(TAG, "Radio backend: %s", hal->name != NULL ? hal->name : "custom");
+    }
+
+    return ESP_OK;
+}
+
+/// @brief Creates the radio command queue and starts the radio owner task
+/// @return ESP_OK on success, error code on failure
+esp_err_t nrf24_init(void) {
+    if (radio_task != NULL) {
+        return ESP_OK;
+    }
+
+    for (size_t i = 0; i < NRF24_JOB_POOL_SIZE; i++) {
+        job_pool[i].done_sem = xSemaphoreCreateBinary();
+        if (job_pool[i].done_sem == NULL) {
+            ESP_LOGE(TAG, "Failed to create radio job semaphore");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    bool survey = false;
+    if (nvs_load_nrf24_survey(&survey)) {
+        survey_enabled = survey;
+    }
+    bool sniffer = false;
+    if (nvs_load_nrf24_sniffer(&sniffer)) {
+        sniff_enabled = sniffer;
+    }
+    bool multipipe = false;
+    if (nvs_load_nrf24_multipipe(&multipipe)) {
+        capture_multipipe = multipipe;
+    }
+
+    uint32_t idle_ms = 0;
+    if (nvs_load_nrf24_power_idle(&idle_ms) && idle_ms <= NRF24_POWER_IDLE_MAX_MS) {
+        power_idle_ms = idle_ms;
+    }
+    power_stats.idle_ms = power_idle_ms;
+
+    // Resume after the last reserved block, skipping whatever the previous boot did not use
+    uint8_t seq = 0;
+    if (nvs_load_xiaomi_seq(&seq)) {
+        xiaomi_tx_seq = seq;
+    }
+    xiaomi_tx_seq_reserved = xiaomi_tx_seq + XIAOMI_SEQ_BLOCK;
+    if (!nvs_save_xiaomi_seq(xiaomi_tx_seq_reserved)) {
+        ESP_LOGW(TAG, "Failed to reserve Xiaomi sequence numbers");
+    }
+
+    radio_queue = xQueueCreate(NRF24_QUEUE_LEN, sizeof(nrf24_cmd_t));
+    radio_urgent_queue = xQueueCreate(NRF24_URGENT_QUEUE_LEN, sizeof(nrf24_cmd_t));
+    if (radio_queue == NULL || radio_urgent_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create radio queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(nrf24_radio_task, "nrf24_radio", NRF24_TASK_STACK, NULL, NRF24_TASK_PRIORITY, &radio_task) !=
+        pdPASS) {
+        ESP_LOGE(TAG, "Failed to start radio task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+/// @brief Copies the radio driver counters
+/// @param out Pointer to the structure to fill
+void nrf24_get_stats(nrf24_stats_t* out) {
+    if (out) {
+        *out = radio_stats;
+    }
+}
+
+/// @brief Enables or disables the continuous sniffer and persists the choice
+/// @param enable true to listen for remotes between commands
+/// @return ESP_OK on success, error code on failure
+esp_err_t nrf24_sniffer_enable(bool enable) {
+    nrf24_cmd_t cmd = {.type = NRF24_CMD_SNIFFER, .sniffer = {.enable = enable}};
+    esp_err_t err = nrf24_run(&cmd, NRF24_CHECK_WAIT_MS);
+    if (err == ESP_OK && !nvs_save_nrf24_sniffer(enable)) {
+        ESP_LOGW(TAG, "Failed to persist sniffer mode");
+    }
+
+    return err;
+}
+
+/// @brief Sets how long the radio stays powered without commands, and persists it
+/// @param idle_ms Idle time in ms before power down, 0 keeps the chip powered
+/// @return ESP_OK on success, ESP_ERR_INVALID_ARG above NRF24_POWER_IDLE_MAX_MS, error code on failure
+esp_err_t nrf24_power_set_idle(uint32_t idle_ms) {
+    if (idle_ms > NRF24_POWER_IDLE_MAX_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nrf24_cmd_t cmd = {.type = NRF24_CMD_POWER, .power = {.idle_ms = idle_ms}};
+    esp_err_t err = nrf24_run(&cmd, NRF24_CHECK_WAIT_MS);
+    if (err == ESP_OK && !nvs_save_nrf24_power_idle(idle_ms)) {
+        ESP_LOGW(TAG, "Failed to persist power down delay");
+    }
+
+    return err;
+}
+
+/// @brief Copies the power manager state, the time of the current state is counted up to now
+/// @param out Pointer to the structure to fill
+void nrf24_get_power(nrf24_power_stats_t* out) {
+    if (out == NULL) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&power_lock);
+    *out = power_stats;
+    out->time_us[out->state] += (uint64_t)(now - power_since_us);
+    portEXIT_CRITICAL(&power_lock);
+}
+
+/// @brief Name of a chip power state, as used by the API
+/// @param state nrf24_power_state_t value
+/// @return Static string
+const char* nrf24_power_state_name(uint8_t state) {
+    switch (state) {
+        case NRF24_POWER_DOWN:
+            return "down";
+        case NRF24_POWER_STANDBY:
+            return "standby";
+        case NRF24_POWER_TX:
+            return "tx";
+        case NRF24_POWER_RX:
+            return "rx";
+        default:
+            return "unknown";
+    }
+}
+
+/// @brief Tells whether the continuous sniffer is listening
+/// @return true if enabled and the radio answered its connection check
+bool nrf24_sniffer_active(void) { return sniff_enabled && radio_ready; }
+
+/// @brief Switches scans, the sniffer and the survey between the single pipe and the six pipe capture profile,
+/// and persists the choice
+/// @param enable true to listen on all six pipes
+/// @return ESP_OK on success, error code on failure
+esp_err_t nrf24_capture_multipipe(bool enable) {
+    nrf24_cmd_t cmd = {.type = NRF24_CMD_MULTIPIPE, .multipipe = {.enable = enable}};
+    esp_err_t err = nrf24_run(&cmd, NRF24_CHECK_WAIT_MS);
+    if (err == ESP_OK && !nvs_save_nrf24_multipipe(enable)) {
+        ESP_LOGW(TAG, "Failed to persist capture mode");
+    }
+
+    return err;
+}
+
+/// @brief Tells whether the six pipe capture profile is selected
+/// @return true if scans and the sniffer listen on all six pipes
+bool nrf24_capture_multipipe_enabled(void) { return capture_multipipe; }
+
+/// @brief Enables or disables the background RPD survey and persists the choice
+/// @param enable true to survey while the radio is idle
+/// @return ESP_OK on success, error code on failure
+esp_err_t nrf24_survey_enable(bool enable) {
+    nrf24_cmd_t cmd = {.type = NRF24_CMD_SURVEY, .survey = {.enable = enable}};
+    esp_err_t err = nrf24_run(&cmd, NRF24_CHECK_WAIT_MS);
+    if (err == ESP_OK && !nvs_save_nrf24_survey(enable)) {
+        ESP_LOGW(TAG, "Failed to persist survey mode");
+    }
+
+    return err;
+}
+
+/// @brief Copies the RPD occupancy histogram
+/// @param out Pointer to the structure to fill, occupancy in percent per channel
+void nrf24_get_survey(nrf24_survey_t* out) {
+    if (out == NULL) {
+        return;
+    }
+
+    out->enabled = survey_enabled && radio_ready;
+    out->sweeps = survey_sweeps;
+    for (size_t i = 0; i < NRF24_CHANNEL_COUNT; i++) {
+        out->occupancy[i] = (uint8_t)((survey_occupancy[i] * 100U + 0x7FFF) / 0xFFFF);
+    }
+}
+
+/// @brief Get last scan result (for API access)
+/// @return Pointer to last scan result structure
+const xiaomi_scan_result_t* nrf24_get_last_scan_result(void) { return &last_scan_result; }
+
+/// @brief Queues a scan and returns at once, progress is read with nrf24_scan_get_status
+/// Only one scan runs at a time, the handle of a finished scan is released here if nobody polled it. The radio task
+/// stores the remote found in NVS when the scan completes
+/// @param duration_ms Duration of scan in milliseconds
+/// @param options Channel list, strategy and confidence rule, NULL for the defaults
+/// @param scan_id Pointer to store the id of the new scan
+/// @return ESP_OK if queued, ESP_ERR_INVALID_STATE if a scan is still running, submit error otherwise
+esp_err_t nrf24_scan_start(uint32_t duration_ms, const nrf24_scan_options_t* options, uint32_t* scan_id) {
+    if (scan_id == NULL || duration_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (scan_session.job != NULL) {
+        if (!nrf24_job_poll(scan_session.job, NULL)) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        nrf24_job_release(scan_session.job);
+        scan_session.job = NULL;
+    }
+
+    nrf24_cmd_t cmd;
+    esp_err_t err = nrf24_prepare_scan(duration_ms, options, &cmd);
+    if (err != ESP_OK) {
+        return err;
+    }
+    cmd.scan.save_id = true;
+
+    nrf24_job_t* job = NULL;
+    err = nrf24_submit(&cmd, &job);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    scan_session.id = scan_next_id++;
+    scan_session.job = job;
+    scan_session.start_ms = esp_log_timestamp();
+    scan_session.duration_ms = duration_ms;
+    scan_session.done = false;
+    scan_session.result = ESP_ERR_NOT_FINISHED;
+
+    *scan_id = scan_session.id;
+    return ESP_OK;
+}
+
+/// @brief Reads the progress of the latest asynchronous scan
+/// @param scan_id Id returned by nrf24_scan_start
+/// @param out Pointer to store the progress and a copy of the scan result so far
+/// @return ESP_OK on success, ESP_ERR_NOT_FOUND if scan_id is not the latest scan
+esp_err_t nrf24_scan_get_status(uint32_t scan_id, nrf24_scan_status_t* out) {
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (scan_id == 0 || scan_id != scan_session.id) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (!scan_session.done && nrf24_job_poll(scan_session.job, &scan_session.result)) {
+        scan_session.done = true;
+        nrf24_job_release(scan_session.job);
+        scan_session.job = NULL;
+    }
+
+    uint32_t elapsed = esp_log_timestamp() - scan_session.start_ms;
+    out->id = scan_session.id;
+    out->done = scan_session.done;
+    out->result = scan_session.result;
+    out->duration_ms = scan_session.duration_ms;
+    out->elapsed_ms = (scan_session.done || elapsed > scan_session.duration_ms) ? scan_session.duration_ms : elapsed;
+
+    portENTER_CRITICAL(&scan_lock);
+    out->scan = last_scan_result;
+    portEXIT_CRITICAL(&scan_lock);
+
+    if (scan_session.done && out->scan.confirmed) {
+        out->elapsed_ms = out->scan.identify_ms;
+    }
+
+    return ESP_OK;
+}
+
+/// @brief Starts holding a stepped command on one or more remotes, like keeping a remote button pressed
+/// Only one hold runs at a time, a running one must be released with nrf24_hold_stop first
+/// @param remote_ids 24-bit remote ids
+/// @param remote_count Number of remotes (1..NRF24_XIAOMI_GROUP_MAX)
+/// @param command XIAOMI_CMD_COOLER, XIAOMI_CMD_WARMER, XIAOMI_CMD_HIGHER or XIAOMI_CMD_LOWER
+/// @param steps Steps to send, 0 until nrf24_hold_stop (bounded by NRF24_HOLD_MAX_MS)
+/// @param period_ms Cadence (NRF24_HOLD_PERIOD_MIN_MS..NRF24_HOLD_PERIOD_MAX_MS)
+/// @param hold_id Pointer to store the id to poll with nrf24_hold_get_status
+/// @return ESP_OK if queued, ESP_ERR_INVALID_ARG on invalid arguments, ESP_ERR_INVALID_STATE if a hold is still
+/// running, submit error otherwise
+esp_err_t nrf24_hold_start(const uint32_t* remote_ids, size_t remote_count, xiaomi_command_t command, uint16_t steps,
+                           uint32_t period_ms, uint32_t* hold_id) {
+    if (remote_ids == NULL || remote_count == 0 || remote_count > NRF24_XIAOMI_GROUP_MAX || hold_id == NULL ||
+        period_ms < NRF24_HOLD_PERIOD_MIN_MS || period_ms > NRF24_HOLD_PERIOD_MAX_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (command != XIAOMI_CMD_COOLER && command != XIAOMI_CMD_WARMER && command != XIAOMI_CMD_HIGHER &&
+        command != XIAOMI_CMD_LOWER) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t r = 0; r < remote_count; r++) {
+        if (remote_ids[r] > 0xFFFFFF) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    if (hold_session.job != NULL) {
+        if (!nrf24_job_poll(hold_session.job, NULL)) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        nrf24_job_release(hold_session.job);
+        hold_session.job = NULL;
+    }
+
+    nrf24_cmd_t cmd = {.type = NRF24_CMD_HOLD};
+    cmd.hold.id = hold_next_id;
+    memcpy(cmd.hold.remote_ids, remote_ids, remote_count * sizeof(remote_ids[0]));
+    cmd.hold.remote_count = (uint8_t)remote_count;
+    cmd.hold.command = (uint8_t)command;
+    cmd.hold.steps = steps;
+    cmd.hold.period_ms = period_ms;
+
+    // Cleared before queuing so a stop that arrives before the radio task picks the hold up still ends it
+    hold_stop = false;
+    nrf24_job_t* job = NULL;
+    esp_err_t err = nrf24_submit(&cmd, &job);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    hold_session.id = hold_next_id++;
+    hold_session.job = job;
+    hold_session.queued = (nrf24_hold_status_t){
+        .id = hold_session.id,
+        .command = (uint8_t)command,
+        .steps = steps,
+        .period_ms = period_ms,
+    };
+    *hold_id = hold_session.id;
+    return ESP_OK;
+}
+
+/// @brief Releases the running hold, the radio task ends it on its next wake up
+/// @return ESP_OK if a hold was running, ESP_ERR_INVALID_STATE otherwise
+esp_err_t nrf24_hold_stop(void) {
+    if (hold_session.job == NULL || nrf24_job_poll(hold_session.job, NULL)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    hold_stop = true;
+    xTaskNotify(radio_task, NRF24_NOTIFY_CMD, eSetBits);
+    return ESP_OK;
+}
+
+/// @brief Reads the progress and timing of the latest hold
+/// @param hold_id Id returned by nrf24_hold_start
+/// @param out Pointer to store the progress
+/// @return ESP_OK on success, ESP_ERR_NOT_FOUND if hold_id is not the latest hold
+esp_err_t nrf24_hold_get_status(uint32_t hold_id, nrf24_hold_status_t* out) {
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (hold_id == 0 || hold_id != hold_session.id) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t result = ESP_ERR_NOT_FINISHED;
+    bool done = nrf24_job_poll(hold_session.job, &result);
+
+    portENTER_CRITICAL(&hold_lock);
+    *out = (hold_progress.id == hold_id) ? hold_progress : hold_session.queued;
+    portEXIT_CRITICAL(&hold_lock);
+
+    out->done = done;
+    out->result = result;
+    return ESP_OK;
+}
@@ -3,20 +3,231 @@
 #include <esp_err.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+
+#include "xiaomi_codec.h"
+
+/// Maximum number of commands sent in one radio session
+#define NRF24_XIAOMI_BURST_MAX 8
+/// Maximum number of remotes addressed by one burst
+#define NRF24_XIAOMI_GROUP_MAX 16
+
+#define XIAOMI_SCAN_TOP_PATTERNS 3
+#define XIAOMI_SCAN_TOP_REMOTES 4
+
+/// Longest channel list a scan hops over, the default list holds the 4 Xiaomi channels
+#define NRF24_SCAN_CHANNELS_MAX 16
+/// Default confidence rule: a scan ends once one remote was heard on 3 presses and on at least 2 channels
+#define NRF24_SCAN_CONFIRM_FRAMES_DEFAULT 3
+#define NRF24_SCAN_CONFIRM_CHANNELS_DEFAULT 2
+
+/// Confidence rule ending a scan before its duration
+typedef struct {
+    uint8_t frames;    // Presses (distinct sequence numbers) of one remote needed, 0 to listen for the whole duration
+    uint8_t channels;  // Distinct channels its frames must come from, 0 for every channel of the scan
+} nrf24_scan_rule_t;
+
+/// How a scan shares its listening time between channels
+typedef enum {
+    NRF24_SCAN_ROUND_ROBIN = 0,  // Same dwell on every channel in turn
+    NRF24_SCAN_ADAPTIVE,         // Dwell shifted toward the channels that decode frames, above an exploration floor
+} nrf24_scan_strategy_t;
+
+/// Options of a scan, nrf24_scan_options_default fills the defaults
+typedef struct {
+    nrf24_scan_rule_t rule;
+    uint8_t strategy;                           // nrf24_scan_strategy_t
+    uint8_t channel_count;                      // 1..NRF24_SCAN_CHANNELS_MAX
+    uint8_t channels[NRF24_SCAN_CHANNELS_MAX];  // RF channels to hop over, no duplicates
+} nrf24_scan_options_t;
+
+/// Listening share of one scan channel
+typedef struct {
+    uint8_t channel;
+    uint32_t dwell_ms;  // Listening time given to the channel
+    uint32_t frames;    // Frames decoded on it
+} nrf24_scan_channel_t;
+
+/// One ranked (remote, command) pair, or one ranked remote with cmd and param left at 0
+typedef struct {
+    uint32_t remote_id;
+    uint8_t cmd;
+    uint8_t param;
+    uint32_t hits;  // Decoded frames, may overestimate by the count the entry inherited in the ranking table
+} xiaomi_scan_hit_t;
 
 /// Result from Xiaomi scan
 typedef struct {
     uint32_t found_count;
-    uint8_t pattern_0[8];  // Most common pattern
+    uint8_t pattern_0[8];  // Most common pattern: id (3 bytes, MSB first), cmd, param, zero padding
     uint8_t pattern_1[8];  // Second pattern
     uint8_t pattern_2[8];  // Third pattern
     uint32_t last_scan_time;
-    uint32_t remote_id;     // Decoded 3-byte Xiaomi remote ID
+    uint32_t remote_id;     // Decoded 3-byte Xiaomi remote ID, the confirmed one or else the one heard most often
     uint8_t id_found;       // 1 if remote_id is valid, 0 otherwise
     uint8_t commands_mask;  // Bitmask of seen commands: bit0 on/off, 1 cooler, 2 warmer, 3 higher, 4 lower, 5 reset
+    uint32_t max_decode_latency_us;  // Worst IRQ-to-decode delay seen during the scan
+    uint8_t confirmed;               // 1 if a remote met the confidence rule, which ended the scan
+    uint32_t identify_ms;            // Listening time until the rule was met, 0 unless confirmed
+    uint32_t listened_ms;            // Listening time so far, suspensions for interactive commands excluded
+    uint32_t payload_count;          // Payloads read from the RX FIFO, decoded or not
+    uint8_t strategy;                // nrf24_scan_strategy_t
+    uint8_t channel_count;
+    nrf24_scan_channel_t channels[NRF24_SCAN_CHANNELS_MAX];  // Share of each channel, in the order of the list
+    uint8_t pattern_count;
+    uint8_t remote_count;
+    uint8_t id_saved;  // 1 once a scan started with nrf24_scan_start stored remote_id as the remote to address
+    xiaomi_scan_hit_t patterns[XIAOMI_SCAN_TOP_PATTERNS];  // Most frequent (remote, command) pairs first
+    xiaomi_scan_hit_t remotes[XIAOMI_SCAN_TOP_REMOTES];    // Most frequent remotes first
 } xiaomi_scan_result_t;
 
+/// Completion handle for a command queued to the radio task
+typedef struct nrf24_job nrf24_job_t;
+
+/// RX pipes of the nRF24L01+
+#define NRF24_RX_PIPES 6
+
+/// Radio driver counters
+typedef struct {
+    uint32_t spi_transactions;  // SPI transactions issued to the radio
+    uint32_t spi_saved;         // Register writes skipped because the shadow register already held the value
+    uint32_t spi_clock_hz;      // SPI clock currently in use
+    uint32_t spi_clock_fallbacks;               // Times the clock was stepped down after failed readbacks
+    uint32_t tx_frames;                         // Frames put on air, one per remote per completed channel hop
+    uint32_t tx_last_burst_us;                  // Air time of the last command, all passes and channel hops
+    uint32_t tx_wait_last_us;                   // Time the last burst or hold spent queued before reaching the radio
+    uint32_t tx_wait_max_us;                    // Worst such wait since boot
+    uint32_t scan_preemptions;                  // Times a scan was suspended for an interactive transmission
+    uint32_t rx_pipe_payloads[NRF24_RX_PIPES];  // Payloads read from the RX FIFO, per pipe
+    uint32_t rx_pipe_decoded[NRF24_RX_PIPES];   // Of those, payloads holding a valid Xiaomi frame
+} nrf24_stats_t;
+
+/// Verdict of the last radio health check
+typedef enum {
+    NRF24_HEALTH_UNKNOWN = 0,  // Not checked yet
+    NRF24_HEALTH_OK,           // The radio answered and its registers match the driver view
+    NRF24_HEALTH_NO_RESPONSE,  // MISO reads all zeros or all ones
+    NRF24_HEALTH_MISMATCH,     // The radio answers but lost its configuration or fails write/readback
+    NRF24_HEALTH_SPI_ERROR,    // The SPI driver reported an error
+} nrf24_health_verdict_t;
+
+/// Radio health as last measured by the radio task, read without touching the bus
+typedef struct {
+    bool connected;          // The last check succeeded
+    uint8_t verdict;         // nrf24_health_verdict_t of the last check
+    uint8_t config;          // CONFIG as read by the last check
+    uint32_t last_check_ms;  // Uptime of the last check, 0 before the first one
+    uint32_t checks;         // Checks run since boot, periodic probes and explicit connection checks
+    uint32_t failures;       // Checks that did not end with NRF24_HEALTH_OK
+    uint32_t spi_errors;     // SPI transfers that returned an error since boot
+} nrf24_health_t;
+
+/// Number of RF channels of the nRF24L01+ (2400..2525 MHz)
+#define NRF24_CHANNEL_COUNT 126
+
+/// Progress of an asynchronous scan started with nrf24_scan_start
+typedef struct {
+    uint32_t id;
+    bool done;
+    esp_err_t result;      // ESP_ERR_NOT_FINISHED while running
+    uint32_t duration_ms;  // Requested duration
+    uint32_t elapsed_ms;   // Time since the scan was queued, once done the time to identify or duration_ms
+    xiaomi_scan_result_t scan;  // Live ranking while running, final result once done
+} nrf24_scan_status_t;
+
+/// Cadence bounds of a held command, a step on 16 remotes takes ~15 ms of air time
+#define NRF24_HOLD_PERIOD_MIN_MS 20
+#define NRF24_HOLD_PERIOD_MAX_MS 1000
+#define NRF24_HOLD_PERIOD_DEFAULT_MS 60
+
+/// Progress and timing of a held command started with nrf24_hold_start
+typedef struct {
+    uint32_t id;
+    bool done;
+    esp_err_t result;        // ESP_ERR_NOT_FINISHED while running
+    uint8_t command;         // xiaomi_command_t
+    uint16_t steps;          // Requested steps, 0 until stopped
+    uint32_t period_ms;      // Requested cadence
+    uint16_t steps_sent;     // Steps put on air so far
+    uint32_t missed_ticks;   // Timer ticks skipped because the previous step was still on air
+    uint32_t late_max_us;    // Worst delay between a timer deadline and its step
+    uint32_t jitter_avg_us;  // Mean deviation of the interval between consecutive steps from the period
+    uint32_t jitter_max_us;  // Worst deviation of that interval
+    uint32_t step_us;        // Air time of the last step
+} nrf24_hold_status_t;
+
+/// Rolling channel occupancy measured with the RPD register
+typedef struct {
+    bool enabled;
+    uint32_t sweeps;                         // Completed sweeps over all channels
+    uint8_t occupancy[NRF24_CHANNEL_COUNT];  // Percent of samples above -64 dBm, per channel
+} nrf24_survey_t;
+
+/// Idle time after which the radio is powered down by default, 0 keeps it powered
+#define NRF24_POWER_IDLE_DEFAULT_MS 2000
+#define NRF24_POWER_IDLE_MAX_MS 3600000
+
+/// Operating state of the chip, from CONFIG.PWR_UP, CONFIG.PRIM_RX and CE
+typedef enum {
+    NRF24_POWER_DOWN = 0,
+    NRF24_POWER_STANDBY,
+    NRF24_POWER_TX,
+    NRF24_POWER_RX,
+    NRF24_POWER_STATE_COUNT,
+} nrf24_power_state_t;
+
+/// Power manager state and the time spent in each chip state since boot
+typedef struct {
+    uint8_t state;                              // nrf24_power_state_t
+    uint32_t idle_ms;                           // Idle time before power down, 0 when disabled
+    uint64_t time_us[NRF24_POWER_STATE_COUNT];  // Indexed by nrf24_power_state_t
+    uint32_t wakeups;                           // Power ups out of power down
+    uint32_t last_wake_us;                      // Startup wait paid by the command that last woke the chip
+    uint64_t wake_total_us;                     // Sum of those waits
+} nrf24_power_stats_t;
+
+/// Cost of one register write through each SPI path
+typedef struct {
+    uint32_t iterations;
+    uint32_t transmit_ns;  // spi_device_transmit with per-call bus arbitration (previous path)
+    uint32_t polling_ns;   // Polling transaction with the bus held by the radio task
+    uint32_t batch_ns;     // Queued batch of register writes
+} nrf24_spi_bench_t;
+
+esp_err_t nrf24_init(void);
+esp_err_t nrf24_submit_check(nrf24_job_t** job);
+esp_err_t nrf24_submit_xiaomi_power(uint32_t remote_id, nrf24_job_t** job);
+esp_err_t nrf24_submit_xiaomi_burst(const uint32_t* remote_ids, size_t remote_count, const xiaomi_action_t* actions,
+                                    size_t count, nrf24_job_t** job);
+void nrf24_scan_options_default(nrf24_scan_options_t* out);
+const char* nrf24_scan_strategy_name(uint8_t strategy);
+esp_err_t nrf24_submit_scan(uint32_t duration_ms, const nrf24_scan_options_t* options, nrf24_job_t** job);
+esp_err_t nrf24_job_wait(nrf24_job_t* job, uint32_t timeout_ms);
+bool nrf24_job_poll(const nrf24_job_t* job, esp_err_t* result);
+void nrf24_job_release(nrf24_job_t* job);
 esp_err_t nrf24_check_connection(void);
-esp_err_t nrf24_scan_xiaomi(uint32_t duration_ms);
+void nrf24_get_health(nrf24_health_t* out);
+const char* nrf24_health_verdict_name(uint8_t verdict);
+esp_err_t nrf24_scan_xiaomi(uint32_t duration_ms, const nrf24_scan_options_t* options);
 const xiaomi_scan_result_t* nrf24_get_last_scan_result(void);
+esp_err_t nrf24_scan_start(uint32_t duration_ms, const nrf24_scan_options_t* options, uint32_t* scan_id);
+esp_err_t nrf24_scan_get_status(uint32_t scan_id, nrf24_scan_status_t* out);
 esp_err_t nrf24_send_xiaomi_power(uint32_t remote_id);
+esp_err_t nrf24_send_xiaomi_burst(const uint32_t* remote_ids, size_t remote_count, const xiaomi_action_t* actions,
+                                  size_t count);
+void nrf24_get_stats(nrf24_stats_t* out);
+esp_err_t nrf24_benchmark_spi(nrf24_spi_bench_t* out);
+esp_err_t nrf24_calibrate_spi(void);
+esp_err_t nrf24_survey_enable(bool enable);
+esp_err_t nrf24_sniffer_enable(bool enable);
+bool nrf24_sniffer_active(void);
+esp_err_t nrf24_capture_multipipe(bool enable);
+bool nrf24_capture_multipipe_enabled(void);
+void nrf24_get_survey(nrf24_survey_t* out);
+esp_err_t nrf24_power_set_idle(uint32_t idle_ms);
+void nrf24_get_power(nrf24_power_stats_t* out);
+const char* nrf24_power_state_name(uint8_t state);
+esp_err_t nrf24_hold_start(const uint32_t* remote_ids, size_t remote_count, xiaomi_command_t command, uint16_t steps,
+                           uint32_t period_ms, uint32_t* hold_id);
+esp_err_t nrf24_hold_stop(void);
+esp_err_t nrf24_hold_get_status(uint32_t hold_id, nrf24_hold_status_t* out);
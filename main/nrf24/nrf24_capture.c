@@ -0,0 +1,115 @@
+#include "nrf24_capture.h"
+
+#include <string.h>
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+// pcap global header, microsecond timestamps, little endian like the records
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t network;
+} nrf24_pcap_header_t;
+
+#define NRF24_CAPTURE_DATA_LEN (3 + NRF24_CAPTURE_PAYLOAD_LEN)
+
+// Written by the radio task only. An export freezes the ring instead of copying it, records arriving meanwhile are
+// counted as dropped, so the writer cost stays one 51-byte copy under a short spinlock
+static nrf24_capture_record_t ring[NRF24_CAPTURE_CAPACITY];
+static uint32_t ring_head = 0;
+static uint32_t ring_dropped = 0;
+static bool ring_frozen = false;
+static portMUX_TYPE ring_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/// @brief Stores one raw RX payload with its channel, pipe and decode verdict
+/// @param channel RF channel the payload was received on
+/// @param pipe RX pipe the payload matched
+/// @param verdict nrf24_capture_verdict_t
+/// @param payload NRF24_CAPTURE_PAYLOAD_LEN bytes as read from the RX FIFO
+void nrf24_capture_record(uint8_t channel, uint8_t pipe, uint8_t verdict, const uint8_t* payload) {
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&ring_lock);
+    if (ring_frozen) {
+        ring_dropped++;
+        portEXIT_CRITICAL(&ring_lock);
+        return;
+    }
+
+    nrf24_capture_record_t* rec = &ring[ring_head % NRF24_CAPTURE_CAPACITY];
+    rec->ts_sec = (uint32_t)(now_us / 1000000);
+    rec->ts_usec = (uint32_t)(now_us % 1000000);
+    rec->incl_len = NRF24_CAPTURE_DATA_LEN;
+    rec->orig_len = NRF24_CAPTURE_DATA_LEN;
+    rec->channel = channel;
+    rec->verdict = verdict;
+    rec->pipe = pipe;
+    memcpy(rec->payload, payload, NRF24_CAPTURE_PAYLOAD_LEN);
+    ring_head++;
+    portEXIT_CRITICAL(&ring_lock);
+}
+
+/// @brief Streams the ring as a pcap file, oldest record first
+/// The ring is frozen for the duration so records are sent straight from it without tearing
+/// @param sink Callback receiving the header then at most two contiguous runs of records
+/// @param ctx Passed to sink
+/// @return ESP_OK on success, ESP_ERR_INVALID_STATE if another export is running, sink error otherwise
+esp_err_t nrf24_capture_export(nrf24_capture_sink_t sink, void* ctx) {
+    if (sink == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&ring_lock);
+    bool busy = ring_frozen;
+    ring_frozen = true;
+    uint32_t head = ring_head;
+    portEXIT_CRITICAL(&ring_lock);
+
+    if (busy) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const nrf24_pcap_header_t header = {
+        .magic = 0xA1B2C3D4,
+        .version_major = 2,
+        .version_minor = 4,
+        .snaplen = NRF24_CAPTURE_DATA_LEN,
+        .network = NRF24_CAPTURE_LINKTYPE,
+    };
+
+    uint32_t count = (head < NRF24_CAPTURE_CAPACITY) ? head : NRF24_CAPTURE_CAPACITY;
+    uint32_t start = (head - count) % NRF24_CAPTURE_CAPACITY;
+    uint32_t first = (start + count > NRF24_CAPTURE_CAPACITY) ? NRF24_CAPTURE_CAPACITY - start : count;
+
+    esp_err_t err = sink(ctx, &header, sizeof(header));
+    if (err == ESP_OK && first > 0) {
+        err = sink(ctx, &ring[start], first * sizeof(ring[0]));
+    }
+    if (err == ESP_OK && count > first) {
+        err = sink(ctx, &ring[0], (count - first) * sizeof(ring[0]));
+    }
+
+    portENTER_CRITICAL(&ring_lock);
+    ring_frozen = false;
+    portEXIT_CRITICAL(&ring_lock);
+
+    return err;
+}
+
+/// @brief Returns the capture counters
+/// @param out Pointer to store the counters
+void nrf24_capture_get_stats(nrf24_capture_stats_t* out) {
+    if (out == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&ring_lock);
+    out->captured = ring_head;
+    out->dropped = ring_dropped;
+    portEXIT_CRITICAL(&ring_lock);
+}
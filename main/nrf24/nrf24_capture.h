@@ -0,0 +1,41 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define NRF24_CAPTURE_CAPACITY 128
+#define NRF24_CAPTURE_PAYLOAD_LEN 32
+/// pcap link type for private use, records carry [channel, verdict, pipe, payload...]
+#define NRF24_CAPTURE_LINKTYPE 147
+
+typedef enum {
+    NRF24_CAPTURE_UNDECODED = 0,
+    NRF24_CAPTURE_XIAOMI,         // Decoded, first copy of a press
+    NRF24_CAPTURE_XIAOMI_REPEAT,  // Decoded, repeat of a recent press
+} nrf24_capture_verdict_t;
+
+/// One captured payload, laid out as a pcap record so the ring can be streamed as is
+typedef struct __attribute__((packed)) {
+    uint32_t ts_sec;
+    uint32_t ts_usec;
+    uint32_t incl_len;
+    uint32_t orig_len;
+    uint8_t channel;
+    uint8_t verdict;  // nrf24_capture_verdict_t
+    uint8_t pipe;     // RX pipe the payload matched, RX_P_NO of STATUS
+    uint8_t payload[NRF24_CAPTURE_PAYLOAD_LEN];
+} nrf24_capture_record_t;
+
+/// Receives successive pieces of the pcap stream
+typedef esp_err_t (*nrf24_capture_sink_t)(void* ctx, const void* data, size_t len);
+
+typedef struct {
+    uint32_t captured;  // Records written since boot
+    uint32_t dropped;   // Records lost because an export held the ring
+} nrf24_capture_stats_t;
+
+void nrf24_capture_record(uint8_t channel, uint8_t pipe, uint8_t verdict, const uint8_t* payload);
+esp_err_t nrf24_capture_export(nrf24_capture_sink_t sink, void* ctx);
+void nrf24_capture_get_stats(nrf24_capture_stats_t* out);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Radio backend under the nrf24 driver
+/// Every register, FIFO and CE access of nrf24.c goes through these hooks once a backend is installed, the
+/// built-in ESP-IDF SPI/GPIO path is used otherwise
+typedef struct {
+    const char* name;
+    /// @brief One chip select framed exchange, rx may be NULL
+    esp_err_t (*transfer)(void* ctx, const uint8_t* tx, uint8_t* rx, size_t len);
+    /// @brief Drives the CE line
+    void (*set_ce)(void* ctx, bool high);
+    void* ctx;
+} nrf24_hal_t;
+
+esp_err_t nrf24_set_hal(const nrf24_hal_t* hal);
+void nrf24_hal_irq(void);
@@ -0,0 +1,57 @@
+#include "nrf24_trace.h"
+
+nrf24_trace_record_t nrf24_trace_ring[NRF24_TRACE_CAPACITY];
+uint32_t nrf24_trace_head = 0;
+bool nrf24_trace_paused = false;
+
+// Guards the ring, the head and the pause flag: a record is written entirely before or after an export pauses
+portMUX_TYPE nrf24_trace_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/// @brief Streams the trace ring, oldest event first
+/// Recording is paused for the duration so records are sent straight from the ring, events meanwhile are lost.
+/// Pausing and reading the head happen in one critical section, no record can be half written past it
+/// @param sink Callback receiving the header then at most two contiguous runs of records
+/// @param ctx Passed to sink
+/// @return ESP_OK on success, ESP_ERR_INVALID_STATE if another export is running, sink error otherwise
+esp_err_t nrf24_trace_export(nrf24_trace_sink_t sink, void* ctx) {
+    if (sink == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&nrf24_trace_lock);
+    bool busy = nrf24_trace_paused;
+    nrf24_trace_paused = true;
+    uint32_t head = nrf24_trace_head;
+    int64_t now_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&nrf24_trace_lock);
+
+    if (busy) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t count = (head < NRF24_TRACE_CAPACITY) ? head : NRF24_TRACE_CAPACITY;
+    uint32_t start = (head - count) & (NRF24_TRACE_CAPACITY - 1);
+    uint32_t first = (start + count > NRF24_TRACE_CAPACITY) ? NRF24_TRACE_CAPACITY - start : count;
+
+    const nrf24_trace_header_t header = {
+        .magic = NRF24_TRACE_MAGIC,
+        .version = NRF24_TRACE_VERSION,
+        .record_size = sizeof(nrf24_trace_record_t),
+        .timer_now_us = (uint64_t)now_us,
+        .total = head,
+        .count = count,
+    };
+
+    esp_err_t err = sink(ctx, &header, sizeof(header));
+    if (err == ESP_OK && first > 0) {
+        err = sink(ctx, &nrf24_trace_ring[start], first * sizeof(nrf24_trace_ring[0]));
+    }
+    if (err == ESP_OK && count > first) {
+        err = sink(ctx, &nrf24_trace_ring[0], (count - first) * sizeof(nrf24_trace_ring[0]));
+    }
+
+    portENTER_CRITICAL(&nrf24_trace_lock);
+    nrf24_trace_paused = false;
+    portEXIT_CRITICAL(&nrf24_trace_lock);
+    return err;
+}
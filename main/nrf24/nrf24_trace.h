@@ -0,0 +1,72 @@
+#pragma once
+
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Power of two so the ring index is a mask
+#define NRF24_TRACE_CAPACITY 512
+#define NRF24_TRACE_MAGIC 0x4352544E  // "NTRC"
+#define NRF24_TRACE_VERSION 1
+
+typedef enum {
+    NRF24_TRACE_PROFILE = 1,   // arg8: registers written, arg16: registers in the profile
+    NRF24_TRACE_CE_HIGH,       // arg8: RF channel
+    NRF24_TRACE_CE_LOW,        // arg8: RF channel
+    NRF24_TRACE_TX_DS,         // arg8: RF channel, arg16: frames sent on the hop
+    NRF24_TRACE_TX_FAIL,       // arg8: RF channel, arg16: frames queued when the hop timed out
+    NRF24_TRACE_RX_DR,         // arg8: RF channel
+    NRF24_TRACE_DECODE_OK,     // arg8: RF channel, arg16: low 16 bits of the remote id
+    NRF24_TRACE_DECODE_FAIL,   // arg8: RF channel
+} nrf24_trace_event_t;
+
+/// One radio event, 8 bytes
+typedef struct {
+    uint32_t time_us;  // Low 32 bits of esp_timer_get_time(), the same clock on both cores
+    uint8_t event;     // nrf24_trace_event_t
+    uint8_t arg8;
+    uint16_t arg16;
+} nrf24_trace_record_t;
+
+/// Header of the dump, followed by count records oldest first
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint64_t timer_now_us;  // esp_timer_get_time() when the dump started, gives the upper bits of the records
+    uint32_t total;         // Events recorded since boot
+    uint32_t count;         // Records that follow
+} nrf24_trace_header_t;
+
+typedef esp_err_t (*nrf24_trace_sink_t)(void* ctx, const void* data, size_t len);
+
+extern nrf24_trace_record_t nrf24_trace_ring[NRF24_TRACE_CAPACITY];
+extern uint32_t nrf24_trace_head;
+extern bool nrf24_trace_paused;
+extern portMUX_TYPE nrf24_trace_lock;
+
+/// @brief Records one radio event, radio task only
+/// A timer read and an 8-byte store under a spinlock, so it can sit inside the TX and RX loops. The lock orders the
+/// write against an export pausing the ring
+/// @param event nrf24_trace_event_t
+/// @param arg8 Event argument
+/// @param arg16 Event argument
+static inline void nrf24_trace(uint8_t event, uint8_t arg8, uint16_t arg16) {
+    uint32_t now = (uint32_t)esp_timer_get_time();
+
+    portENTER_CRITICAL(&nrf24_trace_lock);
+    if (!nrf24_trace_paused) {
+        nrf24_trace_record_t* rec = &nrf24_trace_ring[nrf24_trace_head & (NRF24_TRACE_CAPACITY - 1)];
+        rec->time_us = now;
+        rec->event = event;
+        rec->arg8 = arg8;
+        rec->arg16 = arg16;
+        nrf24_trace_head++;
+    }
+    portEXIT_CRITICAL(&nrf24_trace_lock);
+}
+
+esp_err_t nrf24_trace_export(nrf24_trace_sink_t sink, void* ctx);
@@ -0,0 +1,350 @@
+#include "xiaomi_codec.h"
+
+#include <string.h>
+
+/// Frame layout (plaintext before whitening):
+/// [0-7]  preamble 53 39 14 DD 1C 49 34 12
+/// [8-10] remote id (MSB..LSB)
+/// [11]   0xFF
+/// [12]   sequence
+/// [13]   command
+/// [14]   parameter
+/// [15-16] CRC16-CCITT (init 0xFFFE) over bytes 0-14 (big-endian)
+/// [17]   padding (0x00)
+#define XIAOMI_PREAMBLE_LEN 8
+#define XIAOMI_STATIC_LEN 12
+#define XIAOMI_CRC_LEN 15
+#define XIAOMI_CHECK_LEN 17
+
+#define XIAOMI_CRC_INIT 0xFFFE
+/// CRC state once the constant preamble has been fed, saves 8 table steps per frame
+#define XIAOMI_PREAMBLE_CRC 0xDE39
+
+/// Preamble as it appears in a 64-bit big-endian bit window
+#define XIAOMI_PREAMBLE_WORD 0x533914DD1C493412ULL
+
+static const uint8_t xiaomi_preamble[XIAOMI_PREAMBLE_LEN] = {0x53, 0x39, 0x14, 0xDD, 0x1C, 0x49, 0x34, 0x12};
+
+// Bytes 0-11: fixed mask; Byte 12: 0x90; Byte 13: 0x00; Byte 14: 0xBC; Bytes 15-17: 0x00
+static const uint8_t xiaomi_whitening[XIAOMI_FRAME_LEN] = {0xFA, 0xA5, 0x9E, 0xB3, 0x92, 0x6D, 0xAE, 0x1B, 0x48,
+                                                          0x1D, 0x2E, 0x80, 0x90, 0x00, 0xBC, 0x00, 0x00, 0x00};
+
+// CRC-16-CCITT (poly 0x1021, MSB first) lookup table
+static const uint16_t xiaomi_crc_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+/// @brief Feeds bytes into a running CRC-16-CCITT state
+/// @param crc Current CRC state
+/// @param data Pointer to the data buffer
+/// @param len Length of the data buffer in bytes
+/// @return Updated CRC state
+static inline uint16_t xiaomi_crc16_update(uint16_t crc, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint16_t)(crc << 8) ^ xiaomi_crc_table[(crc >> 8) ^ data[i]];
+    }
+
+    return crc;
+}
+
+/// @brief Computes the Xiaomi CRC-16-CCITT checksum (init 0xFFFE) for given data
+/// @param data Pointer to the data buffer
+/// @param len Length of the data buffer in bytes
+/// @return Computed CRC-16 checksum
+uint16_t xiaomi_crc16(const uint8_t* data, size_t len) { return xiaomi_crc16_update(XIAOMI_CRC_INIT, data, len); }
+
+/// @brief Prepares the whitened static part of the frames of one remote
+/// @param tpl Template to fill
+/// @param remote_id 24-bit remote id (e.g., 0x701634)
+/// @return true on success, false if the id does not fit in 24 bits
+bool xiaomi_template_init(xiaomi_template_t* tpl, uint32_t remote_id) {
+    if (tpl == NULL || remote_id > 0xFFFFFF) {
+        return false;
+    }
+
+    uint8_t plain[XIAOMI_STATIC_LEN];
+    memcpy(plain, xiaomi_preamble, XIAOMI_PREAMBLE_LEN);
+    plain[8] = (remote_id >> 16) & 0xFF;
+    plain[9] = (remote_id >> 8) & 0xFF;
+    plain[10] = remote_id & 0xFF;
+    plain[11] = 0xFF;
+
+    tpl->remote_id = remote_id;
+    tpl->crc = xiaomi_crc16_update(XIAOMI_PREAMBLE_CRC, &plain[XIAOMI_PREAMBLE_LEN],
+                                   XIAOMI_STATIC_LEN - XIAOMI_PREAMBLE_LEN);
+
+    memset(tpl->frame, 0, sizeof(tpl->frame));
+    for (size_t i = 0; i < XIAOMI_STATIC_LEN; i++) {
+        tpl->frame[i] = plain[i] ^ xiaomi_whitening[i];
+    }
+    tpl->frame[17] = 0x00 ^ xiaomi_whitening[17];
+
+    return true;
+}
+
+/// @brief Builds a whitened 18-byte frame from a remote template
+/// Only sequence, command, parameter and CRC are computed, the rest is copied from the template
+/// @param tpl Template prepared by xiaomi_template_init
+/// @param seq Sequence value
+/// @param cmd Command byte
+/// @param param Parameter/brightness byte
+/// @param out Buffer to store the 18-byte whitened frame
+void xiaomi_template_build(const xiaomi_template_t* tpl, uint8_t seq, uint8_t cmd, uint8_t param, uint8_t* out) {
+    const uint8_t dynamic[3] = {seq, cmd, param};
+    uint16_t crc = xiaomi_crc16_update(tpl->crc, dynamic, sizeof(dynamic));
+
+    memcpy(out, tpl->frame, XIAOMI_FRAME_LEN);
+    out[12] = seq ^ xiaomi_whitening[12];
+    out[13] = cmd ^ xiaomi_whitening[13];
+    out[14] = param ^ xiaomi_whitening[14];
+    out[15] = (uint8_t)(crc >> 8) ^ xiaomi_whitening[15];
+    out[16] = (uint8_t)crc ^ xiaomi_whitening[16];
+}
+
+/// @brief Builds a whitened 18-byte frame without a cached template
+/// @param remote_id 24-bit remote id
+/// @param seq Sequence value
+/// @param cmd Command byte
+/// @param param Parameter/brightness byte
+/// @param out Buffer to store the 18-byte whitened frame
+/// @return true on success, false on invalid arguments
+bool xiaomi_build_frame(uint32_t remote_id, uint8_t seq, uint8_t cmd, uint8_t param, uint8_t* out) {
+    xiaomi_template_t tpl;
+    if (out == NULL || !xiaomi_template_init(&tpl, remote_id)) {
+        return false;
+    }
+
+    xiaomi_template_build(&tpl, seq, cmd, param, out);
+    return true;
+}
+
+/// @brief Copies a frame starting at an arbitrary bit offset into a byte-aligned buffer
+/// Bits past the end of the raw buffer read as zero
+/// @param raw Pointer to the raw data buffer
+/// @param len Length of the raw data buffer in bytes
+/// @param bit_off Bit offset of the first frame bit, MSB first
+/// @param out Buffer receiving XIAOMI_CHECK_LEN aligned bytes
+static void xiaomi_extract_frame(const uint8_t* raw, size_t len, size_t bit_off, uint8_t* out) {
+    size_t byte_off = bit_off >> 3;
+    unsigned shift = bit_off & 7;
+
+    for (size_t i = 0; i < XIAOMI_CHECK_LEN; i++) {
+        uint8_t a = (byte_off + i < len) ? raw[byte_off + i] : 0;
+        uint8_t b = (byte_off + i + 1 < len) ? raw[byte_off + i + 1] : 0;
+        out[i] = (shift == 0) ? a : (uint8_t)((a << shift) | (b >> (8 - shift)));
+    }
+}
+
+/// @brief Tells whether one of our own whitened frames starts at a bit offset
+/// The whitening mask of the preamble is the preamble shifted by one bit, so a whitened frame carries the plaintext
+/// preamble again one bit late and about a quarter of them pass the CRC there as a made-up remote. The converse holds
+/// as well, so only a reading carrying a command exactly as our encoder sends it counts. No remote frame with a known
+/// command is lost to this, about one in 10^4 frames with an unknown command is
+/// @param raw Pointer to the raw data buffer
+/// @param len Length of the raw data buffer in bytes
+/// @param bit_off Bit offset of the candidate whitened frame, MSB first
+/// @return true if a whitened frame with a valid CRC and an encodable command starts at bit_off
+static bool xiaomi_whitened_at(const uint8_t* raw, size_t len, size_t bit_off) {
+    uint8_t plain[XIAOMI_CHECK_LEN];
+    xiaomi_extract_frame(raw, len, bit_off, plain);
+    for (size_t i = 0; i < XIAOMI_CHECK_LEN; i++) {
+        plain[i] ^= xiaomi_whitening[i];
+    }
+    if (memcmp(plain, xiaomi_preamble, XIAOMI_PREAMBLE_LEN) != 0 || plain[11] != 0xFF) return false;
+
+    uint16_t crc_calc = xiaomi_crc16_update(XIAOMI_PREAMBLE_CRC, &plain[XIAOMI_PREAMBLE_LEN],
+                                            XIAOMI_CRC_LEN - XIAOMI_PREAMBLE_LEN);
+    if (crc_calc != (((uint16_t)plain[15] << 8) | plain[16])) return false;
+
+    xiaomi_action_t action;
+    uint8_t cmd = 0;
+    uint8_t param = 0;
+    return xiaomi_command_decode(plain[13], plain[14], &action) && xiaomi_command_encode(&action, &cmd, &param) &&
+           cmd == plain[13] && param == plain[14];
+}
+
+/// @brief Searches for and decodes a Xiaomi frame in raw received data
+/// The preamble is correlated with a sliding 64-bit window in a single pass over the payload bits,
+/// only windows matching the preamble are realigned and CRC checked
+/// @param raw Pointer to the raw data buffer
+/// @param len Length of the raw data buffer in bytes
+/// @param out Decoded frame (if found)
+/// @return true if a valid frame was found and decoded, false otherwise
+bool xiaomi_decode(const uint8_t* raw, size_t len, xiaomi_frame_t* out) {
+    if (!raw || !out || len < XIAOMI_CHECK_LEN) return false;
+
+    // A frame may start on any bit of the first (len - 17 + 1) bytes
+    const size_t max_bit_off = (len - XIAOMI_CHECK_LEN) * 8 + 7;
+    const size_t scan_len = (len - XIAOMI_CHECK_LEN) + 9;
+
+    uint64_t window = 0;
+    for (size_t i = 0; i < scan_len; i++) {
+        uint8_t byte = raw[i];
+        for (int b = 7; b >= 0; b--) {
+            window = (window << 1) | ((byte >> b) & 1);
+            if (window != XIAOMI_PREAMBLE_WORD) continue;
+
+            // Window ends on bit (i * 8 + 7 - b), the preamble started 63 bits earlier
+            size_t end_bit = i * 8 + (size_t)(7 - b);
+            if (end_bit < 63) continue;
+            size_t bit_off = end_bit - 63;
+            if (bit_off > max_bit_off) return false;
+
+            uint8_t aligned[XIAOMI_CHECK_LEN];
+            xiaomi_extract_frame(raw, len, bit_off, aligned);
+            if (aligned[11] != 0xFF) continue;
+
+            // The preamble matched, so its CRC state is known
+            uint16_t crc_calc = xiaomi_crc16_update(XIAOMI_PREAMBLE_CRC, &aligned[XIAOMI_PREAMBLE_LEN],
+                                                    XIAOMI_CRC_LEN - XIAOMI_PREAMBLE_LEN);
+            uint16_t crc_rx = ((uint16_t)aligned[15] << 8) | aligned[16];
+            if (crc_calc != crc_rx) continue;
+            // Our own transmission heard back one bit late, not a remote
+            if (bit_off > 0 && xiaomi_whitened_at(raw, len, bit_off - 1)) continue;
+
+            out->id = ((uint32_t)aligned[8] << 16) | ((uint32_t)aligned[9] << 8) | aligned[10];
+            out->seq = aligned[12];
+            out->cmd = aligned[13];
+            out->param = aligned[14];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/// Command byte and parameter sign of each remote command
+typedef struct {
+    const char* name;
+    uint8_t cmd;
+    uint8_t param;  // Fixed parameter, or 0 when the parameter carries the step
+    int8_t sign;    // +1 / -1 for stepped commands, 0 for fixed ones
+} xiaomi_command_def_t;
+
+// Only power toggle comes from captured remote traffic. The stepped commands and reset are UNVERIFIED: no capture of
+// those buttons was available, their opcodes (one per axis, direction in the sign of the parameter) are a guess and
+// must be replaced once real frames are recorded
+static const xiaomi_command_def_t xiaomi_commands[XIAOMI_CMD_COUNT] = {
+    [XIAOMI_CMD_POWER_TOGGLE] = {"power_toggle", 0x80, 0x3C, 0},
+    [XIAOMI_CMD_COOLER] = {"cooler", 0x02, 0x00, 1},
+    [XIAOMI_CMD_WARMER] = {"warmer", 0x02, 0x00, -1},
+    [XIAOMI_CMD_HIGHER] = {"higher", 0x03, 0x00, 1},
+    [XIAOMI_CMD_LOWER] = {"lower", 0x03, 0x00, -1},
+    [XIAOMI_CMD_RESET] = {"reset", 0x04, 0x00, 0},
+};
+
+/// @brief Encodes a remote command into the frame command and parameter bytes
+/// @param action Command and step to encode
+/// @param cmd Pointer to store the command byte
+/// @param param Pointer to store the parameter byte
+/// @return true on success, false on unknown command or out of range step
+bool xiaomi_command_encode(const xiaomi_action_t* action, uint8_t* cmd, uint8_t* param) {
+    if (action == NULL || cmd == NULL || param == NULL || action->command >= XIAOMI_CMD_COUNT) {
+        return false;
+    }
+
+    const xiaomi_command_def_t* def = &xiaomi_commands[action->command];
+    *cmd = def->cmd;
+    if (def->sign == 0) {
+        *param = def->param;
+        return true;
+    }
+
+    if (action->step == 0 || action->step > XIAOMI_STEP_MAX) {
+        return false;
+    }
+    *param = (def->sign > 0) ? action->step : (uint8_t)(0x100 - action->step);
+
+    return true;
+}
+
+/// @brief Maps decoded command and parameter bytes back to a remote command
+/// @param cmd Command byte
+/// @param param Parameter byte
+/// @return xiaomi_command_t value, or -1 if the command is unknown
+int xiaomi_command_classify(uint8_t cmd, uint8_t param) {
+    for (int i = 0; i < XIAOMI_CMD_COUNT; i++) {
+        const xiaomi_command_def_t* def = &xiaomi_commands[i];
+        if (def->cmd != cmd) continue;
+        if (def->sign == 0 || (def->sign > 0) == (param < 0x80)) return i;
+    }
+
+    return -1;
+}
+
+/// @brief Maps decoded command and parameter bytes back to a command and its step
+/// @param cmd Command byte
+/// @param param Parameter byte
+/// @param action Pointer to store the command and step
+/// @return true if the command is known
+bool xiaomi_command_decode(uint8_t cmd, uint8_t param, xiaomi_action_t* action) {
+    int command = xiaomi_command_classify(cmd, param);
+    if (command < 0 || action == NULL) {
+        return false;
+    }
+
+    action->command = (uint8_t)command;
+    action->step = 0;
+    if (xiaomi_commands[command].sign != 0) {
+        action->step = (param < 0x80) ? param : (uint8_t)(0x100 - param);
+    }
+
+    return true;
+}
+
+/// @brief Returns the API name of a remote command
+/// @param command Remote command
+/// @return Command name, or NULL if unknown
+const char* xiaomi_command_name(xiaomi_command_t command) {
+    return ((unsigned)command < XIAOMI_CMD_COUNT) ? xiaomi_commands[command].name : NULL;
+}
+
+/// @brief Looks up a remote command by its API name
+/// @param name Command name (e.g., "higher")
+/// @param out Pointer to store the command
+/// @return true if the name is known, false otherwise
+bool xiaomi_command_from_name(const char* name, xiaomi_command_t* out) {
+    if (name == NULL || out == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < XIAOMI_CMD_COUNT; i++) {
+        if (strcmp(name, xiaomi_commands[i].name) == 0) {
+            *out = (xiaomi_command_t)i;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Xiaomi lightbar frame codec, plain C with no ESP-IDF dependency so it also builds on the host
+
+#define XIAOMI_FRAME_LEN 18
+
+/// Fields carried by a Xiaomi lightbar frame
+typedef struct {
+    uint32_t id;    // 24-bit remote id
+    uint8_t seq;    // Rolling sequence number
+    uint8_t cmd;    // Command byte
+    uint8_t param;  // Command parameter
+} xiaomi_frame_t;
+
+/// Lightbar remote commands, the order matches the bits of xiaomi_scan_result_t.commands_mask
+typedef enum {
+    XIAOMI_CMD_POWER_TOGGLE = 0,
+    XIAOMI_CMD_COOLER,
+    XIAOMI_CMD_WARMER,
+    XIAOMI_CMD_HIGHER,
+    XIAOMI_CMD_LOWER,
+    XIAOMI_CMD_RESET,
+    XIAOMI_CMD_COUNT,
+} xiaomi_command_t;
+
+/// One command of a burst, step is the amount for color temperature and brightness commands
+typedef struct {
+    uint8_t command;  // xiaomi_command_t
+    uint8_t step;     // 1..XIAOMI_STEP_MAX, ignored by toggle and reset
+} xiaomi_action_t;
+
+#define XIAOMI_STEP_MAX 15
+
+/// Whitened frame bytes that only depend on the remote id, with the CRC state over them
+typedef struct {
+    uint32_t remote_id;
+    uint16_t crc;                      // CRC state after preamble, id and separator
+    uint8_t frame[XIAOMI_FRAME_LEN];  // Whitened preamble, id, separator and padding
+} xiaomi_template_t;
+
+uint16_t xiaomi_crc16(const uint8_t* data, size_t len);
+bool xiaomi_template_init(xiaomi_template_t* tpl, uint32_t remote_id);
+void xiaomi_template_build(const xiaomi_template_t* tpl, uint8_t seq, uint8_t cmd, uint8_t param, uint8_t* out);
+bool xiaomi_build_frame(uint32_t remote_id, uint8_t seq, uint8_t cmd, uint8_t param, uint8_t* out);
+bool xiaomi_decode(const uint8_t* raw, size_t len, xiaomi_frame_t* out);
+bool xiaomi_command_encode(const xiaomi_action_t* action, uint8_t* cmd, uint8_t* param);
+int xiaomi_command_classify(uint8_t cmd, uint8_t param);
+bool xiaomi_command_decode(uint8_t cmd, uint8_t param, xiaomi_action_t* action);
+const char* xiaomi_command_name(xiaomi_command_t command);
+bool xiaomi_command_from_name(const char* name, xiaomi_command_t* out);
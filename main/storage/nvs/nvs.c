@@ -164,3 +164,200 @@ bool nvs_load_xiaomi_id(char* id_out, size_t id_size) {
     nvs_close(handle);
     return err == ESP_OK;
 }
+
+/// @brief save the calibrated nrf24 spi clock
+/// @param clock_hz spi clock in Hz
+/// @return bool true if saved, false otherwise
+bool nvs_save_nrf24_spi_clock(uint32_t clock_hz) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("nrf24", NVS_READWRITE, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_set_u32(handle, "spi_clock_hz", clock_hz);
+    err |= nvs_commit(handle);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+/// @brief Load the calibrated nrf24 spi clock from NVS
+/// @param clock_hz_out Pointer where the clock in Hz will be stored
+/// @return bool true if a clock was stored, false otherwise
+bool nvs_load_nrf24_spi_clock(uint32_t* clock_hz_out) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("nrf24", NVS_READONLY, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_get_u32(handle, "spi_clock_hz", clock_hz_out);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+/// @brief save whether the nrf24 background channel survey is enabled
+/// @param enabled survey mode
+/// @return bool true if saved, false otherwise
+bool nvs_save_nrf24_survey(bool enabled) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("nrf24", NVS_READWRITE, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_set_u8(handle, "survey", enabled ? 1 : 0);
+    err |= nvs_commit(handle);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+/// @brief Load the nrf24 background channel survey mode from NVS
+/// @param enabled_out Pointer where the mode will be stored
+/// @return bool true if a mode was stored, false otherwise
+bool nvs_load_nrf24_survey(bool* enabled_out) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("nrf24", NVS_READONLY, &handle);
+    if (err != ESP_OK) return false;
+
+    uint8_t value = 0;
+    err |= nvs_get_u8(handle, "survey", &value);
+    nvs_close(handle);
+    *enabled_out = value != 0;
+    return err == ESP_OK;
+}
+
+/// @brief save whether the nrf24 captures on all six RX pipes
+/// @param enabled multi-pipe capture mode
+/// @return bool true if saved, false otherwise
+bool nvs_save_nrf24_multipipe(bool enabled) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("nrf24", NVS_READWRITE, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_set_u8(handle, "multipipe", enabled ? 1 : 0);
+    err |= nvs_commit(handle);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+/// @brief Load the nrf24 multi-pipe capture mode from NVS
+/// @param enabled_out Pointer where the mode will be stored
+/// @return bool true if a mode was stored, false otherwise
+bool nvs_load_nrf24_multipipe(bool* enabled_out) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("nrf24", NVS_READONLY, &handle);
+    if (err != ESP_OK) return false;
+
+    uint8_t value = 0;
+    err |= nvs_get_u8(handle, "multipipe", &value);
+    nvs_close(handle);
+    *enabled_out = value != 0;
+    return err == ESP_OK;
+}
+
+/// @brief save the nrf24 idle time before power down
+/// @param idle_ms idle time in ms, 0 keeps the radio powered
+/// @return bool true if saved, false otherwise
+bool nvs_save_nrf24_power_idle(uint32_t idle_ms) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("nrf24", NVS_READWRITE, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_set_u32(handle, "power_idle_ms", idle_ms);
+    err |= nvs_commit(handle);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+/// @brief Load the nrf24 idle time before power down from NVS
+/// @param idle_ms_out Pointer where the idle time in ms will be stored
+/// @return bool true if a value was stored, false otherwise
+bool nvs_load_nrf24_power_idle(uint32_t* idle_ms_out) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("nrf24", NVS_READONLY, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_get_u32(handle, "power_idle_ms", idle_ms_out);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+/// @brief save the xiaomi remote registry
+/// @param remotes registry entries
+/// @param size registry size in bytes
+/// @return bool true if saved, false otherwise
+bool nvs_save_xiaomi_remotes(const void* remotes, size_t size) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("xiaomi", NVS_READWRITE, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_set_blob(handle, "remotes", remotes, size);
+    err |= nvs_commit(handle);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+/// @brief Load the xiaomi remote registry from NVS
+/// @param remotes_out Pointer to the buffer where the registry will be stored
+/// @param size buffer size, updated with the registry size in bytes
+/// @return bool true if a registry was stored, false otherwise
+bool nvs_load_xiaomi_remotes(void* remotes_out, size_t* size) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("xiaomi", NVS_READONLY, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_get_blob(handle, "remotes", remotes_out, size);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+/// @brief save whether the nrf24 continuous sniffer is enabled
+/// @param enabled sniffer mode
+/// @return bool true if saved, false otherwise
+bool nvs_save_nrf24_sniffer(bool enabled) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("nrf24", NVS_READWRITE, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_set_u8(handle, "sniffer", enabled ? 1 : 0);
+    err |= nvs_commit(handle);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+/// @brief Load the nrf24 continuous sniffer mode from NVS
+/// @param enabled_out Pointer where the mode will be stored
+/// @return bool true if a mode was stored, false otherwise
+bool nvs_load_nrf24_sniffer(bool* enabled_out) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("nrf24", NVS_READONLY, &handle);
+    if (err != ESP_OK) return false;
+
+    uint8_t value = 0;
+    err |= nvs_get_u8(handle, "sniffer", &value);
+    nvs_close(handle);
+    *enabled_out = value != 0;
+    return err == ESP_OK;
+}
+
+/// @brief save the first Xiaomi sequence number the next boot may use
+/// @param seq sequence number
+/// @return bool true if saved, false otherwise
+bool nvs_save_xiaomi_seq(uint8_t seq) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("xiaomi", NVS_READWRITE, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_set_u8(handle, "tx_seq", seq);
+    err |= nvs_commit(handle);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+/// @brief Load the Xiaomi sequence number to resume from
+/// @param seq_out Pointer where the sequence number will be stored
+/// @return bool true if a sequence number was stored, false otherwise
+bool nvs_load_xiaomi_seq(uint8_t* seq_out) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("xiaomi", NVS_READONLY, &handle);
+    if (err != ESP_OK) return false;
+
+    err |= nvs_get_u8(handle, "tx_seq", seq_out);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
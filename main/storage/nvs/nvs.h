@@ -12,3 +12,17 @@ bool nvs_save_ntp_information(const char* ntp_domain);
 bool nvs_load_ntp_information(char* domain_out, size_t domain_size);
 bool nvs_save_xiaomi_id(const char* xiaomi_id);
 bool nvs_load_xiaomi_id(char* id_out, size_t id_size);
+bool nvs_save_nrf24_spi_clock(uint32_t clock_hz);
+bool nvs_load_nrf24_spi_clock(uint32_t* clock_hz_out);
+bool nvs_save_nrf24_survey(bool enabled);
+bool nvs_load_nrf24_survey(bool* enabled_out);
+bool nvs_save_nrf24_sniffer(bool enabled);
+bool nvs_load_nrf24_sniffer(bool* enabled_out);
+bool nvs_save_nrf24_multipipe(bool enabled);
+bool nvs_load_nrf24_multipipe(bool* enabled_out);
+bool nvs_save_nrf24_power_idle(uint32_t idle_ms);
+bool nvs_load_nrf24_power_idle(uint32_t* idle_ms_out);
+bool nvs_save_xiaomi_seq(uint8_t seq);
+bool nvs_load_xiaomi_seq(uint8_t* seq_out);
+bool nvs_save_xiaomi_remotes(const void* remotes, size_t size);
+bool nvs_load_xiaomi_remotes(void* remotes_out, size_t* size);
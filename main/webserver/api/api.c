@@ -55,11 +55,38 @@ void register_api_v1_endpoints(httpd_handle_t server) {
     static const api_handler_ctx_t ctx_ntp_sync = {.handler = ntp_set_handler, .require_auth = true};
     static const api_handler_ctx_t ctx_logs = {.handler = logs_handler, .require_auth = true};
     static const api_handler_ctx_t ctx_logs_clear = {.handler = logs_clear_handler, .require_auth = true};
-    static const api_handler_ctx_t ctx_nrf24_scan = {.handler = nrf24_scan_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_nrf24_scan_start = {.handler = nrf24_scan_start_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_nrf24_scan_status = {.handler = nrf24_scan_status_handler,
+                                                            .require_auth = true};
+    static const api_handler_ctx_t ctx_nrf24_stats = {.handler = nrf24_stats_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_nrf24_benchmark = {.handler = nrf24_benchmark_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_nrf24_survey = {.handler = nrf24_survey_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_nrf24_survey_set = {.handler = nrf24_survey_set_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_nrf24_power = {.handler = nrf24_power_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_nrf24_power_set = {.handler = nrf24_power_set_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_nrf24_capture = {.handler = nrf24_capture_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_nrf24_trace = {.handler = nrf24_trace_handler, .require_auth = true};
     static const api_handler_ctx_t ctx_xiaomi_set_id = {.handler = xiaomi_set_id_handler, .require_auth = true};
     static const api_handler_ctx_t ctx_xiaomi_get_id = {.handler = xiaomi_get_id_handler, .require_auth = true};
     static const api_handler_ctx_t ctx_xiaomi_power_toggle = {.handler = xiaomi_power_toggle_handler,
                                                               .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_command = {.handler = xiaomi_command_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_on = {.handler = xiaomi_on_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_off = {.handler = xiaomi_off_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_set = {.handler = xiaomi_set_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_hold_start = {.handler = xiaomi_hold_start_handler,
+                                                            .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_hold_stop = {.handler = xiaomi_hold_stop_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_hold_status = {.handler = xiaomi_hold_status_handler,
+                                                             .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_remotes_list = {.handler = xiaomi_remotes_list_handler,
+                                                              .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_remotes_set = {.handler = xiaomi_remotes_set_handler,
+                                                             .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_remotes_delete = {.handler = xiaomi_remotes_delete_handler,
+                                                                .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_events = {.handler = xiaomi_events_handler, .require_auth = true};
+    static const api_handler_ctx_t ctx_xiaomi_sniffer = {.handler = xiaomi_sniffer_handler, .require_auth = true};
 
     httpd_uri_t status_uri = {
         .uri = "/api/v1/status",
@@ -101,7 +128,67 @@ void register_api_v1_endpoints(httpd_handle_t server) {
         .uri = "/api/v1/nrf24/scan",
         .method = HTTP_GET,
         .handler = api_dispatch,
-        .user_ctx = (void*)&ctx_nrf24_scan,
+        .user_ctx = (void*)&ctx_nrf24_scan_start,
+    };
+    httpd_uri_t nrf24_scan_start_uri = {
+        .uri = "/api/v1/nrf24/scan",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_nrf24_scan_start,
+    };
+    httpd_uri_t nrf24_scan_status_uri = {
+        .uri = "/api/v1/nrf24/scan/*",
+        .method = HTTP_GET,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_nrf24_scan_status,
+    };
+    httpd_uri_t nrf24_stats_uri = {
+        .uri = "/api/v1/nrf24/stats",
+        .method = HTTP_GET,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_nrf24_stats,
+    };
+    httpd_uri_t nrf24_benchmark_uri = {
+        .uri = "/api/v1/nrf24/benchmark",
+        .method = HTTP_GET,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_nrf24_benchmark,
+    };
+    httpd_uri_t nrf24_survey_uri = {
+        .uri = "/api/v1/nrf24/survey",
+        .method = HTTP_GET,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_nrf24_survey,
+    };
+    httpd_uri_t nrf24_survey_set_uri = {
+        .uri = "/api/v1/nrf24/survey",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_nrf24_survey_set,
+    };
+    httpd_uri_t nrf24_power_uri = {
+        .uri = "/api/v1/nrf24/power",
+        .method = HTTP_GET,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_nrf24_power,
+    };
+    httpd_uri_t nrf24_power_set_uri = {
+        .uri = "/api/v1/nrf24/power",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_nrf24_power_set,
+    };
+    httpd_uri_t nrf24_capture_uri = {
+        .uri = "/api/v1/nrf24/capture",
+        .method = HTTP_GET,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_nrf24_capture,
+    };
+    httpd_uri_t nrf24_trace_uri = {
+        .uri = "/api/v1/nrf24/trace",
+        .method = HTTP_GET,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_nrf24_trace,
     };
     httpd_uri_t xiaomi_set_id_uri = {
         .uri = "/api/v1/xiaomi/set-id",
@@ -121,6 +208,78 @@ void register_api_v1_endpoints(httpd_handle_t server) {
         .handler = api_dispatch,
         .user_ctx = (void*)&ctx_xiaomi_power_toggle,
     };
+    httpd_uri_t xiaomi_command_uri = {
+        .uri = "/api/v1/xiaomi/command",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_command,
+    };
+    httpd_uri_t xiaomi_on_uri = {
+        .uri = "/api/v1/xiaomi/on",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_on,
+    };
+    httpd_uri_t xiaomi_off_uri = {
+        .uri = "/api/v1/xiaomi/off",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_off,
+    };
+    httpd_uri_t xiaomi_set_uri = {
+        .uri = "/api/v1/xiaomi/set",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_set,
+    };
+    httpd_uri_t xiaomi_hold_start_uri = {
+        .uri = "/api/v1/xiaomi/hold",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_hold_start,
+    };
+    httpd_uri_t xiaomi_hold_stop_uri = {
+        .uri = "/api/v1/xiaomi/hold",
+        .method = HTTP_DELETE,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_hold_stop,
+    };
+    httpd_uri_t xiaomi_hold_status_uri = {
+        .uri = "/api/v1/xiaomi/hold/*",
+        .method = HTTP_GET,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_hold_status,
+    };
+    httpd_uri_t xiaomi_remotes_list_uri = {
+        .uri = "/api/v1/xiaomi/remotes",
+        .method = HTTP_GET,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_remotes_list,
+    };
+    httpd_uri_t xiaomi_remotes_set_uri = {
+        .uri = "/api/v1/xiaomi/remotes",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_remotes_set,
+    };
+    httpd_uri_t xiaomi_remotes_delete_uri = {
+        .uri = "/api/v1/xiaomi/remotes/delete",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_remotes_delete,
+    };
+    httpd_uri_t xiaomi_events_uri = {
+        .uri = "/api/v1/xiaomi/events",
+        .method = HTTP_GET,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_events,
+    };
+    httpd_uri_t xiaomi_sniffer_uri = {
+        .uri = "/api/v1/xiaomi/sniffer",
+        .method = HTTP_POST,
+        .handler = api_dispatch,
+        .user_ctx = (void*)&ctx_xiaomi_sniffer,
+    };
 
     httpd_uri_t preflight_uri = {
         .uri = "/api/v1/*",
@@ -137,8 +296,30 @@ void register_api_v1_endpoints(httpd_handle_t server) {
     httpd_register_uri_handler(server, &logs_uri);
     httpd_register_uri_handler(server, &logs_clear_uri);
     httpd_register_uri_handler(server, &nrf24_scan_uri);
+    httpd_register_uri_handler(server, &nrf24_scan_start_uri);
+    httpd_register_uri_handler(server, &nrf24_scan_status_uri);
+    httpd_register_uri_handler(server, &nrf24_stats_uri);
+    httpd_register_uri_handler(server, &nrf24_benchmark_uri);
+    httpd_register_uri_handler(server, &nrf24_survey_uri);
+    httpd_register_uri_handler(server, &nrf24_survey_set_uri);
+    httpd_register_uri_handler(server, &nrf24_power_uri);
+    httpd_register_uri_handler(server, &nrf24_power_set_uri);
+    httpd_register_uri_handler(server, &nrf24_capture_uri);
+    httpd_register_uri_handler(server, &nrf24_trace_uri);
     httpd_register_uri_handler(server, &xiaomi_set_id_uri);
     httpd_register_uri_handler(server, &xiaomi_get_id_uri);
     httpd_register_uri_handler(server, &xiaomi_power_toggle_uri);
+    httpd_register_uri_handler(server, &xiaomi_command_uri);
+    httpd_register_uri_handler(server, &xiaomi_on_uri);
+    httpd_register_uri_handler(server, &xiaomi_off_uri);
+    httpd_register_uri_handler(server, &xiaomi_set_uri);
+    httpd_register_uri_handler(server, &xiaomi_hold_start_uri);
+    httpd_register_uri_handler(server, &xiaomi_hold_stop_uri);
+    httpd_register_uri_handler(server, &xiaomi_hold_status_uri);
+    httpd_register_uri_handler(server, &xiaomi_remotes_list_uri);
+    httpd_register_uri_handler(server, &xiaomi_remotes_set_uri);
+    httpd_register_uri_handler(server, &xiaomi_remotes_delete_uri);
+    httpd_register_uri_handler(server, &xiaomi_events_uri);
+    httpd_register_uri_handler(server, &xiaomi_sniffer_uri);
     httpd_register_uri_handler(server, &preflight_uri);
 }
@@ -2,10 +2,32 @@
 #include "helper/auth.h"
 #include "log_buffer.h"
 #include "nrf24.h"
+#include "nrf24_capture.h"
+#include "nrf24_trace.h"
 #include "nvs.h"
+#include "xiaomi_events.h"
+#include "xiaomi_remotes.h"
+#include "xiaomi_state.h"
 
+#include <cJSON.h>
 #include <stdlib.h>
 
+/// @brief Sends a {"success": false, "message": ...} response
+/// @param req HTTP request
+/// @param message Error message
+/// @return Result of httpd_resp_send
+static esp_err_t send_error_json(httpd_req_t* req, const char* message) {
+    json_entry_t error_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){0}},
+        {"message", JSON_TYPE_STRING, message},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(error_json), error_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
 esp_err_t status_handler(httpd_req_t* req) {
     uint32_t free_heap = esp_get_free_heap_size();
 
@@ -29,8 +51,12 @@ esp_err_t status_handler(httpd_req_t* req) {
     time_t now;
     time(&now);
 
-    esp_err_t nrf24_status = nrf24_check_connection();
-    int nrf24_connected = (nrf24_status == ESP_OK) ? 1 : 0;
+    // Cached by the radio task, a status poll never touches the SPI bus
+    nrf24_health_t health;
+    nrf24_get_health(&health);
+    int nrf24_connected = health.connected ? 1 : 0;
+    int nrf24_check_age_s = health.checks ? (int)((uptime_us / 1000 - health.last_check_ms) / 1000) : -1;
+    int nrf24_spi_errors = (int)health.spi_errors;
 
     json_entry_t entries[] = {{"status", JSON_TYPE_STRING, "ok"},
                               {"sys_timestamp", JSON_TYPE_NUMBER, &now},
@@ -38,7 +64,10 @@ esp_err_t status_handler(httpd_req_t* req) {
                               {"main_dns", JSON_TYPE_STRING, wifi_get_current_dns_str()},
                               {"free_heap", JSON_TYPE_STRING, free_heap_str},
                               {"uptime", JSON_TYPE_STRING, uptime_str},
-                              {"nrf24_antenna", JSON_TYPE_BOOL, &nrf24_connected}};
+                              {"nrf24_antenna", JSON_TYPE_BOOL, &nrf24_connected},
+                              {"nrf24_health", JSON_TYPE_STRING, nrf24_health_verdict_name(health.verdict)},
+                              {"nrf24_check_age_s", JSON_TYPE_NUMBER, &nrf24_check_age_s},
+                              {"nrf24_spi_errors", JSON_TYPE_NUMBER, &nrf24_spi_errors}};
 
     char* json_response = build_json_safe(JSON_ARRAY_SIZE(entries), entries);
 
@@ -371,7 +400,50 @@ esp_err_t logs_clear_handler(httpd_req_t* req) {
     return result;
 }
 
-esp_err_t nrf24_scan_handler(httpd_req_t* req) {
+/// @brief Builds the ranked remotes and (remote, command) pairs of a scan as JSON arrays
+/// @param result Scan result
+/// @param remotes_json Pointer to store the remotes array, to free by the caller (NULL on allocation failure)
+/// @param patterns_json Pointer to store the patterns array, to free by the caller (NULL on allocation failure)
+static void build_scan_ranking_json(const xiaomi_scan_result_t* result, char** remotes_json, char** patterns_json) {
+    cJSON* remotes = cJSON_CreateArray();
+    for (size_t i = 0; i < result->remote_count; i++) {
+        char id_str[9];
+        snprintf(id_str, sizeof(id_str), "0x%06lX", (unsigned long)result->remotes[i].remote_id);
+
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "id", id_str);
+        cJSON_AddNumberToObject(item, "hits", result->remotes[i].hits);
+        cJSON_AddItemToArray(remotes, item);
+    }
+    *remotes_json = cJSON_PrintUnformatted(remotes);
+    cJSON_Delete(remotes);
+
+    cJSON* patterns = cJSON_CreateArray();
+    for (size_t i = 0; i < result->pattern_count; i++) {
+        const xiaomi_scan_hit_t* hit = &result->patterns[i];
+        char id_str[9];
+        snprintf(id_str, sizeof(id_str), "0x%06lX", (unsigned long)hit->remote_id);
+
+        xiaomi_action_t action;
+        bool known = xiaomi_command_decode(hit->cmd, hit->param, &action);
+
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "id", id_str);
+        cJSON_AddStringToObject(item, "command", known ? xiaomi_command_name(action.command) : "unknown");
+        if (known && action.step > 0) {
+            cJSON_AddNumberToObject(item, "step", action.step);
+        }
+        cJSON_AddNumberToObject(item, "hits", hit->hits);
+        cJSON_AddItemToArray(patterns, item);
+    }
+    *patterns_json = cJSON_PrintUnformatted(patterns);
+    cJSON_Delete(patterns);
+}
+
+/// @brief Reads the duration query parameter of a scan request
+/// @param req HTTP request
+/// @return Scan duration in milliseconds, 10 s when missing or outside 1-60 s
+static uint32_t parse_scan_duration_ms(httpd_req_t* req) {
     char buf[256];
     char duration_str[32] = "10";
 
@@ -386,25 +458,487 @@ esp_err_t nrf24_scan_handler(httpd_req_t* req) {
         duration_sec = 10;
     }
 
-    uint32_t duration_ms = duration_sec * 1000;
+    return duration_sec * 1000;
+}
+
+/// @brief Reads the channel list, strategy and confidence rule query parameters of a scan request
+/// channels is a comma separated list of RF channels, strategy is round_robin or adaptive, confirm_frames and
+/// confirm_channels set the confidence rule. Missing parameters keep the driver defaults
+/// @param req HTTP request
+/// @param options Options to fill
+/// @return true on success, false on a malformed or duplicated channel list or an unknown strategy
+static bool parse_scan_options(httpd_req_t* req, nrf24_scan_options_t* options) {
+    char buf[256];
+    char value[96];
+
+    nrf24_scan_options_default(options);
+
+    if (httpd_req_get_url_query_len(req) == 0 || httpd_req_get_url_query_str(req, buf, sizeof(buf)) != ESP_OK) {
+        return true;
+    }
+
+    if (httpd_query_key_value(buf, "channels", value, sizeof(value)) == ESP_OK) {
+        uint8_t count = 0;
+        char* saveptr = NULL;
+        for (char* tok = strtok_r(value, ",", &saveptr); tok != NULL; tok = strtok_r(NULL, ",", &saveptr)) {
+            char* endptr = NULL;
+            unsigned long channel = strtoul(tok, &endptr, 10);
+            bool invalid = endptr == tok || *endptr != '\0' || channel >= NRF24_CHANNEL_COUNT;
+            if (invalid || count == NRF24_SCAN_CHANNELS_MAX) {
+                return false;
+            }
+            for (uint8_t i = 0; i < count; i++) {
+                if (options->channels[i] == channel) {
+                    return false;
+                }
+            }
+            options->channels[count++] = (uint8_t)channel;
+        }
+        if (count == 0) {
+            return false;
+        }
+        options->channel_count = count;
+    }
+    if (httpd_query_key_value(buf, "strategy", value, sizeof(value)) == ESP_OK) {
+        if (strcmp(value, nrf24_scan_strategy_name(NRF24_SCAN_ROUND_ROBIN)) == 0) {
+            options->strategy = NRF24_SCAN_ROUND_ROBIN;
+        } else if (strcmp(value, nrf24_scan_strategy_name(NRF24_SCAN_ADAPTIVE)) == 0) {
+            options->strategy = NRF24_SCAN_ADAPTIVE;
+        } else {
+            return false;
+        }
+    }
+    if (httpd_query_key_value(buf, "confirm_frames", value, sizeof(value)) == ESP_OK) {
+        unsigned long frames = strtoul(value, NULL, 10);
+        options->rule.frames = frames > UINT8_MAX ? UINT8_MAX : (uint8_t)frames;
+    }
+    if (httpd_query_key_value(buf, "confirm_channels", value, sizeof(value)) == ESP_OK) {
+        unsigned long channels = strtoul(value, NULL, 10);
+        options->rule.channels = channels > UINT8_MAX ? UINT8_MAX : (uint8_t)channels;
+    }
+    if (options->rule.channels > options->channel_count) {
+        options->rule.channels = options->channel_count;
+    }
+    return true;
+}
+
+/// @brief Formats a count per second of scan listening time
+/// @param out Destination buffer
+/// @param size Size of out
+/// @param count Packets or frames counted during the scan
+/// @param listened_ms Listening time of the scan
+static void format_scan_rate(char* out, size_t size, uint32_t count, uint32_t listened_ms) {
+    snprintf(out, size, "%.2f", listened_ms ? count * 1000.0 / listened_ms : 0.0);
+}
+
+/// @brief Builds the listening share of each scan channel as a JSON array
+/// @param result Scan result
+/// @return Array to free by the caller, NULL on allocation failure
+static char* build_scan_channels_json(const xiaomi_scan_result_t* result) {
+    cJSON* channels = cJSON_CreateArray();
+    for (size_t i = 0; i < result->channel_count; i++) {
+        const nrf24_scan_channel_t* entry = &result->channels[i];
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "channel", entry->channel);
+        cJSON_AddNumberToObject(item, "dwell_ms", entry->dwell_ms);
+        cJSON_AddNumberToObject(item, "frames", entry->frames);
+        cJSON_AddItemToArray(channels, item);
+    }
+    char* json = cJSON_PrintUnformatted(channels);
+    cJSON_Delete(channels);
+    return json;
+}
+
+esp_err_t nrf24_scan_start_handler(httpd_req_t* req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    uint32_t duration_ms = parse_scan_duration_ms(req);
+    nrf24_scan_options_t options;
+    if (!parse_scan_options(req, &options)) {
+        return send_error_json(req, "Invalid channels or strategy");
+    }
+
+    uint32_t scan_id = 0;
+    esp_err_t err = nrf24_scan_start(duration_ms, &options, &scan_id);
+    if (err == ESP_ERR_INVALID_STATE) {
+        return send_error_json(req, "A scan is already running");
+    }
+    if (err != ESP_OK) {
+        return send_error_json(req, esp_err_to_name(err));
+    }
+
+    int id_val = (int)scan_id;
+    int duration_val = (int)duration_ms;
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"scan_id", JSON_TYPE_NUMBER, &id_val},
+        {"duration_ms", JSON_TYPE_NUMBER, &duration_val},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+esp_err_t nrf24_scan_status_handler(httpd_req_t* req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    // URI is /api/v1/nrf24/scan/<id>, the query string is not part of the match
+    const char* id_str = strrchr(req->uri, '/');
+    char* endptr = NULL;
+    unsigned long scan_id = id_str ? strtoul(id_str + 1, &endptr, 10) : 0;
+    if (id_str == NULL || endptr == id_str + 1 || (*endptr != '\0' && *endptr != '?')) {
+        return send_error_json(req, "Invalid scan id");
+    }
+
+    nrf24_scan_status_t status;
+    if (nrf24_scan_get_status((uint32_t)scan_id, &status) != ESP_OK) {
+        return send_error_json(req, "Unknown scan id");
+    }
+
+    char remote_id_hex[16] = "";
+    if (status.scan.id_found) {
+        snprintf(remote_id_hex, sizeof(remote_id_hex), "0x%06lX", (unsigned long)status.scan.remote_id);
+    }
+
+    char* remotes_json = NULL;
+    char* patterns_json = NULL;
+    build_scan_ranking_json(&status.scan, &remotes_json, &patterns_json);
+    char* channels_json = build_scan_channels_json(&status.scan);
+
+    char packets_per_s[16];
+    char frames_per_s[16];
+    format_scan_rate(packets_per_s, sizeof(packets_per_s), status.scan.payload_count, status.scan.listened_ms);
+    format_scan_rate(frames_per_s, sizeof(frames_per_s), status.scan.found_count, status.scan.listened_ms);
+
+    int id_val = (int)status.id;
+    int done_val = status.done ? 1 : 0;
+    int elapsed_val = (int)status.elapsed_ms;
+    int duration_val = (int)status.duration_ms;
+    int found_val = (int)status.scan.found_count;
+    int saved_val = (status.done && status.scan.id_saved) ? 1 : 0;
+    int identify_val = (int)status.scan.identify_ms;
+    int listened_val = (int)status.scan.listened_ms;
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"scan_id", JSON_TYPE_NUMBER, &id_val},
+        {"done", JSON_TYPE_BOOL, &done_val},
+        {"status", JSON_TYPE_STRING, esp_err_to_name(status.result)},
+        {"elapsed_ms", JSON_TYPE_NUMBER, &elapsed_val},
+        {"duration_ms", JSON_TYPE_NUMBER, &duration_val},
+        {"found_count", JSON_TYPE_NUMBER, &found_val},
+        {"xiaomi_remote_id", JSON_TYPE_STRING, remote_id_hex},
+        {"xiaomi_id_saved", JSON_TYPE_BOOL, &saved_val},
+        {"confirmed", JSON_TYPE_BOOL, &(int){status.scan.confirmed ? 1 : 0}},
+        {"time_to_identify_ms", JSON_TYPE_NUMBER, &identify_val},
+        {"strategy", JSON_TYPE_STRING, nrf24_scan_strategy_name(status.scan.strategy)},
+        {"listened_ms", JSON_TYPE_NUMBER, &listened_val},
+        {"packets_per_s", JSON_TYPE_RAW, packets_per_s},
+        {"frames_per_s", JSON_TYPE_RAW, frames_per_s},
+        {"channels", JSON_TYPE_RAW, channels_json ? channels_json : "[]"},
+        {"remotes", JSON_TYPE_RAW, remotes_json ? remotes_json : "[]"},
+        {"patterns", JSON_TYPE_RAW, patterns_json ? patterns_json : "[]"},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    free(remotes_json);
+    free(patterns_json);
+    free(channels_json);
+    return res;
+}
+
+/// @brief Format per-pipe counters as a JSON array
+/// @param out Destination buffer
+/// @param size Size of out
+/// @param counts One counter per RX pipe
+static void format_pipe_counts(char* out, size_t size, const uint32_t counts[NRF24_RX_PIPES]) {
+    int pos = snprintf(out, size, "[");
+    for (int i = 0; i < NRF24_RX_PIPES; i++) {
+        pos += snprintf(out + pos, size - pos, "%s%lu", i ? "," : "", (unsigned long)counts[i]);
+    }
+    snprintf(out + pos, size - pos, "]");
+}
 
+esp_err_t nrf24_stats_handler(httpd_req_t* req) {
     httpd_resp_set_type(req, "application/json");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
 
-    esp_err_t err = nrf24_scan_xiaomi(duration_ms);
+    nrf24_stats_t stats;
+    nrf24_get_stats(&stats);
+
+    int spi_transactions = (int)stats.spi_transactions;
+    int spi_saved = (int)stats.spi_saved;
+    int spi_clock_hz = (int)stats.spi_clock_hz;
+    int spi_clock_fallbacks = (int)stats.spi_clock_fallbacks;
+    int tx_frames = (int)stats.tx_frames;
+    int tx_last_burst_us = (int)stats.tx_last_burst_us;
+    int tx_wait_last_us = (int)stats.tx_wait_last_us;
+    int tx_wait_max_us = (int)stats.tx_wait_max_us;
+    int scan_preemptions = (int)stats.scan_preemptions;
+    char pipe_payloads[NRF24_RX_PIPES * 11 + 3];
+    char pipe_decoded[NRF24_RX_PIPES * 11 + 3];
+    format_pipe_counts(pipe_payloads, sizeof(pipe_payloads), stats.rx_pipe_payloads);
+    format_pipe_counts(pipe_decoded, sizeof(pipe_decoded), stats.rx_pipe_decoded);
+
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"spi_transactions", JSON_TYPE_NUMBER, &spi_transactions},
+        {"spi_saved", JSON_TYPE_NUMBER, &spi_saved},
+        {"spi_clock_hz", JSON_TYPE_NUMBER, &spi_clock_hz},
+        {"spi_clock_fallbacks", JSON_TYPE_NUMBER, &spi_clock_fallbacks},
+        {"tx_frames", JSON_TYPE_NUMBER, &tx_frames},
+        {"tx_last_burst_us", JSON_TYPE_NUMBER, &tx_last_burst_us},
+        {"tx_wait_last_us", JSON_TYPE_NUMBER, &tx_wait_last_us},
+        {"tx_wait_max_us", JSON_TYPE_NUMBER, &tx_wait_max_us},
+        {"scan_preemptions", JSON_TYPE_NUMBER, &scan_preemptions},
+        {"rx_pipe_payloads", JSON_TYPE_RAW, pipe_payloads},
+        {"rx_pipe_decoded", JSON_TYPE_RAW, pipe_decoded},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+/// @brief Export sink writing each piece as an HTTP chunk
+static esp_err_t send_chunk_sink(void* ctx, const void* data, size_t len) {
+    return httpd_resp_send_chunk((httpd_req_t*)ctx, (const char*)data, len);
+}
+
+esp_err_t nrf24_capture_handler(httpd_req_t* req) {
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    nrf24_capture_stats_t stats;
+    nrf24_capture_get_stats(&stats);
+
+    char captured[12];
+    char dropped[12];
+    snprintf(captured, sizeof(captured), "%lu", (unsigned long)stats.captured);
+    snprintf(dropped, sizeof(dropped), "%lu", (unsigned long)stats.dropped);
+    httpd_resp_set_hdr(req, "X-Capture-Total", captured);
+    httpd_resp_set_hdr(req, "X-Capture-Dropped", dropped);
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"nrf24.pcap\"");
+    httpd_resp_set_type(req, "application/vnd.tcpdump.pcap");
+
+    esp_err_t err = nrf24_capture_export(send_chunk_sink, req);
+    if (err == ESP_ERR_INVALID_STATE) {
+        // Nothing was sent yet, another client holds the ring
+        httpd_resp_set_type(req, "application/json");
+        return send_error_json(req, "Capture export already running");
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
 
-    const xiaomi_scan_result_t* result = nrf24_get_last_scan_result();
+esp_err_t nrf24_trace_handler(httpd_req_t* req) {
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"nrf24.trace\"");
+    httpd_resp_set_type(req, "application/octet-stream");
 
-    int success_val = (err == ESP_OK && result->id_found) ? 1 : 0;
-    char remote_id_hex[16];
+    esp_err_t err = nrf24_trace_export(send_chunk_sink, req);
+    if (err == ESP_ERR_INVALID_STATE) {
+        httpd_resp_set_type(req, "application/json");
+        return send_error_json(req, "Trace export already running");
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
 
-    snprintf(remote_id_hex, sizeof(remote_id_hex), "0x%06lX", (unsigned long)result->remote_id);
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
 
-    bool saved = nvs_save_xiaomi_id(remote_id_hex);
+/// @brief Sends the survey state and the occupancy histogram
+static esp_err_t send_survey_json(httpd_req_t* req) {
+    nrf24_survey_t survey;
+    nrf24_get_survey(&survey);
+
+    char occupancy_json[NRF24_CHANNEL_COUNT * 4 + 3];
+    size_t pos = 0;
+    occupancy_json[pos++] = '[';
+    for (size_t i = 0; i < NRF24_CHANNEL_COUNT; i++) {
+        pos += snprintf(occupancy_json + pos, sizeof(occupancy_json) - pos, "%s%u", i ? "," : "",
+                        (unsigned)survey.occupancy[i]);
+    }
+    snprintf(occupancy_json + pos, sizeof(occupancy_json) - pos, "]");
 
-    json_entry_t response_json[] = {{"success", JSON_TYPE_BOOL, &(int){success_val ? 1 : 0}},
-                                    {"xiaomi_remote_id", JSON_TYPE_STRING, remote_id_hex},
-                                    {"xiaomi_id_saved", JSON_TYPE_BOOL, &(int){saved ? 1 : 0}}};
+    int sweeps = (int)survey.sweeps;
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"enabled", JSON_TYPE_BOOL, &(int){survey.enabled ? 1 : 0}},
+        {"sweeps", JSON_TYPE_NUMBER, &sweeps},
+        {"occupancy", JSON_TYPE_RAW, occupancy_json},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+esp_err_t nrf24_survey_handler(httpd_req_t* req) {
+    char buf[64];
+    char format[16] = "json";
+
+    if (httpd_req_get_url_query_len(req) > 0) {
+        if (httpd_req_get_url_query_str(req, buf, sizeof(buf)) == ESP_OK) {
+            httpd_query_key_value(buf, "format", format, sizeof(format));
+        }
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    // Compact form: one occupancy byte per channel, channel 0 first
+    if (strcmp(format, "binary") == 0) {
+        nrf24_survey_t survey;
+        nrf24_get_survey(&survey);
+        httpd_resp_set_type(req, "application/octet-stream");
+        return httpd_resp_send(req, (const char*)survey.occupancy, sizeof(survey.occupancy));
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    return send_survey_json(req);
+}
+
+esp_err_t nrf24_survey_set_handler(httpd_req_t* req) {
+    char buf[64];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (ret <= 0) {
+        return send_error_json(req, "No body received");
+    }
+    buf[ret] = '\0';
+
+    cJSON* root = cJSON_Parse(buf);
+    const cJSON* enabled = cJSON_GetObjectItemCaseSensitive(root, "enabled");
+    bool valid = cJSON_IsBool(enabled);
+    bool enable = valid && cJSON_IsTrue(enabled);
+    cJSON_Delete(root);
+
+    if (!valid) {
+        return send_error_json(req, "Missing boolean enabled field");
+    }
+
+    esp_err_t err = nrf24_survey_enable(enable);
+    if (err != ESP_OK) {
+        return send_error_json(req, "Radio did not accept the survey settings");
+    }
+
+    return send_survey_json(req);
+}
+
+/// @brief Sends the power manager state, times in ms since boot per chip state
+static esp_err_t send_power_json(httpd_req_t* req) {
+    nrf24_power_stats_t power;
+    nrf24_get_power(&power);
+
+    char time_json[128];
+    snprintf(time_json, sizeof(time_json), "{\"down\":%llu,\"standby\":%llu,\"tx\":%llu,\"rx\":%llu}",
+             (unsigned long long)(power.time_us[NRF24_POWER_DOWN] / 1000),
+             (unsigned long long)(power.time_us[NRF24_POWER_STANDBY] / 1000),
+             (unsigned long long)(power.time_us[NRF24_POWER_TX] / 1000),
+             (unsigned long long)(power.time_us[NRF24_POWER_RX] / 1000));
+
+    int idle_ms = (int)power.idle_ms;
+    int wakeups = (int)power.wakeups;
+    int last_wake_us = (int)power.last_wake_us;
+    int avg_wake_us = power.wakeups ? (int)(power.wake_total_us / power.wakeups) : 0;
+
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"state", JSON_TYPE_STRING, nrf24_power_state_name(power.state)},
+        {"idle_ms", JSON_TYPE_NUMBER, &idle_ms},
+        {"wakeups", JSON_TYPE_NUMBER, &wakeups},
+        {"last_wake_us", JSON_TYPE_NUMBER, &last_wake_us},
+        {"avg_wake_us", JSON_TYPE_NUMBER, &avg_wake_us},
+        {"time_ms", JSON_TYPE_RAW, time_json},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+esp_err_t nrf24_power_handler(httpd_req_t* req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    return send_power_json(req);
+}
+
+esp_err_t nrf24_power_set_handler(httpd_req_t* req) {
+    char buf[64];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (ret <= 0) {
+        return send_error_json(req, "No body received");
+    }
+    buf[ret] = '\0';
+
+    cJSON* root = cJSON_Parse(buf);
+    const cJSON* idle = cJSON_GetObjectItemCaseSensitive(root, "idle_ms");
+    bool valid = cJSON_IsNumber(idle) && idle->valuedouble >= 0 && idle->valuedouble <= NRF24_POWER_IDLE_MAX_MS;
+    uint32_t idle_ms = valid ? (uint32_t)idle->valuedouble : 0;
+    cJSON_Delete(root);
+
+    if (!valid) {
+        return send_error_json(req, "Expected idle_ms between 0 (never power down) and 3600000");
+    }
+
+    esp_err_t err = nrf24_power_set_idle(idle_ms);
+    if (err != ESP_OK) {
+        return send_error_json(req, "Radio did not accept the power settings");
+    }
+
+    return send_power_json(req);
+}
+
+esp_err_t nrf24_benchmark_handler(httpd_req_t* req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    nrf24_spi_bench_t bench = {0};
+    esp_err_t err = nrf24_benchmark_spi(&bench);
+    if (err != ESP_OK) {
+        json_entry_t error_json[] = {
+            {"success", JSON_TYPE_BOOL, &(int){0}},
+            {"message", JSON_TYPE_STRING, "SPI benchmark failed"},
+            {"error", JSON_TYPE_STRING, esp_err_to_name(err)},
+        };
+
+        char* json_response = build_json_safe(JSON_ARRAY_SIZE(error_json), error_json);
+        esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+        free(json_response);
+        return res;
+    }
+
+    int iterations = (int)bench.iterations;
+    int transmit_ns = (int)bench.transmit_ns;
+    int polling_ns = (int)bench.polling_ns;
+    int batch_ns = (int)bench.batch_ns;
+
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"iterations", JSON_TYPE_NUMBER, &iterations},
+        {"transmit_ns_per_write", JSON_TYPE_NUMBER, &transmit_ns},
+        {"polling_ns_per_write", JSON_TYPE_NUMBER, &polling_ns},
+        {"batch_ns_per_write", JSON_TYPE_NUMBER, &batch_ns},
+    };
 
     char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
     esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
@@ -497,6 +1031,26 @@ esp_err_t xiaomi_get_id_handler(httpd_req_t* req) {
     return res;
 }
 
+/// @brief Loads and parses the saved Xiaomi remote id
+/// @param raw_id Buffer receiving the id as saved
+/// @param raw_size Size of raw_id
+/// @param remote_id Pointer to store the parsed 24-bit id
+/// @return NULL on success, error message otherwise
+static const char* load_xiaomi_remote_id(char* raw_id, size_t raw_size, uint32_t* remote_id) {
+    if (!nvs_load_xiaomi_id(raw_id, raw_size)) {
+        return "No Xiaomi remote id saved";
+    }
+
+    char* endptr = NULL;
+    unsigned long parsed = strtoul(raw_id, &endptr, 0);
+    if (endptr == raw_id || parsed == 0 || parsed > 0xFFFFFF) {
+        return "Invalid Xiaomi remote id";
+    }
+
+    *remote_id = (uint32_t)(parsed & 0xFFFFFF);
+    return NULL;
+}
+
 esp_err_t xiaomi_power_toggle_handler(httpd_req_t* req) {
     httpd_resp_set_type(req, "application/json");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
@@ -504,42 +1058,667 @@ esp_err_t xiaomi_power_toggle_handler(httpd_req_t* req) {
     char raw_id[33] = {0};
     uint32_t remote_id = 0;
 
-    if (!nvs_load_xiaomi_id(raw_id, sizeof(raw_id))) {
-        json_entry_t error_json[] = {
-            {"success", JSON_TYPE_BOOL, &(int){0}},
-            {"message", JSON_TYPE_STRING, "No Xiaomi remote id saved"},
-        };
+    const char* id_error = load_xiaomi_remote_id(raw_id, sizeof(raw_id), &remote_id);
+    if (id_error != NULL) {
+        return send_error_json(req, id_error);
+    }
 
-        char* json_response = build_json_safe(JSON_ARRAY_SIZE(error_json), error_json);
-        esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
-        free(json_response);
-        return res;
+    esp_err_t err = nrf24_send_xiaomi_power(remote_id);
+    const char* err_name = esp_err_to_name(err);
+    int success_val = (err == ESP_OK) ? 1 : 0;
+
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &success_val},
+        {"xiaomi_remote_id", JSON_TYPE_STRING, raw_id},
+        {"command", JSON_TYPE_STRING, "power_toggle"},
+        {"status", JSON_TYPE_STRING, err_name},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+/// @brief Resolves the bars a request targets
+/// A registered group, a registered remote, or the legacy saved remote id when neither is given
+/// @param root Parsed request body
+/// @param target Buffer receiving the target name as given
+/// @param target_size Size of target
+/// @param remote_ids Array receiving the remote ids (NRF24_XIAOMI_GROUP_MAX entries)
+/// @param remote_count Pointer to store the number of remotes
+/// @return NULL on success, error message otherwise
+static const char* resolve_xiaomi_target(const cJSON* root, char* target, size_t target_size, uint32_t* remote_ids,
+                                         size_t* remote_count) {
+    const cJSON* group = cJSON_GetObjectItemCaseSensitive(root, "group");
+    const cJSON* remote = cJSON_GetObjectItemCaseSensitive(root, "remote");
+    *remote_count = 0;
+
+    if (cJSON_IsString(group)) {
+        snprintf(target, target_size, "%s", group->valuestring);
+        *remote_count = xiaomi_remotes_group_ids(target, remote_ids, NRF24_XIAOMI_GROUP_MAX);
+        return (*remote_count == 0) ? "Unknown or empty group" : NULL;
     }
 
-    char* endptr = NULL;
-    unsigned long parsed = strtoul(raw_id, &endptr, 0);
-    if (endptr == raw_id || parsed == 0 || parsed > 0xFFFFFF) {
-        json_entry_t error_json[] = {
-            {"success", JSON_TYPE_BOOL, &(int){0}},
-            {"message", JSON_TYPE_STRING, "Invalid Xiaomi remote id"},
-        };
+    if (cJSON_IsString(remote)) {
+        xiaomi_remote_t entry;
+        snprintf(target, target_size, "%s", remote->valuestring);
+        if (xiaomi_remotes_find(target, &entry) != ESP_OK) {
+            return "Unknown remote";
+        }
+        remote_ids[0] = entry.id;
+        *remote_count = 1;
+        return NULL;
+    }
 
-        char* json_response = build_json_safe(JSON_ARRAY_SIZE(error_json), error_json);
-        esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
-        free(json_response);
-        return res;
+    const char* error = load_xiaomi_remote_id(target, target_size, &remote_ids[0]);
+    *remote_count = (error == NULL) ? 1 : 0;
+    return error;
+}
+
+/// @brief Parses one {"command": "...", "step": n} entry
+/// @param item JSON object
+/// @param action Pointer to store the parsed command
+/// @return true if the entry is valid
+static bool parse_xiaomi_action(const cJSON* item, xiaomi_action_t* action) {
+    const cJSON* command = cJSON_GetObjectItemCaseSensitive(item, "command");
+    const cJSON* step = cJSON_GetObjectItemCaseSensitive(item, "step");
+
+    xiaomi_command_t type;
+    if (!cJSON_IsString(command) || !xiaomi_command_from_name(command->valuestring, &type)) {
+        return false;
     }
 
-    remote_id = (uint32_t)(parsed & 0xFFFFFF);
+    action->command = (uint8_t)type;
+    action->step = 1;
+    if (step != NULL) {
+        if (!cJSON_IsNumber(step) || step->valueint < 1 || step->valueint > XIAOMI_STEP_MAX) {
+            return false;
+        }
+        action->step = (uint8_t)step->valueint;
+    }
 
-    esp_err_t err = nrf24_send_xiaomi_power(remote_id);
+    uint8_t code = 0;
+    uint8_t param = 0;
+    return xiaomi_command_encode(action, &code, &param);
+}
+
+esp_err_t xiaomi_command_handler(httpd_req_t* req) {
+    char buf[512];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (ret <= 0) {
+        return send_error_json(req, "No body received");
+    }
+    buf[ret] = '\0';
+
+    cJSON* root = cJSON_Parse(buf);
+    if (root == NULL) {
+        return send_error_json(req, "Invalid JSON body");
+    }
+
+    uint32_t remote_ids[NRF24_XIAOMI_GROUP_MAX];
+    size_t remote_count = 0;
+    char target[33] = {0};
+    const char* target_error = resolve_xiaomi_target(root, target, sizeof(target), remote_ids, &remote_count);
+    if (target_error != NULL) {
+        cJSON_Delete(root);
+        return send_error_json(req, target_error);
+    }
+
+    // Either a single {"command": ...} object or {"commands": [...]} for a burst
+    xiaomi_action_t actions[NRF24_XIAOMI_BURST_MAX];
+    size_t count = 0;
+    bool valid = true;
+    const cJSON* list = cJSON_GetObjectItemCaseSensitive(root, "commands");
+    if (cJSON_IsArray(list)) {
+        const cJSON* item = NULL;
+        cJSON_ArrayForEach(item, list) {
+            if (count >= NRF24_XIAOMI_BURST_MAX || !parse_xiaomi_action(item, &actions[count])) {
+                valid = false;
+                break;
+            }
+            count++;
+        }
+    } else {
+        valid = parse_xiaomi_action(root, &actions[0]);
+        count = valid ? 1 : 0;
+    }
+    cJSON_Delete(root);
+
+    if (!valid || count == 0) {
+        return send_error_json(req, "Invalid command list (power_toggle, cooler, warmer, higher, lower, reset)");
+    }
+
+    esp_err_t err = nrf24_send_xiaomi_burst(remote_ids, remote_count, actions, count);
     const char* err_name = esp_err_to_name(err);
     int success_val = (err == ESP_OK) ? 1 : 0;
+    int count_val = (int)count;
+    int remotes_val = (int)remote_count;
 
     json_entry_t response_json[] = {
         {"success", JSON_TYPE_BOOL, &success_val},
-        {"xiaomi_remote_id", JSON_TYPE_STRING, raw_id},
-        {"command", JSON_TYPE_STRING, "power_toggle"},
+        {"target", JSON_TYPE_STRING, target},
+        {"remotes", JSON_TYPE_NUMBER, &remotes_val},
+        {"count", JSON_TYPE_NUMBER, &count_val},
+        {"status", JSON_TYPE_STRING, err_name},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+/// @brief Parses an optional 0..XIAOMI_LEVEL_MAX level field
+/// @param root Parsed request body
+/// @param name Field name
+/// @param level Pointer to store the level, XIAOMI_LEVEL_UNKNOWN when absent
+/// @return true if the field is absent or valid
+static bool parse_xiaomi_level(const cJSON* root, const char* name, int8_t* level) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(root, name);
+    *level = XIAOMI_LEVEL_UNKNOWN;
+    if (item == NULL) {
+        return true;
+    }
+    if (!cJSON_IsNumber(item) || item->valueint < 0 || item->valueint > XIAOMI_LEVEL_MAX) {
+        return false;
+    }
+
+    *level = (int8_t)item->valueint;
+    return true;
+}
+
+/// @brief Returns the API name of a power state
+static const char* xiaomi_power_name(uint8_t power) {
+    switch (power) {
+        case XIAOMI_POWER_ON:
+            return "on";
+        case XIAOMI_POWER_OFF:
+            return "off";
+        default:
+            return "unknown";
+    }
+}
+
+/// @brief Brings the targeted bars to a state and answers with what was sent and the resulting states
+/// @param req HTTP request, the body is optional and may name a group or remote
+/// @param power Power state forced by the endpoint, XIAOMI_POWER_UNKNOWN to read it from the body
+/// @return ESP_OK on success, error code otherwise
+static esp_err_t xiaomi_state_request(httpd_req_t* req, xiaomi_power_t power) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    // The body is optional, an empty one targets the saved remote id
+    char buf[256] = {0};
+    int ret = 0;
+    if (req->content_len > 0) {
+        ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+        if (ret <= 0) {
+            return send_error_json(req, "No body received");
+        }
+    }
+    buf[ret] = '\0';
+
+    cJSON* root = (ret > 0) ? cJSON_Parse(buf) : cJSON_CreateObject();
+    if (root == NULL) {
+        return send_error_json(req, "Invalid JSON body");
+    }
+
+    uint32_t remote_ids[NRF24_XIAOMI_GROUP_MAX];
+    size_t remote_count = 0;
+    char target_name[33] = {0};
+    const char* target_error = resolve_xiaomi_target(root, target_name, sizeof(target_name), remote_ids,
+                                                     &remote_count);
+    if (target_error != NULL) {
+        cJSON_Delete(root);
+        return send_error_json(req, target_error);
+    }
+
+    xiaomi_target_t target = {.power = power};
+    bool valid = parse_xiaomi_level(root, "brightness", &target.brightness) &&
+                 parse_xiaomi_level(root, "temperature", &target.temperature);
+    const cJSON* power_item = cJSON_GetObjectItemCaseSensitive(root, "power");
+    if (valid && power == XIAOMI_POWER_UNKNOWN && power_item != NULL) {
+        if (cJSON_IsString(power_item) && strcmp(power_item->valuestring, "on") == 0) {
+            target.power = XIAOMI_POWER_ON;
+        } else if (cJSON_IsString(power_item) && strcmp(power_item->valuestring, "off") == 0) {
+            target.power = XIAOMI_POWER_OFF;
+        } else {
+            valid = false;
+        }
+    }
+    cJSON_Delete(root);
+
+    if (!valid) {
+        return send_error_json(req, "Invalid state (power: on/off, brightness and temperature: 0-15)");
+    }
+
+    size_t sent = 0;
+    esp_err_t err = xiaomi_state_send(remote_ids, remote_count, &target, &sent);
+    const char* err_name = esp_err_to_name(err);
+    int success_val = (err == ESP_OK) ? 1 : 0;
+    int remotes_val = (int)remote_count;
+    int sent_val = (int)sent;
+
+    cJSON* list = cJSON_CreateArray();
+    for (size_t i = 0; i < remote_count; i++) {
+        xiaomi_state_t state;
+        char id_str[9];
+        xiaomi_state_get(remote_ids[i], &state);
+        snprintf(id_str, sizeof(id_str), "0x%06lX", (unsigned long)remote_ids[i]);
+
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "id", id_str);
+        cJSON_AddStringToObject(item, "power", xiaomi_power_name(state.power));
+        cJSON_AddNumberToObject(item, "brightness", state.brightness);
+        cJSON_AddNumberToObject(item, "temperature", state.temperature);
+        cJSON_AddItemToArray(list, item);
+    }
+    char* states_json = cJSON_PrintUnformatted(list);
+    cJSON_Delete(list);
+
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &success_val},
+        {"target", JSON_TYPE_STRING, target_name},
+        {"remotes", JSON_TYPE_NUMBER, &remotes_val},
+        {"sent", JSON_TYPE_NUMBER, &sent_val},
+        {"status", JSON_TYPE_STRING, err_name},
+        {"states", JSON_TYPE_RAW, states_json ? states_json : "[]"},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    free(states_json);
+    return res;
+}
+
+esp_err_t xiaomi_on_handler(httpd_req_t* req) { return xiaomi_state_request(req, XIAOMI_POWER_ON); }
+
+esp_err_t xiaomi_off_handler(httpd_req_t* req) { return xiaomi_state_request(req, XIAOMI_POWER_OFF); }
+
+esp_err_t xiaomi_set_handler(httpd_req_t* req) { return xiaomi_state_request(req, XIAOMI_POWER_UNKNOWN); }
+
+esp_err_t xiaomi_hold_start_handler(httpd_req_t* req) {
+    char buf[256];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (ret <= 0) {
+        return send_error_json(req, "No body received");
+    }
+    buf[ret] = '\0';
+
+    cJSON* root = cJSON_Parse(buf);
+    if (root == NULL) {
+        return send_error_json(req, "Invalid JSON body");
+    }
+
+    uint32_t remote_ids[NRF24_XIAOMI_GROUP_MAX];
+    size_t remote_count = 0;
+    char target[33] = {0};
+    const char* target_error = resolve_xiaomi_target(root, target, sizeof(target), remote_ids, &remote_count);
+    if (target_error != NULL) {
+        cJSON_Delete(root);
+        return send_error_json(req, target_error);
+    }
+
+    const cJSON* command = cJSON_GetObjectItemCaseSensitive(root, "command");
+    const cJSON* steps = cJSON_GetObjectItemCaseSensitive(root, "steps");
+    const cJSON* period = cJSON_GetObjectItemCaseSensitive(root, "period_ms");
+
+    xiaomi_command_t type = XIAOMI_CMD_COUNT;
+    bool valid = cJSON_IsString(command) && xiaomi_command_from_name(command->valuestring, &type) &&
+                 (type == XIAOMI_CMD_COOLER || type == XIAOMI_CMD_WARMER || type == XIAOMI_CMD_HIGHER ||
+                  type == XIAOMI_CMD_LOWER);
+    uint16_t steps_val = 0;
+    if (valid && steps != NULL) {
+        valid = cJSON_IsNumber(steps) && steps->valueint >= 0 && steps->valueint <= UINT16_MAX;
+        steps_val = valid ? (uint16_t)steps->valueint : 0;
+    }
+    uint32_t period_ms = NRF24_HOLD_PERIOD_DEFAULT_MS;
+    if (valid && period != NULL) {
+        valid = cJSON_IsNumber(period) && period->valueint >= NRF24_HOLD_PERIOD_MIN_MS &&
+                period->valueint <= NRF24_HOLD_PERIOD_MAX_MS;
+        period_ms = valid ? (uint32_t)period->valueint : 0;
+    }
+    cJSON_Delete(root);
+
+    if (!valid) {
+        return send_error_json(req, "Invalid hold (command cooler, warmer, higher or lower, period_ms 20..1000)");
+    }
+
+    uint32_t hold_id = 0;
+    esp_err_t err = nrf24_hold_start(remote_ids, remote_count, type, steps_val, period_ms, &hold_id);
+    if (err == ESP_ERR_INVALID_STATE) {
+        return send_error_json(req, "A hold is already running");
+    }
+    if (err != ESP_OK) {
+        return send_error_json(req, esp_err_to_name(err));
+    }
+
+    int id_val = (int)hold_id;
+    int remotes_val = (int)remote_count;
+    int steps_out = (int)steps_val;
+    int period_val = (int)period_ms;
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"hold_id", JSON_TYPE_NUMBER, &id_val},
+        {"target", JSON_TYPE_STRING, target},
+        {"remotes", JSON_TYPE_NUMBER, &remotes_val},
+        {"command", JSON_TYPE_STRING, xiaomi_command_name(type)},
+        {"steps", JSON_TYPE_NUMBER, &steps_out},
+        {"period_ms", JSON_TYPE_NUMBER, &period_val},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+esp_err_t xiaomi_hold_stop_handler(httpd_req_t* req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (nrf24_hold_stop() != ESP_OK) {
+        return send_error_json(req, "No hold is running");
+    }
+
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"message", JSON_TYPE_STRING, "Hold released"},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+esp_err_t xiaomi_hold_status_handler(httpd_req_t* req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    // URI is /api/v1/xiaomi/hold/<id>, the query string is not part of the match
+    const char* id_str = strrchr(req->uri, '/');
+    char* endptr = NULL;
+    unsigned long hold_id = id_str ? strtoul(id_str + 1, &endptr, 10) : 0;
+    if (id_str == NULL || endptr == id_str + 1 || (*endptr != '\0' && *endptr != '?')) {
+        return send_error_json(req, "Invalid hold id");
+    }
+
+    nrf24_hold_status_t status;
+    if (nrf24_hold_get_status((uint32_t)hold_id, &status) != ESP_OK) {
+        return send_error_json(req, "Unknown hold id");
+    }
+
+    int id_val = (int)status.id;
+    int done_val = status.done ? 1 : 0;
+    int steps_val = (int)status.steps;
+    int sent_val = (int)status.steps_sent;
+    int period_val = (int)status.period_ms;
+    int missed_val = (int)status.missed_ticks;
+    int late_val = (int)status.late_max_us;
+    int jitter_avg_val = (int)status.jitter_avg_us;
+    int jitter_max_val = (int)status.jitter_max_us;
+    int step_val = (int)status.step_us;
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"hold_id", JSON_TYPE_NUMBER, &id_val},
+        {"done", JSON_TYPE_BOOL, &done_val},
+        {"status", JSON_TYPE_STRING, esp_err_to_name(status.result)},
+        {"command", JSON_TYPE_STRING, xiaomi_command_name(status.command)},
+        {"steps", JSON_TYPE_NUMBER, &steps_val},
+        {"steps_sent", JSON_TYPE_NUMBER, &sent_val},
+        {"period_ms", JSON_TYPE_NUMBER, &period_val},
+        {"missed_ticks", JSON_TYPE_NUMBER, &missed_val},
+        {"late_max_us", JSON_TYPE_NUMBER, &late_val},
+        {"jitter_avg_us", JSON_TYPE_NUMBER, &jitter_avg_val},
+        {"jitter_max_us", JSON_TYPE_NUMBER, &jitter_max_val},
+        {"step_us", JSON_TYPE_NUMBER, &step_val},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+esp_err_t xiaomi_remotes_list_handler(httpd_req_t* req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    xiaomi_remote_t remotes[XIAOMI_REMOTES_MAX];
+    size_t count = xiaomi_remotes_list(remotes, XIAOMI_REMOTES_MAX);
+
+    cJSON* list = cJSON_CreateArray();
+    for (size_t i = 0; i < count; i++) {
+        char id_str[9];
+        snprintf(id_str, sizeof(id_str), "0x%06lX", (unsigned long)remotes[i].id);
+
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", remotes[i].name);
+        cJSON_AddStringToObject(item, "id", id_str);
+        cJSON_AddStringToObject(item, "group", remotes[i].group);
+        cJSON_AddItemToArray(list, item);
+    }
+    char* remotes_json = cJSON_PrintUnformatted(list);
+    cJSON_Delete(list);
+
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"remotes", JSON_TYPE_RAW, remotes_json ? remotes_json : "[]"},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    free(remotes_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+esp_err_t xiaomi_remotes_set_handler(httpd_req_t* req) {
+    char buf[256];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (ret <= 0) {
+        return send_error_json(req, "No body received");
+    }
+    buf[ret] = '\0';
+
+    cJSON* root = cJSON_Parse(buf);
+    if (root == NULL) {
+        return send_error_json(req, "Invalid JSON body");
+    }
+
+    const cJSON* name = cJSON_GetObjectItemCaseSensitive(root, "name");
+    const cJSON* id = cJSON_GetObjectItemCaseSensitive(root, "id");
+    const cJSON* group = cJSON_GetObjectItemCaseSensitive(root, "group");
+
+    xiaomi_remote_t remote = {0};
+    bool valid = cJSON_IsString(name) && strlen(name->valuestring) < XIAOMI_REMOTE_NAME_LEN && cJSON_IsString(id);
+    if (valid) {
+        char* endptr = NULL;
+        unsigned long parsed = strtoul(id->valuestring, &endptr, 0);
+        valid = endptr != id->valuestring && parsed != 0 && parsed <= 0xFFFFFF;
+        remote.id = (uint32_t)parsed;
+        snprintf(remote.name, sizeof(remote.name), "%s", name->valuestring);
+    }
+    if (valid && group != NULL) {
+        valid = cJSON_IsString(group) && strlen(group->valuestring) < XIAOMI_REMOTE_NAME_LEN;
+        if (valid) {
+            snprintf(remote.group, sizeof(remote.group), "%s", group->valuestring);
+        }
+    }
+    cJSON_Delete(root);
+
+    if (!valid) {
+        return send_error_json(req, "Expected name (max 15 chars), id (24-bit) and optional group (max 15 chars)");
+    }
+
+    esp_err_t err = xiaomi_remotes_set(&remote);
+    if (err != ESP_OK) {
+        return send_error_json(req, err == ESP_ERR_NO_MEM ? "Remote registry is full" : "Failed to save remote");
+    }
+
+    json_entry_t success_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"message", JSON_TYPE_STRING, "Remote saved successfully"},
+        {"name", JSON_TYPE_STRING, remote.name},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(success_json), success_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+esp_err_t xiaomi_remotes_delete_handler(httpd_req_t* req) {
+    char buf[128];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (ret <= 0) {
+        return send_error_json(req, "No body received");
+    }
+    buf[ret] = '\0';
+
+    cJSON* root = cJSON_Parse(buf);
+    const cJSON* name = cJSON_GetObjectItemCaseSensitive(root, "name");
+    char remote_name[XIAOMI_REMOTE_NAME_LEN] = {0};
+    if (cJSON_IsString(name)) {
+        snprintf(remote_name, sizeof(remote_name), "%s", name->valuestring);
+    }
+    cJSON_Delete(root);
+
+    if (remote_name[0] == '\0') {
+        return send_error_json(req, "Missing remote name");
+    }
+
+    esp_err_t err = xiaomi_remotes_remove(remote_name);
+    if (err != ESP_OK) {
+        return send_error_json(req, err == ESP_ERR_NOT_FOUND ? "Unknown remote" : "Failed to delete remote");
+    }
+
+    json_entry_t success_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"message", JSON_TYPE_STRING, "Remote deleted"},
+        {"name", JSON_TYPE_STRING, remote_name},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(success_json), success_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+esp_err_t xiaomi_events_handler(httpd_req_t* req) {
+    char buf[64];
+    char since_str[16] = "0";
+
+    if (httpd_req_get_url_query_len(req) > 0) {
+        if (httpd_req_get_url_query_str(req, buf, sizeof(buf)) == ESP_OK) {
+            httpd_query_key_value(buf, "since", since_str, sizeof(since_str));
+        }
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    uint32_t since = strtoul(since_str, NULL, 10);
+    uint32_t next = since;
+    static xiaomi_event_t events[XIAOMI_EVENTS_CAPACITY];
+    size_t count = xiaomi_events_read(since, events, XIAOMI_EVENTS_CAPACITY, &next);
+
+    cJSON* list = cJSON_CreateArray();
+    for (size_t i = 0; i < count; i++) {
+        char id_str[9];
+        snprintf(id_str, sizeof(id_str), "0x%06lX", (unsigned long)events[i].remote_id);
+        const char* name = xiaomi_command_name(xiaomi_command_classify(events[i].cmd, events[i].param));
+
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "index", events[i].index);
+        cJSON_AddNumberToObject(item, "timestamp_ms", events[i].timestamp_ms);
+        cJSON_AddStringToObject(item, "remote_id", id_str);
+        cJSON_AddNumberToObject(item, "seq", events[i].seq);
+        cJSON_AddNumberToObject(item, "cmd", events[i].cmd);
+        cJSON_AddNumberToObject(item, "param", events[i].param);
+        cJSON_AddStringToObject(item, "command", name ? name : "unknown");
+        cJSON_AddNumberToObject(item, "channel", events[i].channel);
+        cJSON_AddItemToArray(list, item);
+    }
+    char* events_json = cJSON_PrintUnformatted(list);
+    cJSON_Delete(list);
+
+    int next_val = (int)next;
+    // since 0 asks for whatever the ring still holds, nothing was promised before its oldest event
+    int lost = (since > 0 && count > 0 && events[0].index > since) ? 1 : 0;
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){1}},
+        {"sniffer", JSON_TYPE_BOOL, &(int){nrf24_sniffer_active() ? 1 : 0}},
+        {"next", JSON_TYPE_NUMBER, &next_val},
+        {"lost", JSON_TYPE_BOOL, &lost},
+        {"events", JSON_TYPE_RAW, events_json ? events_json : "[]"},
+    };
+
+    char* json_response = build_json_safe(JSON_ARRAY_SIZE(response_json), response_json);
+    free(events_json);
+    esp_err_t res = httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    free(json_response);
+    return res;
+}
+
+esp_err_t xiaomi_sniffer_handler(httpd_req_t* req) {
+    char buf[64];
+    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (ret <= 0) {
+        return send_error_json(req, "No body received");
+    }
+    buf[ret] = '\0';
+
+    cJSON* root = cJSON_Parse(buf);
+    const cJSON* enabled = cJSON_GetObjectItemCaseSensitive(root, "enabled");
+    const cJSON* multipipe = cJSON_GetObjectItemCaseSensitive(root, "multipipe");
+    bool has_enabled = cJSON_IsBool(enabled);
+    bool has_multipipe = cJSON_IsBool(multipipe);
+    bool enable = has_enabled && cJSON_IsTrue(enabled);
+    bool multi = has_multipipe && cJSON_IsTrue(multipipe);
+    cJSON_Delete(root);
+
+    if (!has_enabled && !has_multipipe) {
+        return send_error_json(req, "Missing boolean enabled or multipipe field");
+    }
+
+    // Pipe layout first so an enabling request starts listening with it
+    esp_err_t err = ESP_OK;
+    if (has_multipipe) {
+        err = nrf24_capture_multipipe(multi);
+    }
+    if (err == ESP_OK && has_enabled) {
+        err = nrf24_sniffer_enable(enable);
+    }
+    const char* err_name = esp_err_to_name(err);
+
+    json_entry_t response_json[] = {
+        {"success", JSON_TYPE_BOOL, &(int){err == ESP_OK ? 1 : 0}},
+        {"sniffer", JSON_TYPE_BOOL, &(int){nrf24_sniffer_active() ? 1 : 0}},
+        {"multipipe", JSON_TYPE_BOOL, &(int){nrf24_capture_multipipe_enabled() ? 1 : 0}},
         {"status", JSON_TYPE_STRING, err_name},
     };
 
@@ -9,7 +9,28 @@ esp_err_t wifi_connect_handler(httpd_req_t* req);
 esp_err_t ntp_set_handler(httpd_req_t* req);
 esp_err_t logs_handler(httpd_req_t* req);
 esp_err_t logs_clear_handler(httpd_req_t* req);
-esp_err_t nrf24_scan_handler(httpd_req_t* req);
+esp_err_t nrf24_scan_start_handler(httpd_req_t* req);
+esp_err_t nrf24_scan_status_handler(httpd_req_t* req);
+esp_err_t nrf24_stats_handler(httpd_req_t* req);
+esp_err_t nrf24_benchmark_handler(httpd_req_t* req);
+esp_err_t nrf24_survey_handler(httpd_req_t* req);
+esp_err_t nrf24_survey_set_handler(httpd_req_t* req);
+esp_err_t nrf24_power_handler(httpd_req_t* req);
+esp_err_t nrf24_power_set_handler(httpd_req_t* req);
+esp_err_t nrf24_capture_handler(httpd_req_t* req);
+esp_err_t nrf24_trace_handler(httpd_req_t* req);
 esp_err_t xiaomi_set_id_handler(httpd_req_t* req);
 esp_err_t xiaomi_get_id_handler(httpd_req_t* req);
 esp_err_t xiaomi_power_toggle_handler(httpd_req_t* req);
+esp_err_t xiaomi_command_handler(httpd_req_t* req);
+esp_err_t xiaomi_on_handler(httpd_req_t* req);
+esp_err_t xiaomi_off_handler(httpd_req_t* req);
+esp_err_t xiaomi_set_handler(httpd_req_t* req);
+esp_err_t xiaomi_hold_start_handler(httpd_req_t* req);
+esp_err_t xiaomi_hold_stop_handler(httpd_req_t* req);
+esp_err_t xiaomi_hold_status_handler(httpd_req_t* req);
+esp_err_t xiaomi_remotes_list_handler(httpd_req_t* req);
+esp_err_t xiaomi_remotes_set_handler(httpd_req_t* req);
+esp_err_t xiaomi_remotes_delete_handler(httpd_req_t* req);
+esp_err_t xiaomi_events_handler(httpd_req_t* req);
+esp_err_t xiaomi_sniffer_handler(httpd_req_t* req);
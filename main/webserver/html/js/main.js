@@ -241,12 +241,35 @@ document.addEventListener("DOMContentLoaded", () => {
     nrf24Output.innerHTML =
       "<p>Scanning... Please press buttons on your remote.</p>";
 
-    fetch(`/api/v1/nrf24/scan?duration=${duration}`)
+    // The scan runs in the background, poll its progress so the web server stays free
+    const pollScan = (scanId) =>
+      new Promise((resolve) => setTimeout(resolve, 500))
+        .then(() => fetch(`/api/v1/nrf24/scan/${scanId}`))
+        .then((res) => res.json())
+        .then((data) => {
+          if (!data || data.success === false) {
+            throw new Error((data && data.message) || "Unknown error");
+          }
+          if (data.done) {
+            return data;
+          }
+          const seconds = Math.ceil((data.duration_ms - data.elapsed_ms) / 1000);
+          const heard = data.remotes.map((r) => `${r.id} (${r.hits})`).join(", ");
+          nrf24Output.innerHTML = `<p>Scanning... ${seconds}s left, ${data.found_count} packets.</p>${
+            heard ? `<p>Heard: ${heard}</p>` : ""
+          }`;
+          return pollScan(scanId);
+        });
+
+    fetch(`/api/v1/nrf24/scan?duration=${duration}`, { method: "POST" })
       .then((res) => res.json())
       .then((data) => {
-        if (!data) {
-          throw new Error("Empty response");
+        if (!data || data.success === false) {
+          throw new Error((data && data.message) || "Empty response");
         }
+        return pollScan(data.scan_id);
+      })
+      .then((data) => {
         showOutput(nrf24Output, formatNrf24Scan(data), nrf24Loader);
       })
       .catch((err) => {
@@ -0,0 +1,126 @@
+#include "xiaomi_events.h"
+
+#include <string.h>
+
+#include <esp_log.h>
+
+// A press is repeated on every channel of every pass, copies of one (id, seq) closer than this are the same press
+#define XIAOMI_DEDUP_WINDOW_MS 1500
+#define XIAOMI_DEDUP_SLOTS 8
+
+#define XIAOMI_EVENT_WRITING UINT32_MAX
+
+typedef struct {
+    uint32_t remote_id;
+    uint32_t last_seen_ms;
+    uint8_t seq;
+    bool used;
+} xiaomi_dedup_slot_t;
+
+// Single producer (the radio task), any number of readers. Readers validate each slot against its index, so an entry
+// overwritten while being copied is detected instead of locked out
+static xiaomi_event_t ring[XIAOMI_EVENTS_CAPACITY];
+static volatile uint32_t ring_head = 0;
+
+// Only touched by the producer
+static xiaomi_dedup_slot_t dedup[XIAOMI_DEDUP_SLOTS];
+
+/// @brief Checks the (id, seq) LRU and records the frame
+/// @param frame Decoded frame
+/// @param now_ms Current time in milliseconds
+/// @return true if the frame repeats a recently seen press
+static bool xiaomi_events_is_duplicate(const xiaomi_frame_t* frame, uint32_t now_ms) {
+    size_t victim = 0;
+    uint32_t victim_age = 0;
+    for (size_t i = 0; i < XIAOMI_DEDUP_SLOTS; i++) {
+        xiaomi_dedup_slot_t* slot = &dedup[i];
+        if (slot->used && slot->remote_id == frame->id && slot->seq == frame->seq) {
+            bool duplicate = (now_ms - slot->last_seen_ms) < XIAOMI_DEDUP_WINDOW_MS;
+            slot->last_seen_ms = now_ms;
+            return duplicate;
+        }
+
+        // Free slots first, then the least recently seen press
+        uint32_t age = slot->used ? now_ms - slot->last_seen_ms : UINT32_MAX;
+        if (age >= victim_age) {
+            victim = i;
+            victim_age = age;
+        }
+    }
+
+    dedup[victim] = (xiaomi_dedup_slot_t){
+        .remote_id = frame->id,
+        .last_seen_ms = now_ms,
+        .seq = frame->seq,
+        .used = true,
+    };
+    return false;
+}
+
+/// @brief Records a decoded frame unless it repeats a press already in the ring
+/// Must only be called from the radio task
+/// @param frame Decoded frame
+/// @param channel RF channel it was received on
+/// @return true if a new event was added
+bool xiaomi_events_push(const xiaomi_frame_t* frame, uint8_t channel) {
+    uint32_t now_ms = esp_log_timestamp();
+    if (frame == NULL || xiaomi_events_is_duplicate(frame, now_ms)) {
+        return false;
+    }
+
+    uint32_t index = ring_head;
+    xiaomi_event_t* slot = &ring[index % XIAOMI_EVENTS_CAPACITY];
+
+    slot->index = XIAOMI_EVENT_WRITING;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->timestamp_ms = now_ms;
+    slot->remote_id = frame->id;
+    slot->seq = frame->seq;
+    slot->cmd = frame->cmd;
+    slot->param = frame->param;
+    slot->channel = channel;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->index = index;
+    __atomic_store_n(&ring_head, index + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/// @brief Copies the events recorded at or after a cursor
+/// Events older than the ring capacity are skipped, compare out[0].index with since to detect the gap
+/// @param since Index of the first wanted event (0 for everything still in the ring)
+/// @param out Array receiving the events, oldest first
+/// @param max Capacity of out
+/// @param next Pointer to store the cursor for the next call
+/// @return Number of events copied
+size_t xiaomi_events_read(uint32_t since, xiaomi_event_t* out, size_t max, uint32_t* next) {
+    uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+    uint32_t oldest = (head > XIAOMI_EVENTS_CAPACITY) ? head - XIAOMI_EVENTS_CAPACITY : 0;
+    uint32_t cursor = (since < oldest || since > head) ? oldest : since;
+
+    size_t count = 0;
+    for (; cursor < head && count < max; cursor++) {
+        const xiaomi_event_t* slot = &ring[cursor % XIAOMI_EVENTS_CAPACITY];
+        uint32_t before = __atomic_load_n(&slot->index, __ATOMIC_ACQUIRE);
+        xiaomi_event_t copy = *slot;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t after = __atomic_load_n(&slot->index, __ATOMIC_RELAXED);
+
+        // Overwritten by a newer event while we were behind, skip it
+        if (before != cursor || after != cursor) {
+            continue;
+        }
+        copy.index = cursor;
+        out[count++] = copy;
+    }
+
+    if (next) {
+        *next = cursor;
+    }
+
+    return count;
+}
+
+/// @brief Returns the index the next event will get
+/// @return Event ring head
+uint32_t xiaomi_events_head(void) { return __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE); }
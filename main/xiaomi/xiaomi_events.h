@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "xiaomi_codec.h"
+
+#define XIAOMI_EVENTS_CAPACITY 64
+
+/// One unique remote button press seen on air
+typedef struct {
+    uint32_t index;         // Monotonic event number, used as the read cursor
+    uint32_t timestamp_ms;  // esp_log_timestamp() when the first copy was decoded
+    uint32_t remote_id;
+    uint8_t seq;
+    uint8_t cmd;
+    uint8_t param;
+    uint8_t channel;
+} xiaomi_event_t;
+
+bool xiaomi_events_push(const xiaomi_frame_t* frame, uint8_t channel);
+size_t xiaomi_events_read(uint32_t since, xiaomi_event_t* out, size_t max, uint32_t* next);
+uint32_t xiaomi_events_head(void);
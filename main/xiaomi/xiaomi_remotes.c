@@ -0,0 +1,185 @@
+#include "xiaomi_remotes.h"
+
+#include <string.h>
+
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "nvs.h"
+
+static const char* TAG = "XIAOMI_REMOTES";
+
+// RAM copy of the registry, NVS is only touched when it changes
+static xiaomi_remote_t remotes[XIAOMI_REMOTES_MAX];
+static size_t remote_count = 0;
+static SemaphoreHandle_t remotes_lock = NULL;
+
+/// @brief Writes the registry to NVS, caller holds the lock
+/// @return ESP_OK on success, ESP_FAIL otherwise
+static esp_err_t xiaomi_remotes_persist(void) {
+    if (!nvs_save_xiaomi_remotes(remotes, remote_count * sizeof(remotes[0]))) {
+        ESP_LOGE(TAG, "Failed to save %u remotes to NVS", (unsigned)remote_count);
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+/// @brief Finds a remote slot by name, caller holds the lock
+/// @param name Remote name
+/// @return Slot index, or -1 if not registered
+static int xiaomi_remotes_index(const char* name) {
+    for (size_t i = 0; i < remote_count; i++) {
+        if (strncmp(remotes[i].name, name, XIAOMI_REMOTE_NAME_LEN) == 0) {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+/// @brief Loads the remote registry from NVS
+/// @return ESP_OK on success (an empty registry is not an error), error code otherwise
+esp_err_t xiaomi_remotes_init(void) {
+    if (remotes_lock == NULL) {
+        remotes_lock = xSemaphoreCreateMutex();
+        if (remotes_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreTake(remotes_lock, portMAX_DELAY);
+    size_t size = sizeof(remotes);
+    if (nvs_load_xiaomi_remotes(remotes, &size) && size % sizeof(remotes[0]) == 0) {
+        remote_count = size / sizeof(remotes[0]);
+    } else {
+        remote_count = 0;
+    }
+
+    for (size_t i = 0; i < remote_count; i++) {
+        remotes[i].name[XIAOMI_REMOTE_NAME_LEN - 1] = '\0';
+        remotes[i].group[XIAOMI_REMOTE_NAME_LEN - 1] = '\0';
+    }
+    xSemaphoreGive(remotes_lock);
+
+    ESP_LOGI(TAG, "%u remotes registered", (unsigned)remote_count);
+    return ESP_OK;
+}
+
+/// @brief Copies the registered remotes
+/// @param out Array receiving the remotes
+/// @param max Capacity of out
+/// @return Number of remotes copied
+size_t xiaomi_remotes_list(xiaomi_remote_t* out, size_t max) {
+    if (remotes_lock == NULL || out == NULL) {
+        return 0;
+    }
+
+    xSemaphoreTake(remotes_lock, portMAX_DELAY);
+    size_t n = (remote_count < max) ? remote_count : max;
+    memcpy(out, remotes, n * sizeof(remotes[0]));
+    xSemaphoreGive(remotes_lock);
+
+    return n;
+}
+
+/// @brief Adds a remote, or updates the id and group of the remote with the same name
+/// @param remote Remote to store
+/// @return ESP_OK on success, ESP_ERR_INVALID_ARG on bad id or name, ESP_ERR_NO_MEM if the registry is full
+esp_err_t xiaomi_remotes_set(const xiaomi_remote_t* remote) {
+    if (remotes_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (remote == NULL || remote->id == 0 || remote->id > 0xFFFFFF || remote->name[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(remotes_lock, portMAX_DELAY);
+    int index = xiaomi_remotes_index(remote->name);
+    if (index < 0) {
+        if (remote_count >= XIAOMI_REMOTES_MAX) {
+            xSemaphoreGive(remotes_lock);
+            return ESP_ERR_NO_MEM;
+        }
+        index = (int)remote_count++;
+    }
+
+    remotes[index] = *remote;
+    remotes[index].name[XIAOMI_REMOTE_NAME_LEN - 1] = '\0';
+    remotes[index].group[XIAOMI_REMOTE_NAME_LEN - 1] = '\0';
+    esp_err_t err = xiaomi_remotes_persist();
+    xSemaphoreGive(remotes_lock);
+
+    return err;
+}
+
+/// @brief Removes a remote from the registry
+/// @param name Remote name
+/// @return ESP_OK on success, ESP_ERR_NOT_FOUND if no remote has this name
+esp_err_t xiaomi_remotes_remove(const char* name) {
+    if (remotes_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (name == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(remotes_lock, portMAX_DELAY);
+    int index = xiaomi_remotes_index(name);
+    if (index < 0) {
+        xSemaphoreGive(remotes_lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    memmove(&remotes[index], &remotes[index + 1], (remote_count - (size_t)index - 1) * sizeof(remotes[0]));
+    remote_count--;
+    esp_err_t err = xiaomi_remotes_persist();
+    xSemaphoreGive(remotes_lock);
+
+    return err;
+}
+
+/// @brief Looks up a remote by name
+/// @param name Remote name
+/// @param out Pointer to store the remote
+/// @return ESP_OK if found, ESP_ERR_NOT_FOUND otherwise
+esp_err_t xiaomi_remotes_find(const char* name, xiaomi_remote_t* out) {
+    if (remotes_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (name == NULL || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(remotes_lock, portMAX_DELAY);
+    int index = xiaomi_remotes_index(name);
+    if (index >= 0) {
+        *out = remotes[index];
+    }
+    xSemaphoreGive(remotes_lock);
+
+    return (index >= 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/// @brief Collects the ids of every remote in a group
+/// @param group Group name
+/// @param ids Array receiving the ids
+/// @param max Capacity of ids
+/// @return Number of ids copied
+size_t xiaomi_remotes_group_ids(const char* group, uint32_t* ids, size_t max) {
+    if (remotes_lock == NULL || group == NULL || group[0] == '\0' || ids == NULL) {
+        return 0;
+    }
+
+    size_t n = 0;
+    xSemaphoreTake(remotes_lock, portMAX_DELAY);
+    for (size_t i = 0; i < remote_count && n < max; i++) {
+        if (strncmp(remotes[i].group, group, XIAOMI_REMOTE_NAME_LEN) == 0) {
+            ids[n++] = remotes[i].id;
+        }
+    }
+    xSemaphoreGive(remotes_lock);
+
+    return n;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define XIAOMI_REMOTES_MAX 16
+#define XIAOMI_REMOTE_NAME_LEN 16
+
+/// One registered light bar remote
+typedef struct {
+    uint32_t id;                         // 24-bit remote id
+    char name[XIAOMI_REMOTE_NAME_LEN];   // Unique name
+    char group[XIAOMI_REMOTE_NAME_LEN];  // Group name, empty if the remote is not grouped
+} xiaomi_remote_t;
+
+esp_err_t xiaomi_remotes_init(void);
+size_t xiaomi_remotes_list(xiaomi_remote_t* out, size_t max);
+esp_err_t xiaomi_remotes_set(const xiaomi_remote_t* remote);
+esp_err_t xiaomi_remotes_remove(const char* name);
+esp_err_t xiaomi_remotes_find(const char* name, xiaomi_remote_t* out);
+size_t xiaomi_remotes_group_ids(const char* group, uint32_t* ids, size_t max);
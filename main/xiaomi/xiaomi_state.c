@@ -0,0 +1,262 @@
+#include "xiaomi_state.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+
+#include "nrf24.h"
+
+static const char* TAG = "XIAOMI_STATE";
+
+// Written by the radio task (TX and RX), read by the HTTP handlers
+static xiaomi_state_t states[XIAOMI_STATE_SLOTS];
+static portMUX_TYPE states_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/// @brief Finds the slot of a remote, or recycles the least recently updated one, caller holds the lock
+/// @param remote_id 24-bit remote id
+/// @param create true to allocate a slot for an unknown remote
+/// @return Slot pointer, NULL if the remote is unknown and create is false
+static xiaomi_state_t* xiaomi_state_slot(uint32_t remote_id, bool create) {
+    xiaomi_state_t* victim = &states[0];
+    for (size_t i = 0; i < XIAOMI_STATE_SLOTS; i++) {
+        if (states[i].remote_id == remote_id) {
+            return &states[i];
+        }
+        if (states[i].remote_id == 0) {
+            victim = &states[i];
+        } else if (victim->remote_id != 0 && states[i].updated_ms < victim->updated_ms) {
+            victim = &states[i];
+        }
+    }
+
+    if (!create) {
+        return NULL;
+    }
+
+    *victim = (xiaomi_state_t){
+        .remote_id = remote_id,
+        .power = XIAOMI_POWER_UNKNOWN,
+        .brightness = XIAOMI_LEVEL_UNKNOWN,
+        .temperature = XIAOMI_LEVEL_UNKNOWN,
+    };
+    return victim;
+}
+
+/// @brief Moves a level by a signed number of steps
+/// An unknown level becomes known once a step saturates it against either end
+/// @param level Current level or XIAOMI_LEVEL_UNKNOWN
+/// @param delta Signed number of steps
+/// @return New level or XIAOMI_LEVEL_UNKNOWN
+static int8_t xiaomi_level_step(int8_t level, int delta) {
+    if (level == XIAOMI_LEVEL_UNKNOWN) {
+        if (delta >= XIAOMI_LEVEL_MAX) return XIAOMI_LEVEL_MAX;
+        if (delta <= -XIAOMI_LEVEL_MAX) return 0;
+        return XIAOMI_LEVEL_UNKNOWN;
+    }
+
+    int next = level + delta;
+    if (next < 0) next = 0;
+    if (next > XIAOMI_LEVEL_MAX) next = XIAOMI_LEVEL_MAX;
+    return (int8_t)next;
+}
+
+/// @brief Updates the state of a remote after a command was sent or received
+/// @param remote_id 24-bit remote id
+/// @param action Command that went on air
+void xiaomi_state_apply(uint32_t remote_id, const xiaomi_action_t* action) {
+    if (remote_id == 0 || action == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&states_lock);
+    xiaomi_state_t* state = xiaomi_state_slot(remote_id, true);
+    switch (action->command) {
+        case XIAOMI_CMD_POWER_TOGGLE:
+            if (state->power != XIAOMI_POWER_UNKNOWN) {
+                state->power = (state->power == XIAOMI_POWER_ON) ? XIAOMI_POWER_OFF : XIAOMI_POWER_ON;
+            }
+            break;
+        case XIAOMI_CMD_HIGHER:
+            state->brightness = xiaomi_level_step(state->brightness, action->step);
+            break;
+        case XIAOMI_CMD_LOWER:
+            state->brightness = xiaomi_level_step(state->brightness, -action->step);
+            break;
+        case XIAOMI_CMD_COOLER:
+            state->temperature = xiaomi_level_step(state->temperature, action->step);
+            break;
+        case XIAOMI_CMD_WARMER:
+            state->temperature = xiaomi_level_step(state->temperature, -action->step);
+            break;
+        case XIAOMI_CMD_RESET:
+            // The bar goes back to its factory levels, which we do not model
+            state->brightness = XIAOMI_LEVEL_UNKNOWN;
+            state->temperature = XIAOMI_LEVEL_UNKNOWN;
+            break;
+        default:
+            break;
+    }
+    state->updated_ms = esp_log_timestamp();
+    portEXIT_CRITICAL(&states_lock);
+}
+
+/// @brief Copies the last known state of a remote
+/// @param remote_id 24-bit remote id
+/// @param out Pointer to store the state, filled with unknowns if the remote was never seen
+/// @return true if the remote has a recorded state
+bool xiaomi_state_get(uint32_t remote_id, xiaomi_state_t* out) {
+    if (out == NULL) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&states_lock);
+    xiaomi_state_t* state = xiaomi_state_slot(remote_id, false);
+    if (state != NULL) {
+        *out = *state;
+    }
+    portEXIT_CRITICAL(&states_lock);
+
+    if (state == NULL) {
+        *out = (xiaomi_state_t){
+            .remote_id = remote_id,
+            .power = XIAOMI_POWER_UNKNOWN,
+            .brightness = XIAOMI_LEVEL_UNKNOWN,
+            .temperature = XIAOMI_LEVEL_UNKNOWN,
+        };
+    }
+
+    return state != NULL;
+}
+
+/// @brief Appends the steps moving one level to a target
+/// An unknown level is first driven to 0 with a saturating step so the target is reached from a known point
+/// @param level Current level or XIAOMI_LEVEL_UNKNOWN
+/// @param target Wanted level or XIAOMI_LEVEL_UNKNOWN to leave it alone
+/// @param up Command raising the level
+/// @param down Command lowering the level
+/// @param actions Action list
+/// @param count Number of actions in the list, updated
+/// @param max Capacity of the list
+static void xiaomi_plan_level(int8_t level, int8_t target, xiaomi_command_t up, xiaomi_command_t down,
+                              xiaomi_action_t* actions, size_t* count, size_t max) {
+    if (target == XIAOMI_LEVEL_UNKNOWN || level == target) {
+        return;
+    }
+
+    if (level == XIAOMI_LEVEL_UNKNOWN) {
+        if (*count < max) {
+            actions[(*count)++] = (xiaomi_action_t){.command = down, .step = XIAOMI_LEVEL_MAX};
+        }
+        level = 0;
+    }
+
+    int delta = target - level;
+    if (delta != 0 && *count < max) {
+        actions[(*count)++] = (xiaomi_action_t){.command = delta > 0 ? up : down, .step = (uint8_t)abs(delta)};
+    }
+}
+
+/// @brief Computes the commands moving a bar from its known state to a target
+/// Nothing is planned for fields already at their target. An unknown power state is toggled once, blind, and the
+/// caller records the wanted power once the toggle went out
+/// @param state Current state
+/// @param target Wanted state
+/// @param actions Array receiving the commands
+/// @param max Capacity of actions
+/// @return Number of commands, 0 if the bar is already in the target state
+size_t xiaomi_state_plan(const xiaomi_state_t* state, const xiaomi_target_t* target, xiaomi_action_t* actions,
+                         size_t max) {
+    size_t count = 0;
+    if (state == NULL || target == NULL || actions == NULL) {
+        return 0;
+    }
+
+    if (target->power != XIAOMI_POWER_UNKNOWN && target->power != state->power && count < max) {
+        actions[count++] = (xiaomi_action_t){.command = XIAOMI_CMD_POWER_TOGGLE};
+    }
+
+    // A bar that ends up off ignores level commands
+    if (target->power == XIAOMI_POWER_OFF) {
+        return count;
+    }
+
+    xiaomi_plan_level(state->brightness, target->brightness, XIAOMI_CMD_HIGHER, XIAOMI_CMD_LOWER, actions, &count,
+                      max);
+    xiaomi_plan_level(state->temperature, target->temperature, XIAOMI_CMD_COOLER, XIAOMI_CMD_WARMER, actions, &count,
+                      max);
+
+    return count;
+}
+
+/// @brief Brings one or more bars to a target state with as few frames as possible
+/// Remotes needing the same command list share one burst, bars already in the target state get nothing. A bar whose
+/// power was unknown is recorded at the wanted power after its blind toggle, so a repeated call sends nothing; frames
+/// of the physical remote heard later flip it from there
+/// @param remote_ids 24-bit remote ids
+/// @param remote_count Number of remotes (1..NRF24_XIAOMI_GROUP_MAX)
+/// @param target Wanted state
+/// @param frames_sent Pointer to store the number of commands sent (per remote, summed over bursts), may be NULL
+/// @return ESP_OK on success, error code of the first failing burst otherwise
+esp_err_t xiaomi_state_send(const uint32_t* remote_ids, size_t remote_count, const xiaomi_target_t* target,
+                            size_t* frames_sent) {
+    if (remote_ids == NULL || remote_count == 0 || remote_count > NRF24_XIAOMI_GROUP_MAX || target == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xiaomi_action_t plans[NRF24_XIAOMI_GROUP_MAX][NRF24_XIAOMI_BURST_MAX];
+    size_t plan_len[NRF24_XIAOMI_GROUP_MAX];
+    bool done[NRF24_XIAOMI_GROUP_MAX] = {0};
+    bool blind[NRF24_XIAOMI_GROUP_MAX] = {0};
+    for (size_t r = 0; r < remote_count; r++) {
+        xiaomi_state_t state;
+        xiaomi_state_get(remote_ids[r], &state);
+        plan_len[r] = xiaomi_state_plan(&state, target, plans[r], NRF24_XIAOMI_BURST_MAX);
+        blind[r] = plan_len[r] > 0 && state.power == XIAOMI_POWER_UNKNOWN && target->power != XIAOMI_POWER_UNKNOWN;
+    }
+
+    size_t frames = 0;
+    esp_err_t result = ESP_OK;
+    for (size_t r = 0; r < remote_count; r++) {
+        if (done[r] || plan_len[r] == 0) {
+            continue;
+        }
+
+        uint32_t ids[NRF24_XIAOMI_GROUP_MAX];
+        size_t members[NRF24_XIAOMI_GROUP_MAX];
+        size_t count = 0;
+        for (size_t o = r; o < remote_count; o++) {
+            if (!done[o] && plan_len[o] == plan_len[r] &&
+                memcmp(plans[o], plans[r], plan_len[r] * sizeof(plans[r][0])) == 0) {
+                members[count] = o;
+                ids[count++] = remote_ids[o];
+                done[o] = true;
+            }
+        }
+
+        esp_err_t err = nrf24_send_xiaomi_burst(ids, count, plans[r], plan_len[r]);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Burst to %u remotes failed: %s", (unsigned)count, esp_err_to_name(err));
+            result = (result == ESP_OK) ? err : result;
+            continue;
+        }
+        // The TX path already applied each command and flipped every known power state, a blind toggle left the
+        // power unknown and is assumed to have reached the target
+        frames += plan_len[r] * count;
+        portENTER_CRITICAL(&states_lock);
+        for (size_t i = 0; i < count; i++) {
+            xiaomi_state_t* state = xiaomi_state_slot(ids[i], true);
+            if (blind[members[i]] && state->power == XIAOMI_POWER_UNKNOWN) {
+                state->power = target->power;
+            }
+        }
+        portEXIT_CRITICAL(&states_lock);
+    }
+
+    if (frames_sent) {
+        *frames_sent = frames;
+    }
+
+    return result;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <esp_err.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "xiaomi_codec.h"
+
+#define XIAOMI_STATE_SLOTS 16
+/// Brightness and color temperature are tracked as 0..XIAOMI_LEVEL_MAX steps
+#define XIAOMI_LEVEL_MAX 15
+#define XIAOMI_LEVEL_UNKNOWN -1
+
+typedef enum {
+    XIAOMI_POWER_UNKNOWN = 0,
+    XIAOMI_POWER_OFF,
+    XIAOMI_POWER_ON,
+} xiaomi_power_t;
+
+/// Last known state of one light bar
+typedef struct {
+    uint32_t remote_id;
+    uint32_t updated_ms;  // esp_log_timestamp() of the last TX or RX that changed the state
+    uint8_t power;        // xiaomi_power_t
+    int8_t brightness;    // 0..XIAOMI_LEVEL_MAX or XIAOMI_LEVEL_UNKNOWN
+    int8_t temperature;   // 0 (warmest)..XIAOMI_LEVEL_MAX (coolest) or XIAOMI_LEVEL_UNKNOWN
+} xiaomi_state_t;
+
+/// Wanted state, XIAOMI_POWER_UNKNOWN and XIAOMI_LEVEL_UNKNOWN leave the field as it is
+typedef struct {
+    uint8_t power;  // xiaomi_power_t
+    int8_t brightness;
+    int8_t temperature;
+} xiaomi_target_t;
+
+void xiaomi_state_apply(uint32_t remote_id, const xiaomi_action_t* action);
+bool xiaomi_state_get(uint32_t remote_id, xiaomi_state_t* out);
+size_t xiaomi_state_plan(const xiaomi_state_t* state, const xiaomi_target_t* target, xiaomi_action_t* actions,
+                         size_t max);
+esp_err_t xiaomi_state_send(const uint32_t* remote_ids, size_t remote_count, const xiaomi_target_t* target,
+                            size_t* frames_sent);
@@ -0,0 +1,61 @@
+#include "xiaomi_topk.h"
+
+#include <string.h>
+
+/// @brief Empties the table
+/// @param topk Table
+void xiaomi_topk_reset(xiaomi_topk_t* topk) { memset(topk, 0, sizeof(*topk)); }
+
+/// @brief Counts one occurrence of a key
+/// A key that is not monitored takes over the least counted slot and inherits its count as error
+/// @param topk Table
+/// @param key Key to count
+void xiaomi_topk_add(xiaomi_topk_t* topk, uint64_t key) {
+    topk->total++;
+
+    size_t min_slot = 0;
+    for (size_t i = 0; i < topk->used; i++) {
+        if (topk->entries[i].key == key) {
+            topk->entries[i].count++;
+            return;
+        }
+        if (topk->entries[i].count < topk->entries[min_slot].count) {
+            min_slot = i;
+        }
+    }
+
+    if (topk->used < XIAOMI_TOPK_SLOTS) {
+        topk->entries[topk->used++] = (xiaomi_topk_entry_t){.key = key, .count = 1};
+        return;
+    }
+
+    xiaomi_topk_entry_t* victim = &topk->entries[min_slot];
+    victim->key = key;
+    victim->error = victim->count;
+    victim->count++;
+}
+
+/// @brief Copies the monitored keys, most counted first
+/// Ties go to the smaller error, the key whose count is more certain
+/// @param topk Table
+/// @param out Array receiving the entries
+/// @param max Capacity of out
+/// @return Number of entries copied
+size_t xiaomi_topk_sorted(const xiaomi_topk_t* topk, xiaomi_topk_entry_t* out, size_t max) {
+    // Insertion sort of a copy, the table is only XIAOMI_TOPK_SLOTS entries
+    xiaomi_topk_entry_t sorted[XIAOMI_TOPK_SLOTS];
+    for (size_t i = 0; i < topk->used; i++) {
+        xiaomi_topk_entry_t entry = topk->entries[i];
+        size_t pos = i;
+        while (pos > 0 && (sorted[pos - 1].count < entry.count ||
+                           (sorted[pos - 1].count == entry.count && sorted[pos - 1].error > entry.error))) {
+            sorted[pos] = sorted[pos - 1];
+            pos--;
+        }
+        sorted[pos] = entry;
+    }
+
+    size_t count = (topk->used < max) ? topk->used : max;
+    memcpy(out, sorted, count * sizeof(out[0]));
+    return count;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define XIAOMI_TOPK_SLOTS 8
+
+/// One monitored key, count overestimates the true frequency by at most error
+typedef struct {
+    uint64_t key;
+    uint32_t count;
+    uint32_t error;
+} xiaomi_topk_entry_t;
+
+/// Space-saving heavy hitters: any key seen more than total / XIAOMI_TOPK_SLOTS times is guaranteed to be kept
+typedef struct {
+    xiaomi_topk_entry_t entries[XIAOMI_TOPK_SLOTS];
+    size_t used;
+    uint32_t total;
+} xiaomi_topk_t;
+
+void xiaomi_topk_reset(xiaomi_topk_t* topk);
+void xiaomi_topk_add(xiaomi_topk_t* topk, uint64_t key);
+size_t xiaomi_topk_sorted(const xiaomi_topk_t* topk, xiaomi_topk_entry_t* out, size_t max);
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "codec_reference.h"
+#include "xiaomi_codec.h"
+
+// Cost of the codec paths against the code they replaced: table CRC vs bitwise, preamble window decode vs brute
+// force, template build vs building every frame from scratch. Host timings, compare the ratios rather than the
+// figures
+
+#define BENCH_ITERATIONS 200000
+#define BENCH_PAYLOAD_LEN 32
+
+typedef void (*bench_fn_t)(uint32_t i);
+
+static volatile uint32_t bench_sink;
+static uint8_t bench_payload_hit[BENCH_PAYLOAD_LEN];
+static uint8_t bench_payload_miss[BENCH_PAYLOAD_LEN];
+static xiaomi_template_t bench_template;
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/// @brief Runs fn BENCH_ITERATIONS times after a short warm up
+/// @return Average time of one call in nanoseconds
+static double bench_run(bench_fn_t fn) {
+    for (uint32_t i = 0; i < BENCH_ITERATIONS / 10; i++) {
+        fn(i);
+    }
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        fn(i);
+    }
+    return (double)(bench_now_ns() - start) / BENCH_ITERATIONS;
+}
+
+static void bench_print(const char* name, bench_fn_t fn, bench_fn_t baseline_fn) {
+    double ns = bench_run(fn);
+    double baseline = bench_run(baseline_fn);
+    printf("%-22s %8.1f ns  baseline %8.1f ns  x%.1f\n", name, ns, baseline, baseline / ns);
+}
+
+static void crc_table(uint32_t i) { bench_sink += xiaomi_crc16(bench_payload_hit, 15 + (i & 1)); }
+
+static void crc_bitwise(uint32_t i) { bench_sink += reference_crc16(bench_payload_hit, 15 + (i & 1)); }
+
+static void decode_hit(uint32_t i) {
+    xiaomi_frame_t frame;
+    bench_sink += xiaomi_decode(bench_payload_hit, BENCH_PAYLOAD_LEN, &frame) ? frame.seq : 0;
+}
+
+static void decode_hit_brute(uint32_t i) {
+    xiaomi_frame_t frame;
+    bench_sink += reference_decode(bench_payload_hit, BENCH_PAYLOAD_LEN, &frame) ? frame.seq : 0;
+}
+
+static void decode_miss(uint32_t i) {
+    xiaomi_frame_t frame;
+    bench_sink += xiaomi_decode(bench_payload_miss, BENCH_PAYLOAD_LEN, &frame);
+}
+
+static void decode_miss_brute(uint32_t i) {
+    xiaomi_frame_t frame;
+    bench_sink += reference_decode(bench_payload_miss, BENCH_PAYLOAD_LEN, &frame);
+}
+
+static void build_template(uint32_t i) {
+    uint8_t frame[XIAOMI_FRAME_LEN];
+    xiaomi_template_build(&bench_template, (uint8_t)i, 0x80, 0x3C, frame);
+    bench_sink += frame[15];
+}
+
+static void build_full(uint32_t i) {
+    uint8_t frame[XIAOMI_FRAME_LEN];
+    reference_build_frame(0x701634, (uint8_t)i, 0x80, 0x3C, frame);
+    bench_sink += frame[15];
+}
+
+int main(void) {
+    // A remote frame 19 bits into the payload as the sniffer captures it, and a payload of noise without a frame
+    uint8_t plain[XIAOMI_FRAME_LEN];
+    xiaomi_build_frame(0x701634, 0x2A, 0x80, 0x3C, plain);
+    for (size_t i = 0; i < XIAOMI_FRAME_LEN; i++) {
+        plain[i] ^= reference_whitening[i];
+    }
+    memset(bench_payload_hit, 0xAA, sizeof(bench_payload_hit));
+    for (size_t i = 0; i < XIAOMI_FRAME_LEN; i++) {
+        bench_payload_hit[2 + i] &= 0xE0;
+        bench_payload_hit[2 + i] |= plain[i] >> 3;
+        bench_payload_hit[3 + i] = (uint8_t)(plain[i] << 5);
+    }
+    for (size_t i = 0; i < sizeof(bench_payload_miss); i++) {
+        bench_payload_miss[i] = (uint8_t)(i * 37 + 11);
+    }
+    xiaomi_template_init(&bench_template, 0x701634);
+
+    xiaomi_frame_t check;
+    if (!xiaomi_decode(bench_payload_hit, BENCH_PAYLOAD_LEN, &check) || check.id != 0x701634) {
+        fprintf(stderr, "benchmark payload does not decode\n");
+        return 1;
+    }
+
+    bench_print("crc16 table", crc_table, crc_bitwise);
+    bench_print("decode frame", decode_hit, decode_hit_brute);
+    bench_print("decode noise", decode_miss, decode_miss_brute);
+    bench_print("build from template", build_template, build_full);
+    return 0;
+}
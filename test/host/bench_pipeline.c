@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "nrf24.h"
+#include "radio_harness.h"
+#include "xiaomi_codec.h"
+
+// Figures of the radio pipeline on the model: how long a command takes from the API to the air, how long a scan
+// needs to identify a remote, how the scan strategies share their time when the remote uses one channel only, and
+// how long a command waits behind a running scan.
+// Timings follow the host scheduler, compare runs on the same machine only
+
+#define BENCH_REMOTE_ID 0x701634
+#define BENCH_SENDS 20
+#define BENCH_SCANS 5
+#define BENCH_STRATEGY_SCAN_MS 2000
+#define BENCH_PREEMPT_SCAN_MS 1500
+#define BENCH_PREEMPT_SENDS 10
+
+static int bench_send(void) {
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    uint32_t id = BENCH_REMOTE_ID;
+    uint64_t call_sum = 0;
+    uint64_t air_sum = 0;
+    uint32_t call_max = 0;
+
+    for (int i = 0; i < BENCH_SENDS; i++) {
+        int64_t start = esp_timer_get_time();
+        if (nrf24_send_xiaomi_burst(&id, 1, &toggle, 1) != ESP_OK) {
+            fprintf(stderr, "send %d failed\n", i);
+            return 1;
+        }
+        uint32_t call_us = (uint32_t)(esp_timer_get_time() - start);
+
+        nrf24_stats_t stats;
+        nrf24_get_stats(&stats);
+        call_sum += call_us;
+        air_sum += stats.tx_last_burst_us;
+        if (call_us > call_max) {
+            call_max = call_us;
+        }
+    }
+
+    printf("send: %d toggles, call avg %llu us max %lu us, on air avg %llu us\n", BENCH_SENDS,
+           (unsigned long long)(call_sum / BENCH_SENDS), (unsigned long)call_max,
+           (unsigned long long)(air_sum / BENCH_SENDS));
+    return 0;
+}
+
+static int bench_scan(void) {
+    static const uint8_t channels[] = {6, 15, 43, 68};
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    harness_remote_t remote = {
+        .id = BENCH_REMOTE_ID,
+        .channel_count = sizeof(channels),
+        .press_ms = 150,
+        .gap_ms = 100,
+        .repeat_us = 250,
+    };
+    memcpy(remote.channels, channels, sizeof(channels));
+    xiaomi_command_encode(&toggle, &remote.cmd, &remote.param);
+
+    uint64_t identify_sum = 0;
+    uint32_t identify_max = 0;
+    uint32_t latency_max = 0;
+    harness_remote_start(&remote);
+    for (int i = 0; i < BENCH_SCANS; i++) {
+        esp_err_t err = nrf24_scan_xiaomi(3000, NULL);
+        const xiaomi_scan_result_t* result = nrf24_get_last_scan_result();
+        if (err != ESP_OK || !result->confirmed) {
+            fprintf(stderr, "scan %d did not identify the remote\n", i);
+            harness_remote_stop_all();
+            return 1;
+        }
+        identify_sum += result->identify_ms;
+        if (result->identify_ms > identify_max) {
+            identify_max = result->identify_ms;
+        }
+        if (result->max_decode_latency_us > latency_max) {
+            latency_max = result->max_decode_latency_us;
+        }
+    }
+    harness_remote_stop_all();
+
+    printf("scan: %d scans, identify avg %llu ms max %lu ms, IRQ to decode max %lu us\n", BENCH_SCANS,
+           (unsigned long long)(identify_sum / BENCH_SCANS), (unsigned long)identify_max,
+           (unsigned long)latency_max);
+    return 0;
+}
+
+static int bench_scan_strategies(void) {
+    static const uint8_t strategies[] = {NRF24_SCAN_ROUND_ROBIN, NRF24_SCAN_ADAPTIVE};
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    harness_remote_t remote = {
+        .id = BENCH_REMOTE_ID,
+        .channel_count = 1,
+        .channels = {43},
+        .press_ms = 150,
+        .gap_ms = 100,
+        .repeat_us = 250,
+    };
+    xiaomi_command_encode(&toggle, &remote.cmd, &remote.param);
+
+    for (size_t s = 0; s < sizeof(strategies); s++) {
+        nrf24_scan_options_t options;
+        nrf24_scan_options_default(&options);
+        options.strategy = strategies[s];
+        options.rule.frames = 0;
+
+        harness_remote_start(&remote);
+        esp_err_t err = nrf24_scan_xiaomi(BENCH_STRATEGY_SCAN_MS, &options);
+        harness_remote_stop_all();
+        const xiaomi_scan_result_t* result = nrf24_get_last_scan_result();
+        if (err != ESP_OK || result->listened_ms == 0) {
+            fprintf(stderr, "%s scan heard nothing\n", nrf24_scan_strategy_name(strategies[s]));
+            return 1;
+        }
+
+        printf("scan %-11s: %lu frames/s, dwell", nrf24_scan_strategy_name(strategies[s]),
+               (unsigned long)(result->found_count * 1000ULL / result->listened_ms));
+        for (size_t c = 0; c < result->channel_count; c++) {
+            printf(" ch%u %lu%%", (unsigned)result->channels[c].channel,
+                   (unsigned long)(result->channels[c].dwell_ms * 100ULL / result->listened_ms));
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+static int bench_scan_preemption(void) {
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    uint32_t id = BENCH_REMOTE_ID;
+    nrf24_stats_t before;
+    nrf24_get_stats(&before);
+
+    nrf24_job_t* job = NULL;
+    if (nrf24_submit_scan(BENCH_PREEMPT_SCAN_MS, NULL, &job) != ESP_OK) {
+        fprintf(stderr, "preempted scan not queued\n");
+        return 1;
+    }
+
+    // One toggle every 100 ms while the scan listens, each one suspends it
+    uint64_t wait_sum = 0;
+    uint32_t wait_max = 0;
+    for (int i = 0; i < BENCH_PREEMPT_SENDS; i++) {
+        usleep(100 * 1000);
+        if (nrf24_send_xiaomi_burst(&id, 1, &toggle, 1) != ESP_OK) {
+            fprintf(stderr, "send %d during the scan failed\n", i);
+            nrf24_job_wait(job, BENCH_PREEMPT_SCAN_MS + 2000);
+            nrf24_job_release(job);
+            return 1;
+        }
+        nrf24_stats_t stats;
+        nrf24_get_stats(&stats);
+        wait_sum += stats.tx_wait_last_us;
+        if (stats.tx_wait_last_us > wait_max) {
+            wait_max = stats.tx_wait_last_us;
+        }
+    }
+
+    nrf24_job_wait(job, BENCH_PREEMPT_SCAN_MS + 2000);
+    nrf24_job_release(job);
+    nrf24_stats_t stats;
+    nrf24_get_stats(&stats);
+    printf("scan preempted: %d toggles, queued avg %llu us max %lu us, %lu preemption(s), listened %lu of %d ms\n",
+           BENCH_PREEMPT_SENDS, (unsigned long long)(wait_sum / BENCH_PREEMPT_SENDS), (unsigned long)wait_max,
+           (unsigned long)(stats.scan_preemptions - before.scan_preemptions),
+           (unsigned long)nrf24_get_last_scan_result()->listened_ms, BENCH_PREEMPT_SCAN_MS);
+    return 0;
+}
+
+int main(void) {
+    esp_log_level_set("*", ESP_LOG_WARN);
+    if (!harness_init()) {
+        fprintf(stderr, "harness init failed\n");
+        return 1;
+    }
+
+    int failed = bench_send();
+    failed |= bench_scan();
+    failed |= bench_scan_strategies();
+    failed |= bench_scan_preemption();
+    return failed;
+}
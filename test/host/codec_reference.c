@@ -0,0 +1,107 @@
+#include "codec_reference.h"
+
+#include <string.h>
+
+// Copied from the nrf24 driver before the codec moved to xiaomi_codec.c. Only the names, the return types and the
+// decoded fields changed: the frame is read into an xiaomi_frame_t with the seq, cmd and param bytes of the codec
+
+// Bytes 0-11: fixed mask; Byte 12: 0x90; Byte 13: 0x00; Byte 14: 0xBC; Bytes 15-17: 0x00
+const uint8_t reference_whitening[XIAOMI_FRAME_LEN] = {0xFA, 0xA5, 0x9E, 0xB3, 0x92, 0x6D, 0xAE, 0x1B, 0x48,
+                                                       0x1D, 0x2E, 0x80, 0x90, 0x00, 0xBC, 0x00, 0x00, 0x00};
+
+/// @brief Computes CRC-16-CCITT checksum for given data, one bit at a time
+/// @param data Pointer to the data buffer
+/// @param len Length of the data buffer in bytes
+/// @return Computed CRC-16 checksum
+uint16_t reference_crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFE;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            if (crc & 0x8000) {
+                crc = (crc << 1) ^ 0x1021;
+            } else {
+                crc <<= 1;
+            }
+        }
+    }
+
+    return crc;
+}
+
+/// @brief Builds a whitened 18-byte frame from scratch
+/// @param remote_id 24-bit remote id
+/// @param seq Sequence value
+/// @param cmd Command byte
+/// @param param Parameter/brightness byte
+/// @param output Buffer to store the 18-byte whitened frame
+/// @return true on success, false on invalid arguments
+bool reference_build_frame(uint32_t remote_id, uint8_t seq, uint8_t cmd, uint8_t param, uint8_t* output) {
+    if (output == NULL || remote_id > 0xFFFFFF) {
+        return false;
+    }
+
+    uint8_t packet[XIAOMI_FRAME_LEN] = {0};
+    const uint8_t preamble[8] = {0x53, 0x39, 0x14, 0xDD, 0x1C, 0x49, 0x34, 0x12};
+    memcpy(packet, preamble, 8);
+    packet[8] = (remote_id >> 16) & 0xFF;
+    packet[9] = (remote_id >> 8) & 0xFF;
+    packet[10] = remote_id & 0xFF;
+    packet[11] = 0xFF;
+    packet[12] = seq;
+    packet[13] = cmd;
+    packet[14] = param;
+
+    uint16_t crc = reference_crc16(packet, 15);
+    packet[15] = (crc >> 8) & 0xFF;
+    packet[16] = crc & 0xFF;
+    packet[17] = 0x00;
+
+    for (size_t i = 0; i < XIAOMI_FRAME_LEN; i++) {
+        output[i] = packet[i] ^ reference_whitening[i];
+    }
+
+    return true;
+}
+
+/// @brief Searches for and decodes a Xiaomi frame by trying every byte offset and bit shift
+/// @param raw Pointer to the raw data buffer
+/// @param len Length of the raw data buffer in bytes
+/// @param out Decoded frame (if found)
+/// @return true if a valid frame was found and decoded, false otherwise
+bool reference_decode(const uint8_t* raw, size_t len, xiaomi_frame_t* out) {
+    if (!raw || !out || len < 17) return false;
+
+    const uint8_t expected_preamble[8] = {0x53, 0x39, 0x14, 0xDD, 0x1C, 0x49, 0x34, 0x12};
+    for (size_t byte_off = 0; byte_off + 17 <= len; byte_off++) {
+        for (int shift = 0; shift <= 7; shift++) {
+            uint8_t aligned[17];
+            for (int i = 0; i < 17; i++) {
+                uint8_t a = raw[byte_off + i];
+                uint8_t b = (byte_off + i + 1 < len) ? raw[byte_off + i + 1] : 0;
+                aligned[i] = (shift == 0) ? a : (uint8_t)((a << shift) | (b >> (8 - shift)));
+            }
+
+            bool preamble_ok = true;
+            for (int i = 0; i < 8; i++) {
+                if (aligned[i] != expected_preamble[i]) {
+                    preamble_ok = false;
+                    break;
+                }
+            }
+            if (!preamble_ok || aligned[11] != 0xFF) continue;
+
+            uint16_t crc_calc = reference_crc16(aligned, 15);
+            uint16_t crc_rx = ((uint16_t)aligned[15] << 8) | aligned[16];
+            if (crc_calc != crc_rx) continue;
+
+            out->id = ((uint32_t)aligned[8] << 16) | ((uint32_t)aligned[9] << 8) | aligned[10];
+            out->seq = aligned[12];
+            out->cmd = aligned[13];
+            out->param = aligned[14];
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "xiaomi_codec.h"
+
+// The Xiaomi codec as it was before the table CRC, the 64-bit preamble window and the frame templates: golden
+// reference for the codec tests and baseline of the codec benchmarks
+
+extern const uint8_t reference_whitening[XIAOMI_FRAME_LEN];
+
+uint16_t reference_crc16(const uint8_t* data, size_t len);
+bool reference_build_frame(uint32_t remote_id, uint8_t seq, uint8_t cmd, uint8_t param, uint8_t* output);
+bool reference_decode(const uint8_t* raw, size_t len, xiaomi_frame_t* out);
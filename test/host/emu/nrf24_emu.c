@@ -0,0 +1,531 @@
+#include "nrf24_emu.h"
+
+#include <string.h>
+
+#define REG_CONFIG 0x00
+#define REG_EN_AA 0x01
+#define REG_EN_RXADDR 0x02
+#define REG_SETUP_AW 0x03
+#define REG_SETUP_RETR 0x04
+#define REG_RF_CH 0x05
+#define REG_RF_SETUP 0x06
+#define REG_STATUS 0x07
+#define REG_OBSERVE_TX 0x08
+#define REG_RPD 0x09
+#define REG_RX_ADDR_P0 0x0A
+#define REG_RX_ADDR_P1 0x0B
+#define REG_TX_ADDR 0x10
+#define REG_RX_PW_P0 0x11
+#define REG_FIFO_STATUS 0x17
+#define REG_DYNPD 0x1C
+#define REG_FEATURE 0x1D
+
+#define CONFIG_EN_CRC (1 << 3)
+#define CONFIG_CRCO (1 << 2)
+#define CONFIG_PWR_UP (1 << 1)
+#define CONFIG_PRIM_RX (1 << 0)
+#define STATUS_RX_DR (1 << 6)
+#define STATUS_TX_DS (1 << 5)
+#define STATUS_IRQ_MASK 0x70
+#define RF_SETUP_DR_LOW (1 << 5)
+#define RF_SETUP_DR_HIGH (1 << 3)
+#define FEATURE_EN_DPL (1 << 2)
+
+#define PIPE_COUNT 6
+#define NEVER UINT64_MAX
+
+/// Appends bits MSB first to an air buffer
+typedef struct {
+    uint8_t* buf;
+    uint16_t nbits;
+} bit_writer_t;
+
+static void bits_put(bit_writer_t* w, uint32_t value, unsigned count) {
+    for (int b = (int)count - 1; b >= 0; b--) {
+        uint16_t pos = w->nbits++;
+        if ((value >> b) & 1) {
+            w->buf[pos >> 3] |= (uint8_t)(0x80 >> (pos & 7));
+        } else {
+            w->buf[pos >> 3] &= (uint8_t)~(0x80 >> (pos & 7));
+        }
+    }
+}
+
+/// @brief Reads up to 64 bits MSB first, bits past the end of the packet read as zero
+static uint64_t bits_get(const uint8_t* bits, size_t nbits, size_t pos, unsigned count) {
+    uint64_t value = 0;
+    for (unsigned i = 0; i < count; i++, pos++) {
+        uint64_t bit = pos < nbits ? (bits[pos >> 3] >> (7 - (pos & 7))) & 1 : 0;
+        value = (value << 1) | bit;
+    }
+    return value;
+}
+
+/// @brief CRC over a bit range as the radio computes it, CCITT-16 (init 0xFFFF) or CRC-8 (poly 0x07, init 0xFF)
+static uint16_t air_crc(const uint8_t* bits, size_t nbits, size_t pos, size_t count, unsigned width) {
+    uint16_t poly = width == 16 ? 0x1021 : 0x07;
+    uint16_t mask = width == 16 ? 0xFFFF : 0xFF;
+    uint16_t crc = mask;
+    for (size_t i = 0; i < count; i++) {
+        uint16_t feedback = (uint16_t)(((crc >> (width - 1)) & 1) ^ bits_get(bits, nbits, pos + i, 1));
+        crc = (uint16_t)((crc << 1) & mask);
+        if (feedback) {
+            crc ^= poly;
+        }
+    }
+    return crc;
+}
+
+static uint64_t air_now(const nrf24_emu_air_t* air) {
+    return air->now_us(air->clock_ctx);
+}
+
+/// @brief Address width in bytes, the illegal SETUP_AW value 0 is taken as 3 bytes
+static unsigned radio_addr_width(const nrf24_emu_t* radio) {
+    uint8_t aw = radio->regs[REG_SETUP_AW][0] & 0x03;
+    return aw == 0 ? 3 : aw + 2u;
+}
+
+static uint16_t radio_rate_kbps(const nrf24_emu_t* radio) {
+    uint8_t setup = radio->regs[REG_RF_SETUP][0];
+    if (setup & RF_SETUP_DR_LOW) {
+        return 250;
+    }
+    return (setup & RF_SETUP_DR_HIGH) ? 2000 : 1000;
+}
+
+static unsigned radio_crc_width(const nrf24_emu_t* radio) {
+    uint8_t config = radio->regs[REG_CONFIG][0];
+    if (!(config & CONFIG_EN_CRC)) {
+        return 0;
+    }
+    return (config & CONFIG_CRCO) ? 16 : 8;
+}
+
+static bool radio_pipe_dpl(const nrf24_emu_t* radio, unsigned pipe) {
+    return (radio->regs[REG_FEATURE][0] & FEATURE_EN_DPL) && (radio->regs[REG_DYNPD][0] & (1 << pipe));
+}
+
+/// @brief Enhanced ShockBurst adds the 9-bit packet control field, plain ShockBurst (no auto-ack, no DPL) does not
+static bool radio_pipe_pcf(const nrf24_emu_t* radio, unsigned pipe) {
+    return (radio->regs[REG_EN_AA][0] & (1 << pipe)) || radio_pipe_dpl(radio, pipe);
+}
+
+static uint8_t radio_status(const nrf24_emu_t* radio) {
+    uint8_t rx_p_no = radio->rx_count > 0 ? radio->rx_fifo[0].pipe : 7;
+    return (uint8_t)((radio->regs[REG_STATUS][0] & STATUS_IRQ_MASK) | (rx_p_no << 1) |
+                     (radio->tx_count == NRF24_EMU_FIFO_DEPTH ? 1 : 0));
+}
+
+static uint8_t radio_fifo_status(const nrf24_emu_t* radio) {
+    uint8_t value = 0;
+    if (radio->tx_count == NRF24_EMU_FIFO_DEPTH) value |= 1 << 5;
+    if (radio->tx_count == 0) value |= 1 << 4;
+    if (radio->rx_count == NRF24_EMU_FIFO_DEPTH) value |= 1 << 1;
+    if (radio->rx_count == 0) value |= 1 << 0;
+    return value;
+}
+
+/// @brief Recomputes the IRQ pin and reports a falling edge
+static void radio_update_irq(nrf24_emu_t* radio) {
+    uint8_t pending = radio->regs[REG_STATUS][0] & STATUS_IRQ_MASK & ~radio->regs[REG_CONFIG][0];
+    bool level = pending != 0;
+    if (level && !radio->irq_level && radio->irq != NULL) {
+        radio->irq(radio->irq_ctx);
+    }
+    radio->irq_level = level;
+}
+
+/// @brief Serializes the head of the TX FIFO into its on-air bitstream and schedules it
+static void radio_schedule_tx(nrf24_emu_t* radio, uint64_t start_us) {
+    const nrf24_emu_payload_t* payload = &radio->tx_fifo[0];
+    unsigned aw = radio_addr_width(radio);
+    const uint8_t* addr = radio->regs[REG_TX_ADDR];
+    bit_writer_t w = {.buf = radio->tx_bits, .nbits = 0};
+
+    // The address goes out most significant byte first, the preamble matches its first bit
+    bits_put(&w, (addr[aw - 1] & 0x80) ? 0xAA : 0x55, 8);
+    for (int i = (int)aw - 1; i >= 0; i--) {
+        bits_put(&w, addr[i], 8);
+    }
+    if (radio_pipe_pcf(radio, 0)) {
+        bits_put(&w, ((uint32_t)payload->len << 3) | ((radio->packets_sent & 3) << 1), 9);
+    }
+    for (uint8_t i = 0; i < payload->len; i++) {
+        bits_put(&w, payload->data[i], 8);
+    }
+    unsigned crc_width = radio_crc_width(radio);
+    if (crc_width != 0) {
+        bits_put(&w, air_crc(radio->tx_bits, w.nbits, 8, w.nbits - 8u, crc_width), crc_width);
+    }
+
+    uint16_t rate = radio_rate_kbps(radio);
+    radio->tx_nbits = w.nbits;
+    radio->tx_start_us = start_us;
+    radio->tx_end_us = start_us + ((uint64_t)w.nbits * 1000 + rate - 1) / rate;
+    radio->tx_busy = true;
+}
+
+/// @brief Applies the PWR_UP/PRIM_RX/CE state machine after a register write or a CE edge
+static void radio_settle(nrf24_emu_t* radio, uint64_t now) {
+    uint8_t config = radio->regs[REG_CONFIG][0];
+    bool powered = config & CONFIG_PWR_UP;
+    bool listening = powered && (config & CONFIG_PRIM_RX) && radio->ce;
+
+    if (!listening) {
+        radio->rx_since_us = NEVER;
+    } else if (radio->rx_since_us == NEVER) {
+        radio->rx_since_us = now + NRF24_EMU_SETTLE_US;
+        radio->regs[REG_RPD][0] = 0;
+    }
+
+    if (!powered && radio->tx_busy && now < radio->tx_start_us) {
+        radio->tx_busy = false;
+    }
+    if (powered && !(config & CONFIG_PRIM_RX) && radio->ce && radio->tx_count > 0 && !radio->tx_busy) {
+        radio_schedule_tx(radio, now + NRF24_EMU_SETTLE_US);
+    }
+}
+
+/// @brief Looks for a pipe address in a packet heard on air and stores the payload that follows it
+/// The search runs over every bit offset, like the radio's correlator, so a 0xAA/0x55 address also locks onto
+/// alternating bits inside another packet
+static void radio_receive(nrf24_emu_t* radio, const uint8_t* bits, size_t nbits) {
+    unsigned aw = radio_addr_width(radio);
+    uint64_t pipe_addr[PIPE_COUNT];
+    bool pipe_open[PIPE_COUNT];
+    for (unsigned p = 0; p < PIPE_COUNT; p++) {
+        const uint8_t* base = radio->regs[p == 0 ? REG_RX_ADDR_P0 : REG_RX_ADDR_P1];
+        pipe_addr[p] = 0;
+        for (int i = (int)aw - 1; i >= 0; i--) {
+            uint8_t byte = (i == 0 && p >= 2) ? radio->regs[REG_RX_ADDR_P0 + p][0] : base[i];
+            pipe_addr[p] = (pipe_addr[p] << 8) | byte;
+        }
+        uint8_t width = radio->regs[REG_RX_PW_P0 + p][0] & 0x3F;
+        pipe_open[p] = (radio->regs[REG_EN_RXADDR][0] & (1 << p)) && (width > 0 || radio_pipe_dpl(radio, p));
+    }
+
+    // Preamble and address as one sync word, slid over the packet one bit at a time
+    unsigned addr_bits = aw * 8;
+    uint64_t sync_mask = (1ULL << (addr_bits + 8)) - 1;
+    uint64_t pipe_sync[PIPE_COUNT];
+    for (unsigned p = 0; p < PIPE_COUNT; p++) {
+        uint64_t preamble = (pipe_addr[p] >> (addr_bits - 1)) & 1 ? 0xAA : 0x55;
+        pipe_sync[p] = (preamble << addr_bits) | pipe_addr[p];
+    }
+
+    uint64_t window = 0;
+    for (size_t bit = 0; bit < nbits; bit++) {
+        window = ((window << 1) | ((bits[bit >> 3] >> (7 - (bit & 7))) & 1)) & sync_mask;
+        if (bit + 1 < addr_bits + 8) {
+            continue;
+        }
+        size_t pos = bit + 1 - addr_bits;
+        for (unsigned p = 0; p < PIPE_COUNT; p++) {
+            if (!pipe_open[p] || window != pipe_sync[p]) {
+                continue;
+            }
+
+            // Locked, the rest of the packet is taken as is, past the end of the packet it is silence
+            size_t cursor = pos + addr_bits;
+            uint8_t len = radio->regs[REG_RX_PW_P0 + p][0] & 0x3F;
+            if (radio_pipe_pcf(radio, p)) {
+                uint64_t pcf = bits_get(bits, nbits, cursor, 9);
+                cursor += 9;
+                if (radio_pipe_dpl(radio, p)) {
+                    len = (uint8_t)(pcf >> 3);
+                }
+            }
+            if (len == 0 || len > NRF24_EMU_PAYLOAD_MAX) {
+                radio->packets_dropped++;
+                return;
+            }
+
+            nrf24_emu_payload_t payload = {.len = len, .pipe = (uint8_t)p};
+            for (uint8_t i = 0; i < len; i++, cursor += 8) {
+                payload.data[i] = (uint8_t)bits_get(bits, nbits, cursor, 8);
+            }
+
+            unsigned crc_width = radio_crc_width(radio);
+            if (crc_width != 0 &&
+                air_crc(bits, nbits, pos, cursor - pos, crc_width) != bits_get(bits, nbits, cursor, crc_width)) {
+                radio->packets_dropped++;
+                return;
+            }
+            if (radio->rx_count == NRF24_EMU_FIFO_DEPTH) {
+                radio->packets_dropped++;
+                return;
+            }
+
+            radio->rx_fifo[radio->rx_count++] = payload;
+            radio->packets_received++;
+            radio->regs[REG_STATUS][0] |= STATUS_RX_DR;
+            radio_update_irq(radio);
+            return;
+        }
+    }
+}
+
+/// @brief Hands a finished packet to every radio listening on its channel and rate
+static void air_deliver(nrf24_emu_air_t* air, const nrf24_emu_t* sender, uint8_t channel, uint16_t rate_kbps,
+                        const uint8_t* bits, size_t nbits, uint64_t start_us, uint64_t end_us) {
+    air->packets++;
+    for (size_t i = 0; i < air->radio_count; i++) {
+        nrf24_emu_t* radio = air->radios[i];
+        if (radio == sender || radio->rx_since_us > end_us) {
+            continue;
+        }
+        if ((radio->regs[REG_RF_CH][0] & 0x7F) != channel || radio_rate_kbps(radio) != rate_kbps) {
+            continue;
+        }
+
+        // Any overlap with the listen window raises the received power detector, a full packet is needed to lock
+        radio->regs[REG_RPD][0] = 1;
+        if (radio->rx_since_us <= start_us) {
+            radio_receive(radio, bits, nbits);
+        }
+    }
+}
+
+/// @brief Ends the packet on air, frees its FIFO slot and chains the next one while CE stays high
+static void radio_complete_tx(nrf24_emu_t* radio) {
+    nrf24_emu_air_t* air = radio->air;
+    air_deliver(air, radio, radio->regs[REG_RF_CH][0] & 0x7F, radio_rate_kbps(radio), radio->tx_bits,
+                radio->tx_nbits, radio->tx_start_us, radio->tx_end_us);
+
+    radio->tx_busy = false;
+    radio->packets_sent++;
+    if (radio->tx_flushed) {
+        radio->tx_flushed = false;
+    } else if (radio->tx_count > 0) {
+        radio->tx_count--;
+        memmove(&radio->tx_fifo[0], &radio->tx_fifo[1], radio->tx_count * sizeof(radio->tx_fifo[0]));
+    }
+    radio->regs[REG_STATUS][0] |= STATUS_TX_DS;
+    radio_update_irq(radio);
+
+    // Standby-II: the next payload goes out after another settle
+    uint8_t config = radio->regs[REG_CONFIG][0];
+    if ((config & CONFIG_PWR_UP) && !(config & CONFIG_PRIM_RX) && radio->ce && radio->tx_count > 0) {
+        radio_schedule_tx(radio, radio->tx_end_us + NRF24_EMU_SETTLE_US);
+    }
+}
+
+/// @brief Writes a register, honouring STATUS write-1-to-clear and the read-only registers
+static void radio_write_register(nrf24_emu_t* radio, uint8_t reg, const uint8_t* data, size_t len, uint64_t now) {
+    if (reg >= NRF24_EMU_REG_COUNT || len == 0 || reg == REG_OBSERVE_TX || reg == REG_RPD ||
+        reg == REG_FIFO_STATUS) {
+        return;
+    }
+
+    if (reg == REG_STATUS) {
+        radio->regs[REG_STATUS][0] &= ~(data[0] & STATUS_IRQ_MASK);
+        radio_update_irq(radio);
+        return;
+    }
+
+    bool wide = reg == REG_RX_ADDR_P0 || reg == REG_RX_ADDR_P1 || reg == REG_TX_ADDR;
+    size_t count = wide ? (len < 5 ? len : 5) : 1;
+    bool retune = (reg == REG_RF_CH || reg == REG_RF_SETUP) && radio->regs[reg][0] != data[0];
+    memcpy(radio->regs[reg], data, count);
+
+    // Moving the synthesizer while listening restarts the RX settle
+    if (retune && radio->rx_since_us != NEVER) {
+        radio->rx_since_us = now + NRF24_EMU_SETTLE_US;
+    }
+    if (reg == REG_CONFIG) {
+        radio_update_irq(radio);
+    }
+    radio_settle(radio, now);
+}
+
+static void radio_reset(nrf24_emu_t* radio) {
+    memset(radio->regs, 0, sizeof(radio->regs));
+    radio->regs[REG_CONFIG][0] = 0x08;
+    radio->regs[REG_EN_AA][0] = 0x3F;
+    radio->regs[REG_EN_RXADDR][0] = 0x03;
+    radio->regs[REG_SETUP_AW][0] = 0x03;
+    radio->regs[REG_SETUP_RETR][0] = 0x03;
+    radio->regs[REG_RF_CH][0] = 0x02;
+    radio->regs[REG_RF_SETUP][0] = 0x0E;
+    radio->regs[REG_STATUS][0] = 0x0E;
+    memset(radio->regs[REG_RX_ADDR_P0], 0xE7, 5);
+    memset(radio->regs[REG_RX_ADDR_P1], 0xC2, 5);
+    for (uint8_t p = 2; p < PIPE_COUNT; p++) {
+        radio->regs[REG_RX_ADDR_P0 + p][0] = 0xC1 + p;
+    }
+    memset(radio->regs[REG_TX_ADDR], 0xE7, 5);
+
+    radio->ce = false;
+    radio->tx_count = 0;
+    radio->rx_count = 0;
+    radio->tx_busy = false;
+    radio->tx_flushed = false;
+    radio->rx_since_us = NEVER;
+    radio->irq_level = false;
+}
+
+/// @brief Prepares an empty air
+/// @param air Air to initialize
+/// @param now_us Clock of the simulation in microseconds
+/// @param clock_ctx Passed to now_us
+void nrf24_emu_air_init(nrf24_emu_air_t* air, uint64_t (*now_us)(void* ctx), void* clock_ctx) {
+    memset(air, 0, sizeof(*air));
+    air->now_us = now_us;
+    air->clock_ctx = clock_ctx;
+}
+
+/// @brief Powers on a chip with its reset register values and attaches it to an air
+/// @param radio Chip to initialize
+/// @param air Air it transmits on and listens to
+/// @param irq Called on every falling edge of the IRQ pin, may be NULL
+/// @param irq_ctx Passed to irq
+/// @return true on success, false if the air already holds NRF24_EMU_RADIOS_MAX chips
+bool nrf24_emu_init(nrf24_emu_t* radio, nrf24_emu_air_t* air, void (*irq)(void* ctx), void* irq_ctx) {
+    if (radio == NULL || air == NULL || air->radio_count >= NRF24_EMU_RADIOS_MAX) {
+        return false;
+    }
+
+    memset(radio, 0, sizeof(*radio));
+    radio->air = air;
+    radio->irq = irq;
+    radio->irq_ctx = irq_ctx;
+    radio_reset(radio);
+    air->radios[air->radio_count++] = radio;
+
+    return true;
+}
+
+/// @brief Runs one chip select framed SPI exchange, the first byte out is always STATUS
+/// @param radio Chip addressed
+/// @param tx Bytes clocked in, tx[0] is the command
+/// @param rx Bytes clocked out, may be NULL
+/// @param len Length of the exchange
+/// @return true on success, false on an empty exchange
+bool nrf24_emu_transfer(nrf24_emu_t* radio, const uint8_t* tx, uint8_t* rx, size_t len) {
+    if (radio == NULL || tx == NULL || len == 0) {
+        return false;
+    }
+
+    nrf24_emu_air_update(radio->air);
+    uint64_t now = air_now(radio->air);
+    uint8_t out[1 + NRF24_EMU_PAYLOAD_MAX + 5] = {0};
+    size_t data_len = len - 1;
+    uint8_t cmd = tx[0];
+
+    out[0] = radio_status(radio);
+    if ((cmd & 0xE0) == 0x00) {
+        // R_REGISTER
+        uint8_t reg = cmd & 0x1F;
+        for (size_t i = 0; i < data_len && i + 1 < sizeof(out); i++) {
+            if (reg == REG_FIFO_STATUS) {
+                out[1 + i] = i == 0 ? radio_fifo_status(radio) : 0;
+            } else if (reg == REG_STATUS) {
+                out[1 + i] = i == 0 ? radio_status(radio) : 0;
+            } else if (reg < NRF24_EMU_REG_COUNT && i < 5) {
+                out[1 + i] = radio->regs[reg][i];
+            }
+        }
+    } else if ((cmd & 0xE0) == 0x20) {
+        radio_write_register(radio, cmd & 0x1F, &tx[1], data_len, now);
+    } else if (cmd == 0x61) {
+        // R_RX_PAYLOAD
+        if (radio->rx_count > 0) {
+            memcpy(&out[1], radio->rx_fifo[0].data, radio->rx_fifo[0].len);
+            radio->rx_count--;
+            memmove(&radio->rx_fifo[0], &radio->rx_fifo[1], radio->rx_count * sizeof(radio->rx_fifo[0]));
+        }
+    } else if (cmd == 0x60) {
+        // R_RX_PL_WID
+        out[1] = radio->rx_count > 0 ? radio->rx_fifo[0].len : 0;
+    } else if (cmd == 0xA0 || cmd == 0xB0) {
+        // W_TX_PAYLOAD, W_TX_PAYLOAD_NOACK
+        if (radio->tx_count < NRF24_EMU_FIFO_DEPTH && data_len > 0) {
+            nrf24_emu_payload_t* slot = &radio->tx_fifo[radio->tx_count++];
+            slot->len = (uint8_t)(data_len < NRF24_EMU_PAYLOAD_MAX ? data_len : NRF24_EMU_PAYLOAD_MAX);
+            slot->pipe = 0;
+            memcpy(slot->data, &tx[1], slot->len);
+            radio_settle(radio, now);
+        }
+    } else if (cmd == 0xE1) {
+        // FLUSH_TX, a packet already on air still finishes
+        radio->tx_count = 0;
+        if (radio->tx_busy && now < radio->tx_start_us) {
+            radio->tx_busy = false;
+        } else if (radio->tx_busy) {
+            radio->tx_flushed = true;
+        }
+    } else if (cmd == 0xE2) {
+        radio->rx_count = 0;
+    }
+
+    if (rx != NULL) {
+        memcpy(rx, out, len < sizeof(out) ? len : sizeof(out));
+    }
+
+    return true;
+}
+
+/// @brief Drives the CE pin of a chip
+/// @param radio Chip addressed
+/// @param high true to raise CE
+void nrf24_emu_set_ce(nrf24_emu_t* radio, bool high) {
+    if (radio == NULL || radio->ce == high) {
+        return;
+    }
+
+    nrf24_emu_air_update(radio->air);
+    radio->ce = high;
+    radio_settle(radio, air_now(radio->air));
+}
+
+/// @brief Catches up with the clock, finishing every packet whose air time has passed in order
+/// @param air Air to update
+void nrf24_emu_air_update(nrf24_emu_air_t* air) {
+    uint64_t now = air_now(air);
+    for (;;) {
+        nrf24_emu_t* next = NULL;
+        for (size_t i = 0; i < air->radio_count; i++) {
+            nrf24_emu_t* radio = air->radios[i];
+            if (radio->tx_busy && radio->tx_end_us <= now && (next == NULL || radio->tx_end_us < next->tx_end_us)) {
+                next = radio;
+            }
+        }
+        if (next == NULL) {
+            return;
+        }
+        radio_complete_tx(next);
+    }
+}
+
+/// @brief Tells when the next packet leaves the air, so a simulation can jump its clock there
+/// @param air Air to inspect
+/// @return Clock value of the next event, UINT64_MAX when nothing is on air
+uint64_t nrf24_emu_air_next_event_us(const nrf24_emu_air_t* air) {
+    uint64_t next = NEVER;
+    for (size_t i = 0; i < air->radio_count; i++) {
+        const nrf24_emu_t* radio = air->radios[i];
+        if (radio->tx_busy && radio->tx_end_us < next) {
+            next = radio->tx_end_us;
+        }
+    }
+    return next;
+}
+
+/// @brief Puts a foreign packet on air that ends now, for remotes and interference that are not nRF24 models
+/// @param air Air to transmit on
+/// @param channel RF channel
+/// @param rate_kbps Air data rate, 250, 1000 or 2000
+/// @param bits Packet bits MSB first, preamble included
+/// @param nbits Number of bits
+void nrf24_emu_air_inject(nrf24_emu_air_t* air, uint8_t channel, uint16_t rate_kbps, const uint8_t* bits,
+                          size_t nbits) {
+    if (air == NULL || bits == NULL || rate_kbps == 0) {
+        return;
+    }
+
+    nrf24_emu_air_update(air);
+    uint64_t now = air_now(air);
+    uint64_t duration = ((uint64_t)nbits * 1000 + rate_kbps - 1) / rate_kbps;
+    air_deliver(air, NULL, channel, rate_kbps, bits, nbits, now > duration ? now - duration : 0, now);
+}
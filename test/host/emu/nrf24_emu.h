@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Register level nRF24L01+ model, plain C with no ESP-IDF dependency so the driver can run against it on the host
+//
+// Covered: register file with reset values, write-1-to-clear STATUS, 3-deep TX and RX FIFOs, the SPI command set,
+// PWR_UP/PRIM_RX/CE state machine with the 130 us settle, on-air timing for 250k/1M/2M, RPD, IRQ masking, and a
+// shared air that carries the transmitted bitstream (preamble, address, PCF, payload, CRC) to every listening
+// model. Receivers match addresses at bit level, so the alternating-address promiscuous trick works as on hardware.
+// Not covered: auto-ack and retransmits (TX_DS is raised as soon as the packet leaves), dynamic payloads on RX,
+// ACK payloads, power-up delays and RF noise
+//
+// The model is event driven on the clock given to the air: nothing happens between calls, every call first
+// catches up with the clock. It is not thread safe, callers serialize access to one air and its radios
+
+#define NRF24_EMU_RADIOS_MAX 4
+#define NRF24_EMU_FIFO_DEPTH 3
+#define NRF24_EMU_PAYLOAD_MAX 32
+#define NRF24_EMU_REG_COUNT 0x1E
+/// Preamble, 5-byte address, 9-bit PCF, 32-byte payload and 2-byte CRC, rounded up
+#define NRF24_EMU_AIR_MAX_BYTES 42
+#define NRF24_EMU_SETTLE_US 130
+
+typedef struct nrf24_emu_air nrf24_emu_air_t;
+
+typedef struct {
+    uint8_t len;
+    uint8_t pipe;
+    uint8_t data[NRF24_EMU_PAYLOAD_MAX];
+} nrf24_emu_payload_t;
+
+/// One emulated chip
+typedef struct {
+    nrf24_emu_air_t* air;
+    uint8_t regs[NRF24_EMU_REG_COUNT][5];
+    bool ce;
+
+    nrf24_emu_payload_t tx_fifo[NRF24_EMU_FIFO_DEPTH];
+    uint8_t tx_count;
+    nrf24_emu_payload_t rx_fifo[NRF24_EMU_FIFO_DEPTH];
+    uint8_t rx_count;
+
+    bool tx_busy;          // A packet is scheduled or on air
+    bool tx_flushed;       // FLUSH_TX hit the packet on air, its slot is already gone
+    uint64_t tx_start_us;  // Start of the scheduled packet
+    uint64_t tx_end_us;    // End of the scheduled packet
+    uint64_t rx_since_us;  // End of the RX settle, UINT64_MAX when not listening
+    uint8_t tx_bits[NRF24_EMU_AIR_MAX_BYTES];
+    uint16_t tx_nbits;
+
+    bool irq_level;          // true while the IRQ pin is asserted (low)
+    void (*irq)(void* ctx);  // Called on every falling edge of the IRQ pin
+    void* irq_ctx;
+
+    uint32_t packets_sent;
+    uint32_t packets_received;
+    uint32_t packets_dropped;  // Matched but lost to a full RX FIFO or a CRC mismatch
+} nrf24_emu_t;
+
+/// Shared medium and clock
+struct nrf24_emu_air {
+    uint64_t (*now_us)(void* ctx);
+    void* clock_ctx;
+    nrf24_emu_t* radios[NRF24_EMU_RADIOS_MAX];
+    size_t radio_count;
+    uint64_t packets;  // Packets carried since init
+};
+
+void nrf24_emu_air_init(nrf24_emu_air_t* air, uint64_t (*now_us)(void* ctx), void* clock_ctx);
+bool nrf24_emu_init(nrf24_emu_t* radio, nrf24_emu_air_t* air, void (*irq)(void* ctx), void* irq_ctx);
+bool nrf24_emu_transfer(nrf24_emu_t* radio, const uint8_t* tx, uint8_t* rx, size_t len);
+void nrf24_emu_set_ce(nrf24_emu_t* radio, bool high);
+void nrf24_emu_air_update(nrf24_emu_air_t* air);
+uint64_t nrf24_emu_air_next_event_us(const nrf24_emu_air_t* air);
+void nrf24_emu_air_inject(nrf24_emu_air_t* air, uint8_t channel, uint16_t rate_kbps, const uint8_t* bits,
+                          size_t nbits);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdio.h>
+
+// Minimal checks for the host tests: a failed check is reported and the binary exits non-zero once all tests ran
+
+static int host_test_failures = 0;
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++;                                                    \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                                     \
+    do {                                                                                                   \
+        long long check_a = (long long)(a);                                                                \
+        long long check_b = (long long)(b);                                                                \
+        if (check_a != check_b) {                                                                          \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, \
+                    check_a, check_b);                                                                     \
+            host_test_failures++;                                                                          \
+        }                                                                                                  \
+    } while (0)
+
+#define RUN_TEST(fn)                                                                     \
+    do {                                                                                 \
+        int before = host_test_failures;                                                 \
+        fn();                                                                            \
+        fprintf(stderr, "%s %s\n", host_test_failures == before ? "PASS" : "FAIL", #fn); \
+    } while (0)
+
+#define HOST_TEST_RESULT() (host_test_failures == 0 ? 0 : 1)
@@ -0,0 +1,267 @@
+#include "radio_harness.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host_shim.h"
+#include "nrf24.h"
+#include "nrf24_hal.h"
+#include "xiaomi_codec.h"
+
+// Sync run of a remote packet: the alternating bits the sniffer's AA AA AA AA AA address locks onto
+#define HARNESS_SYNC_BYTES 7
+#define HARNESS_PAYLOAD_BYTES 32
+
+typedef struct {
+    bool used;
+    volatile bool stop;
+    pthread_t thread;
+    harness_remote_t config;
+} harness_remote_slot_t;
+
+static pthread_mutex_t air_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t air_cond;
+static nrf24_emu_air_t air;
+static nrf24_emu_t dut;
+static pthread_t pump_thread;
+static harness_remote_slot_t remotes[HARNESS_REMOTES_MAX];
+static volatile uint32_t dut_irq_edges;
+
+static uint64_t harness_clock(void* ctx) { return host_time_us(); }
+
+/// @brief IRQ falling edge of the driver's chip, the pin interrupt of the board
+static void harness_dut_irq(void* ctx) {
+    dut_irq_edges++;
+    nrf24_hal_irq();
+}
+
+static esp_err_t harness_transfer(void* ctx, const uint8_t* tx, uint8_t* rx, size_t len) {
+    harness_lock();
+    bool ok = nrf24_emu_transfer(&dut, tx, rx, len);
+    harness_unlock();
+    return ok ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+static void harness_set_ce(void* ctx, bool high) {
+    harness_lock();
+    nrf24_emu_set_ce(&dut, high);
+    harness_unlock();
+}
+
+static const nrf24_hal_t harness_hal = {
+    .name = "nrf24_emu",
+    .transfer = harness_transfer,
+    .set_ce = harness_set_ce,
+};
+
+/// @brief Finishes every packet when its air time is over, so TX_DS and RX_DR rise without a bus access
+static void* harness_pump(void* arg) {
+    pthread_mutex_lock(&air_lock);
+    for (;;) {
+        nrf24_emu_air_update(&air);
+        uint64_t next = nrf24_emu_air_next_event_us(&air);
+        if (next == UINT64_MAX) {
+            pthread_cond_wait(&air_cond, &air_lock);
+            continue;
+        }
+
+        uint64_t now = host_time_us();
+        if (next > now) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            uint64_t ns = (uint64_t)deadline.tv_nsec + (next - now) * 1000;
+            deadline.tv_sec += (time_t)(ns / 1000000000);
+            deadline.tv_nsec = (long)(ns % 1000000000);
+            pthread_cond_timedwait(&air_cond, &air_lock, &deadline);
+        }
+    }
+    return NULL;
+}
+
+/// @brief Builds the model, installs it under the driver and starts the radio task
+/// @return true on success
+bool harness_init(void) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&air_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    nrf24_emu_air_init(&air, harness_clock, NULL);
+    if (!nrf24_emu_init(&dut, &air, harness_dut_irq, NULL)) {
+        return false;
+    }
+    if (pthread_create(&pump_thread, NULL, harness_pump, NULL) != 0) {
+        return false;
+    }
+    pthread_detach(pump_thread);
+
+    host_nvs_reset();
+    return nrf24_set_hal(&harness_hal) == ESP_OK && nrf24_init() == ESP_OK;
+}
+
+/// @brief Serializes access to the air, also wakes the pump since a packet may have been scheduled
+void harness_lock(void) { pthread_mutex_lock(&air_lock); }
+
+void harness_unlock(void) {
+    pthread_cond_signal(&air_cond);
+    pthread_mutex_unlock(&air_lock);
+}
+
+nrf24_emu_t* harness_dut(void) { return &dut; }
+
+/// @brief Falling edges the driver's chip put on its IRQ line so far
+uint32_t harness_irq_edges(void) { return dut_irq_edges; }
+
+nrf24_emu_air_t* harness_air(void) { return &air; }
+
+/// @brief On-air bits of a remote packet: a sync run, the plaintext frame, then silence up to 32 payload bytes
+/// @param bits Buffer of at least HARNESS_SYNC_BYTES + 32 bytes
+/// @return Number of bits
+size_t harness_remote_frame(uint32_t id, uint8_t seq, uint8_t cmd, uint8_t param, uint8_t* bits) {
+    static const uint8_t preamble[8] = {0x53, 0x39, 0x14, 0xDD, 0x1C, 0x49, 0x34, 0x12};
+
+    memset(bits, 0, HARNESS_SYNC_BYTES + HARNESS_PAYLOAD_BYTES);
+    memset(bits, 0xAA, HARNESS_SYNC_BYTES);
+    uint8_t* frame = &bits[HARNESS_SYNC_BYTES];
+    memcpy(frame, preamble, sizeof(preamble));
+    frame[8] = (uint8_t)(id >> 16);
+    frame[9] = (uint8_t)(id >> 8);
+    frame[10] = (uint8_t)id;
+    frame[11] = 0xFF;
+    frame[12] = seq;
+    frame[13] = cmd;
+    frame[14] = param;
+    uint16_t crc = xiaomi_crc16(frame, 15);
+    frame[15] = (uint8_t)(crc >> 8);
+    frame[16] = (uint8_t)crc;
+
+    return (HARNESS_SYNC_BYTES + HARNESS_PAYLOAD_BYTES) * 8;
+}
+
+/// @brief Puts one remote frame on air at 2 Mbps, ending now
+void harness_remote_inject(uint8_t channel, uint32_t id, uint8_t seq, uint8_t cmd, uint8_t param) {
+    uint8_t bits[HARNESS_SYNC_BYTES + HARNESS_PAYLOAD_BYTES];
+    size_t nbits = harness_remote_frame(id, seq, cmd, param, bits);
+
+    harness_lock();
+    nrf24_emu_air_inject(&air, channel, 2000, bits, nbits);
+    harness_unlock();
+}
+
+static void harness_sleep_us(uint64_t us) {
+    struct timespec ts = {.tv_sec = (time_t)(us / 1000000), .tv_nsec = (long)(us % 1000000) * 1000};
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {
+    }
+}
+
+static void* harness_remote_run(void* arg) {
+    harness_remote_slot_t* slot = arg;
+    const harness_remote_t* remote = &slot->config;
+    uint8_t seq = remote->seq;
+
+    while (!slot->stop) {
+        uint64_t until = host_time_us() + (uint64_t)remote->press_ms * 1000;
+        while (!slot->stop && host_time_us() < until) {
+            for (size_t c = 0; c < remote->channel_count; c++) {
+                harness_remote_inject(remote->channels[c], remote->id, seq, remote->cmd, remote->param);
+                harness_sleep_us(remote->repeat_us);
+            }
+        }
+        seq++;
+
+        uint64_t quiet_until = host_time_us() + (uint64_t)remote->gap_ms * 1000;
+        while (!slot->stop && host_time_us() < quiet_until) {
+            harness_sleep_us(1000);
+        }
+    }
+    return NULL;
+}
+
+/// @brief Starts pressing a remote in the background until harness_remote_stop_all
+/// @return false if HARNESS_REMOTES_MAX remotes already run
+bool harness_remote_start(const harness_remote_t* remote) {
+    for (size_t i = 0; i < HARNESS_REMOTES_MAX; i++) {
+        if (!remotes[i].used) {
+            remotes[i].used = true;
+            remotes[i].stop = false;
+            remotes[i].config = *remote;
+            return pthread_create(&remotes[i].thread, NULL, harness_remote_run, &remotes[i]) == 0;
+        }
+    }
+    return false;
+}
+
+void harness_remote_stop_all(void) {
+    for (size_t i = 0; i < HARNESS_REMOTES_MAX; i++) {
+        if (remotes[i].used) {
+            remotes[i].stop = true;
+            pthread_join(remotes[i].thread, NULL);
+            remotes[i].used = false;
+        }
+    }
+}
+
+/// @brief Writes one register of a chip owned by the harness, the lock is held by the caller
+static void harness_write(nrf24_emu_t* radio, uint8_t reg, const uint8_t* value, size_t len) {
+    uint8_t tx[6] = {(uint8_t)(0x20 | reg)};
+    memcpy(&tx[1], value, len);
+    nrf24_emu_transfer(radio, tx, NULL, 1 + len);
+}
+
+/// @brief Adds a light bar listening on one channel: the Xiaomi address, 18-byte frames, no CRC, no auto-ack
+/// @return false if the air is full
+bool harness_light_init(nrf24_emu_t* light, uint8_t channel) {
+    static const uint8_t address[5] = {0x67, 0x22, 0x00, 0x00, 0x00};
+    const uint8_t zero = 0x00;
+    const uint8_t one = 0x01;
+    const uint8_t aw = 0x03;
+    const uint8_t rf = 0x0E;
+    const uint8_t width = XIAOMI_FRAME_LEN;
+    const uint8_t config = 0x03;
+
+    harness_lock();
+    bool ok = nrf24_emu_init(light, &air, NULL, NULL);
+    if (ok) {
+        harness_write(light, 0x01, &zero, 1);
+        harness_write(light, 0x02, &one, 1);
+        harness_write(light, 0x03, &aw, 1);
+        harness_write(light, 0x05, &channel, 1);
+        harness_write(light, 0x06, &rf, 1);
+        harness_write(light, 0x0A, address, sizeof(address));
+        harness_write(light, 0x11, &width, 1);
+        harness_write(light, 0x00, &config, 1);
+        nrf24_emu_set_ce(light, true);
+    }
+    harness_unlock();
+    return ok;
+}
+
+/// @brief Drains the RX FIFO of a light bar
+/// @param frames Receives the payloads
+/// @param max Capacity of frames
+/// @return Number of payloads read
+size_t harness_light_read(nrf24_emu_t* light, uint8_t (*frames)[32], size_t max) {
+    size_t count = 0;
+
+    harness_lock();
+    nrf24_emu_air_update(&air);
+    while (count < max && light->rx_count > 0) {
+        uint8_t tx[1 + 32];
+        uint8_t rx[1 + 32];
+        memset(tx, 0xFF, sizeof(tx));
+        tx[0] = 0x61;
+        size_t len = light->rx_fifo[0].len;
+        nrf24_emu_transfer(light, tx, rx, 1 + len);
+        memset(frames[count], 0, 32);
+        memcpy(frames[count], &rx[1], len);
+        count++;
+    }
+    const uint8_t clear = 0x40;
+    harness_write(light, 0x07, &clear, 1);
+    harness_unlock();
+    return count;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "nrf24_emu.h"
+
+// Runs the nrf24 driver against the register level model on the host: the driver's chip is installed as its
+// nrf24_hal_t, a pump thread finishes packets on the real clock so RX_DR reaches the driver through the IRQ line,
+// and emulated remotes and light bars share the same air. Every access to the air goes through harness_lock
+
+/// An emulated remote: every press repeats one frame over its channels for press_ms, then stays quiet for gap_ms
+typedef struct {
+    uint32_t id;
+    uint8_t cmd;
+    uint8_t param;
+    uint8_t seq;  // Sequence of the first press, incremented on every press
+    uint8_t channel_count;
+    uint8_t channels[8];
+    uint32_t press_ms;
+    uint32_t gap_ms;
+    uint32_t repeat_us;  // Pause between two frames of a press
+} harness_remote_t;
+
+#define HARNESS_REMOTES_MAX 4
+
+bool harness_init(void);
+void harness_lock(void);
+void harness_unlock(void);
+nrf24_emu_t* harness_dut(void);
+uint32_t harness_irq_edges(void);
+nrf24_emu_air_t* harness_air(void);
+
+size_t harness_remote_frame(uint32_t id, uint8_t seq, uint8_t cmd, uint8_t param, uint8_t* bits);
+void harness_remote_inject(uint8_t channel, uint32_t id, uint8_t seq, uint8_t cmd, uint8_t param);
+bool harness_remote_start(const harness_remote_t* remote);
+void harness_remote_stop_all(void);
+
+bool harness_light_init(nrf24_emu_t* light, uint8_t channel);
+size_t harness_light_read(nrf24_emu_t* light, uint8_t (*frames)[32], size_t max);
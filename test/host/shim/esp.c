@@ -0,0 +1,265 @@
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_random.h>
+#include <esp_rom_sys.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <driver/spi_master.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "host_shim.h"
+
+struct esp_timer {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    esp_timer_cb_t callback;
+    void* arg;
+    bool active;
+    uint64_t period_us;  // 0 for a one shot
+    uint64_t next_us;
+};
+
+static esp_log_level_t log_level = ESP_LOG_INFO;
+static uint32_t random_state = 0x2545F491;
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static uint64_t start_us;
+
+__attribute__((constructor)) static void host_clock_init(void) { start_us = monotonic_us(); }
+
+uint64_t host_time_us(void) { return monotonic_us() - start_us; }
+
+int64_t esp_timer_get_time(void) { return (int64_t)host_time_us(); }
+
+uint32_t esp_log_timestamp(void) { return (uint32_t)(host_time_us() / 1000); }
+
+void esp_log_level_set(const char* tag, esp_log_level_t level) { log_level = level; }
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+    static const char letters[] = "NEWIDV";
+    if (level > log_level) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    flockfile(stderr);
+    fprintf(stderr, "%c (%lu) %s: ", letters[level], (unsigned long)esp_log_timestamp(), tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    funlockfile(stderr);
+    va_end(args);
+}
+
+void esp_log_buffer_hex_internal(const char* tag, const void* buffer, uint16_t len, esp_log_level_t level) {
+    if (level > log_level) {
+        return;
+    }
+
+    const uint8_t* bytes = buffer;
+    char line[16 * 3 + 1];
+    for (uint16_t off = 0; off < len; off += 16) {
+        size_t n = 0;
+        for (uint16_t i = off; i < len && i < off + 16; i++) {
+            n += (size_t)snprintf(&line[n], sizeof(line) - n, "%02x ", bytes[i]);
+        }
+        esp_log_write(level, tag, "%s", line);
+    }
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:
+            return "ESP_OK";
+        case ESP_FAIL:
+            return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:
+            return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:
+            return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:
+            return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:
+            return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:
+            return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:
+            return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:
+            return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE:
+            return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_NOT_FINISHED:
+            return "ESP_ERR_NOT_FINISHED";
+        default:
+            return "UNKNOWN ERROR";
+    }
+}
+
+uint32_t esp_random(void) {
+    // xorshift32, fixed seed so runs are reproducible
+    uint32_t x = __atomic_load_n(&random_state, __ATOMIC_RELAXED);
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    __atomic_store_n(&random_state, x, __ATOMIC_RELAXED);
+    return x;
+}
+
+void esp_rom_delay_us(uint32_t us) {
+    uint64_t until = host_time_us() + us;
+    while (host_time_us() < until) {
+    }
+}
+
+static void* timer_thread(void* arg) {
+    esp_timer_handle_t timer = arg;
+
+    pthread_mutex_lock(&timer->lock);
+    for (;;) {
+        if (!timer->active) {
+            pthread_cond_wait(&timer->cond, &timer->lock);
+            continue;
+        }
+
+        uint64_t now = host_time_us();
+        if (now < timer->next_us) {
+            uint64_t wait_us = timer->next_us - now;
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            uint64_t ns = (uint64_t)deadline.tv_nsec + wait_us * 1000;
+            deadline.tv_sec += (time_t)(ns / 1000000000);
+            deadline.tv_nsec = (long)(ns % 1000000000);
+            pthread_cond_timedwait(&timer->cond, &timer->lock, &deadline);
+            continue;
+        }
+
+        // Fixed rate like esp_timer, a late callback does not shift the following deadlines
+        if (timer->period_us > 0) {
+            timer->next_us += timer->period_us;
+        } else {
+            timer->active = false;
+        }
+        pthread_mutex_unlock(&timer->lock);
+        timer->callback(timer->arg);
+        pthread_mutex_lock(&timer->lock);
+    }
+    return NULL;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    if (args == NULL || args->callback == NULL || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_timer_handle_t timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_mutex_init(&timer->lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&timer->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+
+    if (pthread_create(&timer->thread, NULL, timer_thread, timer) != 0) {
+        free(timer);
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_detach(timer->thread);
+
+    *out = timer;
+    return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t delay_us, uint64_t period_us) {
+    pthread_mutex_lock(&timer->lock);
+    if (timer->active) {
+        pthread_mutex_unlock(&timer->lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->period_us = period_us;
+    timer->next_us = host_time_us() + delay_us;
+    pthread_cond_broadcast(&timer->cond);
+    pthread_mutex_unlock(&timer->lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    return timer_start(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&timer->lock);
+    bool was_active = timer->active;
+    timer->active = false;
+    pthread_cond_broadcast(&timer->cond);
+    pthread_mutex_unlock(&timer->lock);
+    return was_active ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&timer->lock);
+    bool active = timer->active;
+    pthread_mutex_unlock(&timer->lock);
+    return active;
+}
+
+// No SPI peripheral or GPIO matrix on the host, the driver reaches the radio through nrf24_set_hal
+
+esp_err_t gpio_config(const gpio_config_t* config) { return ESP_ERR_NOT_SUPPORTED; }
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) { return ESP_ERR_NOT_SUPPORTED; }
+
+esp_err_t gpio_install_isr_service(int flags) { return ESP_ERR_NOT_SUPPORTED; }
+
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t handler, void* arg) { return ESP_ERR_NOT_SUPPORTED; }
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* config, int dma) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* config,
+                             spi_device_handle_t* out) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t dev) { return ESP_ERR_NOT_SUPPORTED; }
+
+esp_err_t spi_device_transmit(spi_device_handle_t dev, spi_transaction_t* t) { return ESP_ERR_NOT_SUPPORTED; }
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t dev, spi_transaction_t* t) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t dev, spi_transaction_t* t, uint32_t ticks) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t dev, spi_transaction_t** t, uint32_t ticks) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t spi_device_acquire_bus(spi_device_handle_t dev, uint32_t ticks) { return ESP_ERR_NOT_SUPPORTED; }
+
+void spi_device_release_bus(spi_device_handle_t dev) {}
@@ -0,0 +1,296 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_shim.h"
+
+struct tskTaskControlBlock {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    TaskFunction_t fn;
+    void* arg;
+    const char* name;
+    BaseType_t core;
+    uint32_t notify_value;
+    bool notify_pending;
+};
+
+struct QueueDefinition {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    uint8_t* items;
+};
+
+static pthread_mutex_t critical_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread TaskHandle_t current_task = NULL;
+
+/// @brief Condition variable on the monotonic clock, so timeouts match host_time_us
+static void cond_init(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/// @brief Absolute monotonic time at which a wait of ticks ends
+/// Like FreeRTOS the wait ends on a tick boundary, so it lasts between ticks - 1 and ticks periods
+static struct timespec tick_deadline(TickType_t ticks) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    uint64_t period_us = 1000000 / configTICK_RATE_HZ;
+    uint64_t elapsed_us = host_time_us();
+    uint64_t wait_us = (elapsed_us / period_us + ticks) * period_us - elapsed_us;
+
+    uint64_t ns = (uint64_t)now.tv_nsec + wait_us * 1000;
+    struct timespec deadline = {
+        .tv_sec = now.tv_sec + (time_t)(ns / 1000000000),
+        .tv_nsec = (long)(ns % 1000000000),
+    };
+    return deadline;
+}
+
+/// @brief Waits on a condition with a FreeRTOS timeout, the lock is held on entry and on return
+/// @return false once the timeout expired
+static bool cond_wait_ticks(pthread_cond_t* cond, pthread_mutex_t* lock, TickType_t ticks,
+                            const struct timespec* deadline) {
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+    pthread_mutex_lock(&critical_lock);
+    mux->count++;
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+    mux->count--;
+    pthread_mutex_unlock(&critical_lock);
+}
+
+static TaskHandle_t task_alloc(const char* name, TaskFunction_t fn, void* arg, BaseType_t core) {
+    TaskHandle_t task = calloc(1, sizeof(*task));
+    if (task == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&task->lock, NULL);
+    cond_init(&task->cond);
+    task->name = name;
+    task->fn = fn;
+    task->arg = arg;
+    task->core = core;
+    return task;
+}
+
+static void* task_entry(void* arg) {
+    TaskHandle_t task = arg;
+    current_task = task;
+    task->fn(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* out, BaseType_t core) {
+    TaskHandle_t task = task_alloc(name, fn, arg, core);
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    if (out != NULL) {
+        *out = task;
+    }
+
+    // Tasks run until the process exits, like the firmware's
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t priority,
+                       TaskHandle_t* out) {
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, priority, out, tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    // Threads the shim did not start (the test main thread, timer threads) get a handle on first use
+    if (current_task == NULL) {
+        current_task = task_alloc("host", NULL, NULL, 0);
+    }
+    return current_task;
+}
+
+BaseType_t xPortGetCoreID(void) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    return task->core == tskNO_AFFINITY ? 0 : task->core;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(host_time_us() / (1000000 / configTICK_RATE_HZ));
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        sched_yield();
+        return;
+    }
+
+    struct timespec deadline = tick_deadline(ticks);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+    }
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    pthread_mutex_lock(&task->lock);
+    switch (action) {
+        case eSetBits:
+            task->notify_value |= value;
+            break;
+        case eIncrement:
+            task->notify_value++;
+            break;
+        case eSetValueWithOverwrite:
+        case eSetValueWithoutOverwrite:
+            task->notify_value = value;
+            break;
+        case eNoAction:
+            break;
+    }
+    task->notify_pending = true;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t* woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value, TickType_t ticks) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline = tick_deadline(ticks);
+
+    pthread_mutex_lock(&task->lock);
+    if (!task->notify_pending) {
+        task->notify_value &= ~clear_on_entry;
+    }
+    while (!task->notify_pending && cond_wait_ticks(&task->cond, &task->lock, ticks, &deadline)) {
+    }
+
+    BaseType_t notified = task->notify_pending ? pdTRUE : pdFALSE;
+    if (value != NULL) {
+        *value = task->notify_value;
+    }
+    if (notified) {
+        task->notify_value &= ~clear_on_exit;
+        task->notify_pending = false;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return notified;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    QueueHandle_t queue = calloc(1, sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->items = calloc(length, item_size > 0 ? item_size : 1);
+    if (queue->items == NULL) {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    cond_init(&queue->cond);
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    struct timespec deadline = tick_deadline(ticks);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length && cond_wait_ticks(&queue->cond, &queue->lock, ticks, &deadline)) {
+    }
+    if (queue->count == queue->length) {
+        pthread_mutex_unlock(&queue->lock);
+        return pdFALSE;
+    }
+
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    if (queue->item_size > 0) {
+        memcpy(&queue->items[tail * queue->item_size], item, queue->item_size);
+    }
+    queue->count++;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    struct timespec deadline = tick_deadline(ticks);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && cond_wait_ticks(&queue->cond, &queue->lock, ticks, &deadline)) {
+    }
+    if (queue->count == 0) {
+        pthread_mutex_unlock(&queue->lock);
+        return pdFALSE;
+    }
+
+    if (queue->item_size > 0) {
+        memcpy(item, &queue->items[queue->head * queue->item_size], queue->item_size);
+    }
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks) {
+    struct timespec deadline = tick_deadline(ticks);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && cond_wait_ticks(&queue->cond, &queue->lock, ticks, &deadline)) {
+    }
+    if (queue->count == 0) {
+        pthread_mutex_unlock(&queue->lock);
+        return pdFALSE;
+    }
+
+    if (queue->item_size > 0) {
+        memcpy(item, &queue->items[queue->head * queue->item_size], queue->item_size);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
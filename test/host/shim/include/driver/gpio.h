@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Declarations only, the host build always runs the driver through an installed nrf24_hal_t
+
+typedef int gpio_num_t;
+
+typedef enum {
+    GPIO_MODE_INPUT,
+    GPIO_MODE_OUTPUT,
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_PULLUP_DISABLE,
+    GPIO_PULLUP_ENABLE,
+} gpio_pullup_t;
+
+typedef enum {
+    GPIO_PULLDOWN_DISABLE,
+    GPIO_PULLDOWN_ENABLE,
+} gpio_pulldown_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+} gpio_int_type_t;
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    gpio_pullup_t pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+typedef void (*gpio_isr_t)(void* arg);
+
+esp_err_t gpio_config(const gpio_config_t* config);
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level);
+esp_err_t gpio_install_isr_service(int flags);
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t handler, void* arg);
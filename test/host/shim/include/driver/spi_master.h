@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+
+// Declarations only, the host build always runs the driver through an installed nrf24_hal_t
+
+typedef enum {
+    SPI1_HOST,
+    SPI2_HOST,
+    SPI3_HOST,
+} spi_host_device_t;
+
+typedef struct spi_device_t* spi_device_handle_t;
+
+typedef struct {
+    int miso_io_num;
+    int mosi_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+} spi_bus_config_t;
+
+typedef struct {
+    int clock_speed_hz;
+    uint8_t mode;
+    int spics_io_num;
+    int queue_size;
+    uint32_t flags;
+} spi_device_interface_config_t;
+
+typedef struct {
+    uint32_t flags;
+    size_t length;
+    size_t rxlength;
+    void* user;
+    const void* tx_buffer;
+    void* rx_buffer;
+} spi_transaction_t;
+
+#define SPICOMMON_BUSFLAG_MASTER (1 << 0)
+#define SPI_DMA_CH_AUTO 3
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* config, int dma);
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* config,
+                             spi_device_handle_t* out);
+esp_err_t spi_bus_remove_device(spi_device_handle_t dev);
+esp_err_t spi_device_transmit(spi_device_handle_t dev, spi_transaction_t* t);
+esp_err_t spi_device_polling_transmit(spi_device_handle_t dev, spi_transaction_t* t);
+esp_err_t spi_device_queue_trans(spi_device_handle_t dev, spi_transaction_t* t, uint32_t ticks);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t dev, spi_transaction_t** t, uint32_t ticks);
+esp_err_t spi_device_acquire_bus(spi_device_handle_t dev, uint32_t ticks);
+void spi_device_release_bus(spi_device_handle_t dev);
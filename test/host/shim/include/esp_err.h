@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Host build of the ESP-IDF error codes, same values as esp_err.h
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_NOT_SUPPORTED 0x106
+#define ESP_ERR_TIMEOUT 0x107
+#define ESP_ERR_INVALID_RESPONSE 0x108
+#define ESP_ERR_INVALID_CRC 0x109
+#define ESP_ERR_INVALID_VERSION 0x10A
+#define ESP_ERR_NOT_FINISHED 0x10C
+#define ESP_ERR_NOT_ALLOWED 0x10D
+
+#define BIT64(n) (1ULL << (n))
+#define BIT(n) (1UL << (n))
+#define IRAM_ATTR
+
+const char* esp_err_to_name(esp_err_t code);
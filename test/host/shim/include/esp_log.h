@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+
+// Host build of esp_log, lines go to stderr with the ESP-IDF prefix
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+uint32_t esp_log_timestamp(void);
+void esp_log_level_set(const char* tag, esp_log_level_t level);
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+void esp_log_buffer_hex_internal(const char* tag, const void* buffer, uint16_t len, esp_log_level_t level);
+
+#define ESP_LOGE(tag, format, ...) esp_log_write(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) esp_log_write(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) esp_log_write(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) esp_log_write(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) esp_log_write(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+#define ESP_LOG_BUFFER_HEX_LEVEL(tag, buffer, len, level) esp_log_buffer_hex_internal(tag, buffer, len, level)
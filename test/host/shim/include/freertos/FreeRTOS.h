@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Host build of the FreeRTOS subset the radio driver uses: tasks are pthreads, the tick runs at the firmware's
+// 100 Hz from CLOCK_MONOTONIC, and every portMUX maps to one process wide recursive lock
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+#define configTICK_RATE_HZ 100
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * (uint64_t)configTICK_RATE_HZ) / 1000U))
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define portNUM_PROCESSORS 2
+
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define portYIELD_FROM_ISR(woken) (void)(woken)
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "queue.h"
+
+// A binary semaphore is a one slot queue of empty items, as in FreeRTOS
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+#define xSemaphoreCreateBinary() xQueueCreate(1, 0)
+#define xSemaphoreTake(sem, ticks) xQueueReceive(sem, NULL, ticks)
+#define xSemaphoreGive(sem) xQueueSend(sem, NULL, 0)
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* arg);
+
+typedef enum {
+    eNoAction,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite,
+} eNotifyAction;
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t priority,
+                       TaskHandle_t* out);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* out, BaseType_t core);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xPortGetCoreID(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t* woken);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value, TickType_t ticks);
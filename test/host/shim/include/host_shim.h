@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+// Hooks of the host shim that have no ESP-IDF counterpart
+
+/// @brief Monotonic clock shared by esp_timer, the tick count and the emulated air
+/// @return Microseconds since the process started
+uint64_t host_time_us(void);
+
+/// @brief Forgets every key of the in-memory NVS and zeroes the commit counter
+void host_nvs_reset(void);
+
+/// @brief Number of nvs_commit calls, each one is a flash write on the device
+/// @return Commits since start or the last host_nvs_reset
+uint32_t host_nvs_commits(void);
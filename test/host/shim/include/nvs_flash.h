@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+
+// Host build of the NVS API over an in-memory store, storage/nvs/nvs.c runs unchanged on top of it
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+typedef struct {
+    size_t used_entries;
+    size_t free_entries;
+    size_t total_entries;
+    size_t namespace_count;
+} nvs_stats_t;
+
+#define ESP_ERR_NVS_BASE 0x1100
+#define ESP_ERR_NVS_NOT_FOUND (ESP_ERR_NVS_BASE + 0x02)
+#define ESP_ERR_NVS_INVALID_HANDLE (ESP_ERR_NVS_BASE + 0x07)
+#define ESP_ERR_NVS_INVALID_LENGTH (ESP_ERR_NVS_BASE + 0x0C)
+#define ESP_ERR_NVS_NO_FREE_PAGES (ESP_ERR_NVS_BASE + 0x0D)
+#define ESP_ERR_NVS_NEW_VERSION_FOUND (ESP_ERR_NVS_BASE + 0x10)
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+esp_err_t nvs_get_stats(const char* part_name, nvs_stats_t* stats);
+esp_err_t nvs_open(const char* name, nvs_open_mode_t mode, nvs_handle_t* out);
+void nvs_close(nvs_handle_t handle);
+esp_err_t nvs_commit(nvs_handle_t handle);
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key);
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value);
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char* key, uint8_t* out);
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char* key, uint32_t value);
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char* key, uint32_t* out);
+esp_err_t nvs_set_str(nvs_handle_t handle, const char* key, const char* value);
+esp_err_t nvs_get_str(nvs_handle_t handle, const char* key, char* out, size_t* len);
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t len);
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out, size_t* len);
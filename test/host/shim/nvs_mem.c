@@ -0,0 +1,221 @@
+#include <nvs_flash.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_shim.h"
+
+#define NVS_MEM_NAMESPACES 16
+#define NVS_MEM_ENTRIES 64
+#define NVS_MEM_NAME_LEN 16
+
+typedef enum {
+    NVS_MEM_U8,
+    NVS_MEM_U32,
+    NVS_MEM_STR,
+    NVS_MEM_BLOB,
+} nvs_mem_type_t;
+
+typedef struct {
+    bool used;
+    uint8_t ns;
+    char key[NVS_MEM_NAME_LEN];
+    nvs_mem_type_t type;
+    size_t len;
+    uint8_t* data;
+} nvs_mem_entry_t;
+
+static pthread_mutex_t nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+static char namespaces[NVS_MEM_NAMESPACES][NVS_MEM_NAME_LEN];
+static size_t namespace_count = 0;
+static nvs_mem_entry_t entries[NVS_MEM_ENTRIES];
+static uint32_t commits = 0;
+
+// The host_shim.h hooks are documented there, the NVS API follows ESP-IDF
+
+void host_nvs_reset(void) {
+    pthread_mutex_lock(&nvs_lock);
+    for (size_t i = 0; i < NVS_MEM_ENTRIES; i++) {
+        free(entries[i].data);
+    }
+    memset(entries, 0, sizeof(entries));
+    commits = 0;
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+uint32_t host_nvs_commits(void) {
+    pthread_mutex_lock(&nvs_lock);
+    uint32_t count = commits;
+    pthread_mutex_unlock(&nvs_lock);
+    return count;
+}
+
+/// @brief Entry of a key, the lock is held by the caller
+static nvs_mem_entry_t* entry_find(nvs_handle_t handle, const char* key) {
+    for (size_t i = 0; i < NVS_MEM_ENTRIES; i++) {
+        if (entries[i].used && entries[i].ns == handle && strcmp(entries[i].key, key) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t entry_set(nvs_handle_t handle, const char* key, nvs_mem_type_t type, const void* data, size_t len) {
+    if (handle == 0 || handle > namespace_count) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (key == NULL || strlen(key) >= NVS_MEM_NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&nvs_lock);
+    nvs_mem_entry_t* entry = entry_find(handle, key);
+    for (size_t i = 0; entry == NULL && i < NVS_MEM_ENTRIES; i++) {
+        if (!entries[i].used) {
+            entry = &entries[i];
+        }
+    }
+    if (entry == NULL) {
+        pthread_mutex_unlock(&nvs_lock);
+        return ESP_ERR_NVS_NO_FREE_PAGES;
+    }
+
+    uint8_t* copy = malloc(len > 0 ? len : 1);
+    if (copy == NULL) {
+        pthread_mutex_unlock(&nvs_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, data, len);
+    free(entry->data);
+    entry->used = true;
+    entry->ns = (uint8_t)handle;
+    strcpy(entry->key, key);
+    entry->type = type;
+    entry->len = len;
+    entry->data = copy;
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+/// @brief Copies a value out, len is the buffer size on entry and the stored size on return
+static esp_err_t entry_get(nvs_handle_t handle, const char* key, nvs_mem_type_t type, void* out, size_t* len) {
+    pthread_mutex_lock(&nvs_lock);
+    nvs_mem_entry_t* entry = entry_find(handle, key);
+    if (entry == NULL || entry->type != type) {
+        pthread_mutex_unlock(&nvs_lock);
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    esp_err_t err = ESP_OK;
+    if (out != NULL) {
+        if (*len < entry->len) {
+            err = ESP_ERR_NVS_INVALID_LENGTH;
+        } else {
+            memcpy(out, entry->data, entry->len);
+        }
+    }
+    *len = entry->len;
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_flash_init(void) { return ESP_OK; }
+
+esp_err_t nvs_flash_erase(void) {
+    host_nvs_reset();
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_stats(const char* part_name, nvs_stats_t* stats) {
+    pthread_mutex_lock(&nvs_lock);
+    size_t used = 0;
+    for (size_t i = 0; i < NVS_MEM_ENTRIES; i++) {
+        used += entries[i].used ? 1 : 0;
+    }
+    *stats = (nvs_stats_t){
+        .used_entries = used,
+        .free_entries = NVS_MEM_ENTRIES - used,
+        .total_entries = NVS_MEM_ENTRIES,
+        .namespace_count = namespace_count,
+    };
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t mode, nvs_handle_t* out) {
+    if (name == NULL || strlen(name) >= NVS_MEM_NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&nvs_lock);
+    size_t ns = 0;
+    while (ns < namespace_count && strcmp(namespaces[ns], name) != 0) {
+        ns++;
+    }
+    if (ns == namespace_count) {
+        if (mode == NVS_READONLY || namespace_count == NVS_MEM_NAMESPACES) {
+            pthread_mutex_unlock(&nvs_lock);
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+        strcpy(namespaces[namespace_count++], name);
+    }
+    pthread_mutex_unlock(&nvs_lock);
+
+    *out = (nvs_handle_t)(ns + 1);
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    pthread_mutex_lock(&nvs_lock);
+    commits++;
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key) {
+    pthread_mutex_lock(&nvs_lock);
+    nvs_mem_entry_t* entry = entry_find(handle, key);
+    if (entry != NULL) {
+        free(entry->data);
+        memset(entry, 0, sizeof(*entry));
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return entry != NULL ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value) {
+    return entry_set(handle, key, NVS_MEM_U8, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char* key, uint8_t* out) {
+    size_t len = sizeof(*out);
+    return entry_get(handle, key, NVS_MEM_U8, out, &len);
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char* key, uint32_t value) {
+    return entry_set(handle, key, NVS_MEM_U32, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char* key, uint32_t* out) {
+    size_t len = sizeof(*out);
+    return entry_get(handle, key, NVS_MEM_U32, out, &len);
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char* key, const char* value) {
+    return entry_set(handle, key, NVS_MEM_STR, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char* key, char* out, size_t* len) {
+    return entry_get(handle, key, NVS_MEM_STR, out, len);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t len) {
+    return entry_set(handle, key, NVS_MEM_BLOB, value, len);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out, size_t* len) {
+    return entry_get(handle, key, NVS_MEM_BLOB, out, len);
+}
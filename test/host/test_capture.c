@@ -0,0 +1,163 @@
+#include <string.h>
+
+#include "host_test.h"
+#include "nrf24_capture.h"
+
+// The raw capture ring and its pcap export: file layout, oldest first order after a wrap, and the frozen ring.
+// The ring is process wide, each test records enough to know what the export must hold
+
+#define TEST_PCAP_HEADER_LEN 24
+#define TEST_RECORD_HEADER_LEN 16
+#define TEST_RECORD_DATA_LEN (3 + NRF24_CAPTURE_PAYLOAD_LEN)
+#define TEST_PCAP_MAX (TEST_PCAP_HEADER_LEN + NRF24_CAPTURE_CAPACITY * sizeof(nrf24_capture_record_t))
+
+typedef struct {
+    uint8_t data[TEST_PCAP_MAX];
+    size_t len;
+    int calls;
+    int fail_at;         // Sink call that returns an error, 0 for none
+    bool record_during;  // Records a payload and tries a nested export from inside the sink
+    esp_err_t nested;
+} test_sink_t;
+
+static esp_err_t test_sink(void* ctx, const void* data, size_t len) {
+    test_sink_t* sink = ctx;
+    sink->calls++;
+    if (sink->calls == sink->fail_at) {
+        return ESP_FAIL;
+    }
+    if (sink->record_during) {
+        uint8_t payload[NRF24_CAPTURE_PAYLOAD_LEN] = {0};
+        nrf24_capture_record(99, 0, NRF24_CAPTURE_UNDECODED, payload);
+        sink->nested = nrf24_capture_export(test_sink, sink);
+    }
+    if (sink->len + len > sizeof(sink->data)) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+    return ESP_OK;
+}
+
+static uint32_t test_read_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/// @brief Records count payloads tagged with consecutive numbers in their first four bytes
+static void test_record_tagged(uint32_t first_tag, uint32_t count) {
+    for (uint32_t tag = first_tag; tag < first_tag + count; tag++) {
+        uint8_t payload[NRF24_CAPTURE_PAYLOAD_LEN];
+        memset(payload, 0x5A, sizeof(payload));
+        memcpy(payload, &tag, sizeof(tag));
+        nrf24_capture_record((uint8_t)(tag % 126), (uint8_t)(tag % 6),
+                             (tag & 1) ? NRF24_CAPTURE_XIAOMI : NRF24_CAPTURE_UNDECODED, payload);
+    }
+}
+
+/// @brief Walks the exported file like a pcap reader and checks every record carries the expected tag
+/// @return Number of records found
+static uint32_t test_check_records(const test_sink_t* sink, uint32_t first_tag) {
+    size_t off = TEST_PCAP_HEADER_LEN;
+    uint32_t count = 0;
+    uint64_t last_us = 0;
+    while (off + TEST_RECORD_HEADER_LEN <= sink->len) {
+        const uint8_t* rec = sink->data + off;
+        uint64_t ts_us = (uint64_t)test_read_u32(rec) * 1000000 + test_read_u32(rec + 4);
+        uint32_t incl_len = test_read_u32(rec + 8);
+        CHECK_EQ(incl_len, TEST_RECORD_DATA_LEN);
+        CHECK_EQ(test_read_u32(rec + 12), TEST_RECORD_DATA_LEN);
+        CHECK(ts_us >= last_us);
+        CHECK(test_read_u32(rec + 4) < 1000000);
+        last_us = ts_us;
+
+        uint32_t tag = first_tag + count;
+        const uint8_t* data = rec + TEST_RECORD_HEADER_LEN;
+        CHECK_EQ(data[0], tag % 126);
+        CHECK_EQ(data[1], (tag & 1) ? NRF24_CAPTURE_XIAOMI : NRF24_CAPTURE_UNDECODED);
+        CHECK_EQ(data[2], tag % 6);
+        CHECK_EQ(test_read_u32(data + 3), tag);
+        CHECK_EQ(data[3 + NRF24_CAPTURE_PAYLOAD_LEN - 1], 0x5A);
+
+        off += TEST_RECORD_HEADER_LEN + incl_len;
+        count++;
+    }
+    CHECK_EQ(off, sink->len);
+    return count;
+}
+
+static void test_empty_ring_exports_header(void) {
+    static test_sink_t sink;
+    CHECK_EQ(nrf24_capture_export(NULL, NULL), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(nrf24_capture_export(test_sink, &sink), ESP_OK);
+    CHECK_EQ(sink.calls, 1);
+    CHECK_EQ(sink.len, TEST_PCAP_HEADER_LEN);
+    CHECK_EQ(test_read_u32(sink.data), 0xA1B2C3D4);
+    CHECK_EQ(sink.data[4], 2);
+    CHECK_EQ(sink.data[6], 4);
+    CHECK_EQ(test_read_u32(sink.data + 16), TEST_RECORD_DATA_LEN);
+    CHECK_EQ(test_read_u32(sink.data + 20), NRF24_CAPTURE_LINKTYPE);
+}
+
+static void test_export_layout(void) {
+    // The ring is still empty, the records land in slots 0..4
+    CHECK_EQ(sizeof(nrf24_capture_record_t), TEST_RECORD_HEADER_LEN + TEST_RECORD_DATA_LEN);
+    test_record_tagged(0, 5);
+
+    static test_sink_t sink;
+    CHECK_EQ(nrf24_capture_export(test_sink, &sink), ESP_OK);
+    CHECK_EQ(sink.calls, 2);
+    CHECK_EQ(test_check_records(&sink, 0), 5);
+
+    nrf24_capture_stats_t stats;
+    nrf24_capture_get_stats(&stats);
+    CHECK_EQ(stats.captured, 5);
+    CHECK_EQ(stats.dropped, 0);
+}
+
+static void test_wrapped_ring_exports_oldest_first(void) {
+    nrf24_capture_stats_t stats;
+    nrf24_capture_get_stats(&stats);
+    uint32_t first = stats.captured;
+    uint32_t total = NRF24_CAPTURE_CAPACITY + 37;
+    test_record_tagged(first, total);
+
+    static test_sink_t sink;
+    CHECK_EQ(nrf24_capture_export(test_sink, &sink), ESP_OK);
+    // Header, then the run up to the end of the array and the run from its start
+    CHECK_EQ(sink.calls, 3);
+    CHECK_EQ(test_check_records(&sink, first + total - NRF24_CAPTURE_CAPACITY), NRF24_CAPTURE_CAPACITY);
+}
+
+static void test_export_freezes_ring(void) {
+    nrf24_capture_stats_t before;
+    nrf24_capture_get_stats(&before);
+
+    // Records written while the sink runs are dropped and a second export is turned away
+    static test_sink_t sink;
+    sink.record_during = true;
+    CHECK_EQ(nrf24_capture_export(test_sink, &sink), ESP_OK);
+    CHECK_EQ(sink.nested, ESP_ERR_INVALID_STATE);
+    CHECK_EQ(test_check_records(&sink, before.captured - NRF24_CAPTURE_CAPACITY), NRF24_CAPTURE_CAPACITY);
+
+    nrf24_capture_stats_t after;
+    nrf24_capture_get_stats(&after);
+    CHECK_EQ(after.captured, before.captured);
+    CHECK_EQ(after.dropped, before.dropped + sink.calls);
+
+    // A failing sink reports its error and still thaws the ring
+    static test_sink_t failing;
+    failing.fail_at = 2;
+    CHECK_EQ(nrf24_capture_export(test_sink, &failing), ESP_FAIL);
+    test_record_tagged(after.captured, 1);
+    nrf24_capture_get_stats(&after);
+    CHECK_EQ(after.captured, before.captured + 1);
+    CHECK_EQ(after.dropped, before.dropped + sink.calls);
+}
+
+int main(void) {
+    RUN_TEST(test_empty_ring_exports_header);
+    RUN_TEST(test_export_layout);
+    RUN_TEST(test_wrapped_ring_exports_oldest_first);
+    RUN_TEST(test_export_freezes_ring);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,251 @@
+#include <string.h>
+
+#include "codec_reference.h"
+#include "host_test.h"
+#include "xiaomi_codec.h"
+
+// The Xiaomi codec against fixed vectors and against the brute-force decoder it replaced
+
+#define TEST_RANDOM_RUNS 20000
+#define TEST_RAW_MAX 40
+
+static uint32_t test_random_state = 0x1F123BB5;
+
+static uint32_t test_random(void) {
+    test_random_state ^= test_random_state << 13;
+    test_random_state ^= test_random_state >> 17;
+    test_random_state ^= test_random_state << 5;
+    return test_random_state;
+}
+
+static void test_random_fill(uint8_t* buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)test_random();
+    }
+}
+
+/// @brief Overwrites len bytes worth of bits of buf, starting at bit_off (MSB first)
+static void test_write_bits(uint8_t* buf, size_t bit_off, const uint8_t* src, size_t len) {
+    for (size_t i = 0; i < len * 8; i++) {
+        size_t bit = bit_off + i;
+        uint8_t mask = (uint8_t)(0x80 >> (bit & 7));
+        if ((src[i >> 3] >> (7 - (i & 7))) & 1) {
+            buf[bit >> 3] |= mask;
+        } else {
+            buf[bit >> 3] &= (uint8_t)~mask;
+        }
+    }
+}
+
+/// @brief Plaintext frame, the whitened frame of the builder with the whitening removed
+static void test_plain_frame(uint32_t id, uint8_t seq, uint8_t cmd, uint8_t param, uint8_t* out) {
+    xiaomi_build_frame(id, seq, cmd, param, out);
+    for (size_t i = 0; i < XIAOMI_FRAME_LEN; i++) {
+        out[i] ^= reference_whitening[i];
+    }
+}
+
+// Remote 701634, seq 2A, power toggle, byte aligned
+static const uint8_t vector_aligned[XIAOMI_FRAME_LEN] = {0x53, 0x39, 0x14, 0xDD, 0x1C, 0x49, 0x34, 0x12, 0x70,
+                                                         0x16, 0x34, 0xFF, 0x2A, 0x80, 0x3C, 0x64, 0x87, 0x00};
+
+// Remote ABCDEF, seq 07, lower by 3, behind 19 bits of sync as the sniffer's AA address sees it
+static const uint8_t vector_shifted[32] = {0xAA, 0xAA, 0xAA, 0x67, 0x22, 0x9B, 0xA3, 0x89, 0x26, 0x82, 0x55,
+                                           0x79, 0xBD, 0xFF, 0xE0, 0xE0, 0x7F, 0xB2, 0x3F, 0x80, 0x00, 0x00,
+                                           0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+static void test_crc_matches_bitwise(void) {
+    uint8_t data[TEST_RAW_MAX];
+    for (int run = 0; run < 1000; run++) {
+        size_t len = test_random() % (TEST_RAW_MAX + 1);
+        test_random_fill(data, len);
+        CHECK_EQ(xiaomi_crc16(data, len), reference_crc16(data, len));
+    }
+}
+
+static void test_build_matches_reference(void) {
+    for (int run = 0; run < 1000; run++) {
+        uint32_t id = test_random() & 0xFFFFFF;
+        uint8_t seq = (uint8_t)test_random();
+        uint8_t cmd = (uint8_t)test_random();
+        uint8_t param = (uint8_t)test_random();
+
+        uint8_t expected[XIAOMI_FRAME_LEN];
+        uint8_t built[XIAOMI_FRAME_LEN];
+        uint8_t from_template[XIAOMI_FRAME_LEN];
+        xiaomi_template_t tpl;
+        CHECK(reference_build_frame(id, seq, cmd, param, expected));
+        CHECK(xiaomi_build_frame(id, seq, cmd, param, built));
+        CHECK(xiaomi_template_init(&tpl, id));
+        xiaomi_template_build(&tpl, seq, cmd, param, from_template);
+        CHECK(memcmp(built, expected, XIAOMI_FRAME_LEN) == 0);
+        CHECK(memcmp(from_template, expected, XIAOMI_FRAME_LEN) == 0);
+    }
+
+    uint8_t out[XIAOMI_FRAME_LEN];
+    CHECK(!xiaomi_build_frame(0x1000000, 0, 0, 0, out));
+    CHECK(!xiaomi_build_frame(0x701634, 0, 0, 0, NULL));
+}
+
+static void test_decode_vectors(void) {
+    xiaomi_frame_t frame;
+    CHECK(xiaomi_decode(vector_aligned, sizeof(vector_aligned), &frame));
+    CHECK_EQ(frame.id, 0x701634);
+    CHECK_EQ(frame.seq, 0x2A);
+    CHECK_EQ(frame.cmd, 0x80);
+    CHECK_EQ(frame.param, 0x3C);
+
+    // The padding byte is not checked, a frame cut right after its CRC still decodes
+    CHECK(xiaomi_decode(vector_aligned, XIAOMI_FRAME_LEN - 1, &frame));
+    CHECK(!xiaomi_decode(vector_aligned, XIAOMI_FRAME_LEN - 2, &frame));
+
+    CHECK(xiaomi_decode(vector_shifted, sizeof(vector_shifted), &frame));
+    CHECK_EQ(frame.id, 0xABCDEF);
+    CHECK_EQ(frame.seq, 0x07);
+    CHECK_EQ(frame.cmd, 0x03);
+    CHECK_EQ(frame.param, 0xFD);
+
+    uint8_t raw[32];
+    memcpy(raw, vector_aligned, sizeof(vector_aligned));
+    raw[16] ^= 0x01;
+    CHECK(!xiaomi_decode(raw, sizeof(vector_aligned), &frame));
+
+    // A separator other than FF is rejected even with a matching CRC
+    memcpy(raw, vector_aligned, sizeof(vector_aligned));
+    raw[11] = 0xFE;
+    uint16_t crc = xiaomi_crc16(raw, 15);
+    raw[15] = (uint8_t)(crc >> 8);
+    raw[16] = (uint8_t)crc;
+    CHECK(!xiaomi_decode(raw, sizeof(vector_aligned), &frame));
+
+    memset(raw, 0, sizeof(raw));
+    CHECK(!xiaomi_decode(raw, sizeof(raw), &frame));
+    CHECK(!xiaomi_decode(NULL, sizeof(raw), &frame));
+    CHECK(!xiaomi_decode(raw, sizeof(raw), NULL));
+}
+
+static void test_decode_matches_reference(void) {
+    for (int run = 0; run < TEST_RANDOM_RUNS; run++) {
+        uint8_t raw[TEST_RAW_MAX];
+        size_t len = XIAOMI_FRAME_LEN - 1 + test_random() % (TEST_RAW_MAX - XIAOMI_FRAME_LEN + 2);
+        test_random_fill(raw, len);
+
+        // Most buffers carry a frame at a random bit offset, some of them one flipped bit, the rest is noise
+        uint32_t kind = test_random() % 4;
+        if (kind != 0) {
+            uint8_t plain[XIAOMI_FRAME_LEN];
+            test_plain_frame(test_random() & 0xFFFFFF, (uint8_t)test_random(), (uint8_t)test_random(),
+                             (uint8_t)test_random(), plain);
+            // The frame without its padding byte must fit in the buffer
+            size_t bit_off = test_random() % ((len - (XIAOMI_FRAME_LEN - 1)) * 8 + 1);
+            test_write_bits(raw, bit_off, plain, XIAOMI_FRAME_LEN - 1);
+            if (kind == 3) {
+                size_t bit = bit_off + test_random() % ((XIAOMI_FRAME_LEN - 1) * 8);
+                raw[bit >> 3] ^= (uint8_t)(0x80 >> (bit & 7));
+            }
+        }
+
+        xiaomi_frame_t expected = {0};
+        xiaomi_frame_t frame = {0};
+        bool expected_ok = reference_decode(raw, len, &expected);
+        bool ok = xiaomi_decode(raw, len, &frame);
+        CHECK_EQ(ok, expected_ok);
+        if (ok && expected_ok) {
+            CHECK_EQ(frame.id, expected.id);
+            CHECK_EQ(frame.seq, expected.seq);
+            CHECK_EQ(frame.cmd, expected.cmd);
+            CHECK_EQ(frame.param, expected.param);
+        }
+        if (kind == 1 || kind == 2) {
+            CHECK(expected_ok);
+        }
+    }
+}
+
+static void test_plaintext_round_trip(void) {
+    uint8_t raw[32];
+    const size_t max_off = (sizeof(raw) - XIAOMI_FRAME_LEN) * 8;
+
+    for (size_t bit_off = 0; bit_off <= max_off; bit_off++) {
+        uint32_t id = test_random() & 0xFFFFFF;
+        uint8_t seq = (uint8_t)test_random();
+        uint8_t cmd = (uint8_t)test_random();
+        uint8_t param = (uint8_t)test_random();
+        uint8_t plain[XIAOMI_FRAME_LEN];
+        test_plain_frame(id, seq, cmd, param, plain);
+
+        memset(raw, 0xAA, sizeof(raw));
+        test_write_bits(raw, bit_off, plain, sizeof(plain));
+
+        xiaomi_frame_t frame = {0};
+        CHECK(xiaomi_decode(raw, sizeof(raw), &frame));
+        CHECK_EQ(frame.id, id);
+        CHECK_EQ(frame.seq, seq);
+        CHECK_EQ(frame.cmd, cmd);
+        CHECK_EQ(frame.param, param);
+    }
+}
+
+static void test_whitened_frame_rejected(void) {
+    // The whitening mask of the preamble is the preamble shifted by one bit, so our own frames carry the plaintext
+    // preamble one bit late and often pass the CRC there (a toggle of 123456 read back as remote B452F0)
+    for (int run = 0; run < TEST_RANDOM_RUNS; run++) {
+        uint32_t id = (run == 0) ? 0x123456 : test_random() & 0xFFFFFF;
+        const xiaomi_action_t action = {
+            .command = (run == 0) ? XIAOMI_CMD_POWER_TOGGLE : (uint8_t)(test_random() % XIAOMI_CMD_COUNT),
+            .step = (uint8_t)(1 + test_random() % XIAOMI_STEP_MAX),
+        };
+        uint8_t cmd = 0;
+        uint8_t param = 0;
+        uint8_t whitened[XIAOMI_FRAME_LEN];
+        CHECK(xiaomi_command_encode(&action, &cmd, &param));
+        CHECK(xiaomi_build_frame(id, (run == 0) ? 0x42 : (uint8_t)test_random(), cmd, param, whitened));
+
+        xiaomi_frame_t frame = {0};
+        CHECK(!xiaomi_decode(whitened, sizeof(whitened), &frame));
+
+        uint8_t raw[32];
+        size_t bit_off = test_random() % ((sizeof(raw) - XIAOMI_FRAME_LEN) * 8 + 1);
+        memset(raw, 0xAA, sizeof(raw));
+        test_write_bits(raw, bit_off, whitened, sizeof(whitened));
+        CHECK(!xiaomi_decode(raw, sizeof(raw), &frame));
+    }
+}
+
+static void test_command_round_trip(void) {
+    for (int command = 0; command < XIAOMI_CMD_COUNT; command++) {
+        for (uint8_t step = 1; step <= XIAOMI_STEP_MAX; step++) {
+            const xiaomi_action_t action = {.command = (uint8_t)command, .step = step};
+            uint8_t cmd = 0;
+            uint8_t param = 0;
+            CHECK(xiaomi_command_encode(&action, &cmd, &param));
+
+            xiaomi_action_t decoded = {0};
+            CHECK(xiaomi_command_decode(cmd, param, &decoded));
+            CHECK_EQ(decoded.command, command);
+            bool stepped = command != XIAOMI_CMD_POWER_TOGGLE && command != XIAOMI_CMD_RESET;
+            CHECK_EQ(decoded.step, stepped ? step : 0);
+
+            xiaomi_command_t named;
+            CHECK(xiaomi_command_from_name(xiaomi_command_name((xiaomi_command_t)command), &named));
+            CHECK_EQ(named, command);
+        }
+    }
+
+    const xiaomi_action_t too_far = {.command = XIAOMI_CMD_HIGHER, .step = XIAOMI_STEP_MAX + 1};
+    uint8_t cmd = 0;
+    uint8_t param = 0;
+    CHECK(!xiaomi_command_encode(&too_far, &cmd, &param));
+    CHECK_EQ(xiaomi_command_classify(0x55, 0x00), -1);
+}
+
+int main(void) {
+    RUN_TEST(test_crc_matches_bitwise);
+    RUN_TEST(test_build_matches_reference);
+    RUN_TEST(test_decode_vectors);
+    RUN_TEST(test_decode_matches_reference);
+    RUN_TEST(test_plaintext_round_trip);
+    RUN_TEST(test_whitened_frame_rejected);
+    RUN_TEST(test_command_round_trip);
+    return HOST_TEST_RESULT();
+}
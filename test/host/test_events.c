@@ -0,0 +1,144 @@
+#include <unistd.h>
+
+#include "host_test.h"
+#include "xiaomi_events.h"
+
+// The remote event ring: (id, seq) dedup, the read cursor and what a reader sees once the ring wrapped.
+// The ring is process wide, each test works from the head it finds
+
+#define TEST_DEDUP_WINDOW_MS 1500
+#define TEST_DEDUP_SLOTS 8
+
+static xiaomi_frame_t test_frame(uint32_t id, uint8_t seq) {
+    return (xiaomi_frame_t){.id = id, .seq = seq, .cmd = 0x01, .param = seq};
+}
+
+static void test_copies_of_one_press_dedup(void) {
+    uint32_t head = xiaomi_events_head();
+    xiaomi_frame_t press = test_frame(0x123456, 0x10);
+
+    CHECK(xiaomi_events_push(&press, 10));
+    // Every channel of every pass repeats the press
+    for (int i = 0; i < 20; i++) {
+        CHECK(!xiaomi_events_push(&press, (uint8_t)(10 + i)));
+    }
+    CHECK_EQ(xiaomi_events_head(), head + 1);
+
+    // The next press of the same remote and the same seq of another remote are new
+    xiaomi_frame_t next = test_frame(0x123456, 0x11);
+    xiaomi_frame_t other = test_frame(0x654321, 0x10);
+    CHECK(xiaomi_events_push(&next, 10));
+    CHECK(xiaomi_events_push(&other, 10));
+    CHECK(!xiaomi_events_push(&press, 11));
+    CHECK_EQ(xiaomi_events_head(), head + 3);
+
+    xiaomi_event_t out[4];
+    uint32_t cursor = 0;
+    CHECK_EQ(xiaomi_events_read(head, out, 4, &cursor), 3);
+    CHECK_EQ(cursor, head + 3);
+    CHECK_EQ(out[0].index, head);
+    CHECK_EQ(out[0].remote_id, 0x123456);
+    CHECK_EQ(out[0].seq, 0x10);
+    CHECK_EQ(out[0].channel, 10);
+    CHECK_EQ(out[1].seq, 0x11);
+    CHECK_EQ(out[2].remote_id, 0x654321);
+}
+
+static void test_repeat_after_window_is_new(void) {
+    xiaomi_frame_t press = test_frame(0xABCDEF, 0x20);
+    uint32_t head = xiaomi_events_head();
+
+    CHECK(xiaomi_events_push(&press, 20));
+    usleep((TEST_DEDUP_WINDOW_MS / 2) * 1000);
+    CHECK(!xiaomi_events_push(&press, 20));
+
+    // Copies refresh the slot, the window runs from the last copy and not from the first
+    usleep((TEST_DEDUP_WINDOW_MS / 2 + 200) * 1000);
+    CHECK(!xiaomi_events_push(&press, 20));
+    usleep((TEST_DEDUP_WINDOW_MS + 100) * 1000);
+    CHECK(xiaomi_events_push(&press, 20));
+    CHECK_EQ(xiaomi_events_head(), head + 2);
+}
+
+static void test_least_recent_press_is_forgotten(void) {
+    uint32_t head = xiaomi_events_head();
+
+    // Spread in time so the LRU order is strict
+    for (uint8_t seq = 0; seq <= TEST_DEDUP_SLOTS; seq++) {
+        xiaomi_frame_t press = test_frame(0x0A0B0C, seq);
+        CHECK(xiaomi_events_push(&press, 30));
+        usleep(2 * 1000);
+    }
+    CHECK_EQ(xiaomi_events_head(), head + TEST_DEDUP_SLOTS + 1);
+
+    // The ninth press took the slot of the first, the second is still remembered
+    xiaomi_frame_t first = test_frame(0x0A0B0C, 0);
+    xiaomi_frame_t second = test_frame(0x0A0B0C, 1);
+    CHECK(!xiaomi_events_push(&second, 30));
+    CHECK(xiaomi_events_push(&first, 30));
+    CHECK_EQ(xiaomi_events_head(), head + TEST_DEDUP_SLOTS + 2);
+}
+
+static void test_read_in_pieces(void) {
+    uint32_t head = xiaomi_events_head();
+    for (uint8_t seq = 0; seq < 10; seq++) {
+        xiaomi_frame_t press = test_frame(0x111111, seq);
+        CHECK(xiaomi_events_push(&press, 40));
+    }
+
+    xiaomi_event_t out[4];
+    uint32_t cursor = head;
+    uint32_t expected = head;
+    size_t count;
+    while ((count = xiaomi_events_read(cursor, out, 4, &cursor)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            CHECK_EQ(out[i].index, expected);
+            CHECK_EQ(out[i].seq, expected - head);
+            expected++;
+        }
+    }
+    CHECK_EQ(expected, head + 10);
+    CHECK_EQ(cursor, head + 10);
+
+    // Caught up: nothing to copy and the cursor stays put
+    CHECK_EQ(xiaomi_events_read(cursor, out, 4, &cursor), 0);
+    CHECK_EQ(cursor, head + 10);
+}
+
+static void test_wrapped_ring_reads_from_oldest(void) {
+    uint32_t head = xiaomi_events_head();
+    for (uint32_t i = 0; i < XIAOMI_EVENTS_CAPACITY + 10; i++) {
+        xiaomi_frame_t press = test_frame(0x200000 + i, 0);
+        CHECK(xiaomi_events_push(&press, 50));
+    }
+    uint32_t now = xiaomi_events_head();
+    uint32_t oldest = now - XIAOMI_EVENTS_CAPACITY;
+    CHECK(oldest > head);
+
+    static xiaomi_event_t out[XIAOMI_EVENTS_CAPACITY + 1];
+    uint32_t cursor = 0;
+
+    // A reader that fell behind gets the oldest kept event, out[0].index > since tells it events were lost
+    CHECK_EQ(xiaomi_events_read(head, out, XIAOMI_EVENTS_CAPACITY + 1, &cursor), XIAOMI_EVENTS_CAPACITY);
+    CHECK_EQ(out[0].index, oldest);
+    CHECK(out[0].index > head);
+    CHECK_EQ(out[0].remote_id, 0x200000 + (oldest - head));
+    CHECK_EQ(out[XIAOMI_EVENTS_CAPACITY - 1].index, now - 1);
+    CHECK_EQ(cursor, now);
+
+    // 0 and a cursor from the future both mean everything still in the ring
+    CHECK_EQ(xiaomi_events_read(0, out, 1, &cursor), 1);
+    CHECK_EQ(out[0].index, oldest);
+    CHECK_EQ(cursor, oldest + 1);
+    CHECK_EQ(xiaomi_events_read(now + 100, out, 1, &cursor), 1);
+    CHECK_EQ(out[0].index, oldest);
+}
+
+int main(void) {
+    RUN_TEST(test_copies_of_one_press_dedup);
+    RUN_TEST(test_repeat_after_window_is_new);
+    RUN_TEST(test_least_recent_press_is_forgotten);
+    RUN_TEST(test_read_in_pieces);
+    RUN_TEST(test_wrapped_ring_reads_from_oldest);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,527 @@
+#include <string.h>
+#include <unistd.h>
+
+#include <esp_log.h>
+
+#include "host_shim.h"
+#include "host_test.h"
+#include "nrf24.h"
+#include "nrf24_trace.h"
+#include "nvs.h"
+#include "radio_harness.h"
+#include "xiaomi_codec.h"
+#include "xiaomi_state.h"
+
+// The nrf24 driver end to end on the model: connection check, survey settings, scan of an emulated remote, the
+// remote a background scan stores, scan of a single long press, scan strategies against a remote on one channel,
+// RX_DR through the IRQ line, payloads routed by the multi-pipe profile, a send preempting a scan, trace export,
+// send to an emulated light bar, power state after a blind toggle, a send given up before it reached the radio,
+// sequence reservation of a hold and what ends one
+
+#define TEST_REMOTE_ID 0x701634
+// A burst queued during a scan must reach the radio within one scan dwell (20 ms), not after the scan
+#define TEST_PREEMPT_SCAN_MS 800
+#define TEST_PREEMPT_DWELL_MS 20
+#define TEST_PREEMPT_WAIT_MAX_US (TEST_PREEMPT_DWELL_MS * 1000)
+
+static const uint8_t xiaomi_channels[] = {6, 15, 43, 68};
+
+static harness_remote_t test_remote(void) {
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    harness_remote_t remote = {
+        .id = TEST_REMOTE_ID,
+        .channel_count = sizeof(xiaomi_channels),
+        .press_ms = 150,
+        .gap_ms = 100,
+        .repeat_us = 250,
+    };
+    memcpy(remote.channels, xiaomi_channels, sizeof(xiaomi_channels));
+    xiaomi_command_encode(&toggle, &remote.cmd, &remote.param);
+    return remote;
+}
+
+static void test_check_connection(void) {
+    CHECK_EQ(nrf24_check_connection(), ESP_OK);
+
+    nrf24_health_t health;
+    nrf24_get_health(&health);
+    CHECK(health.connected);
+    CHECK_EQ(health.verdict, NRF24_HEALTH_OK);
+}
+
+static void test_survey_opt_in(void) {
+    nrf24_survey_t survey;
+    nrf24_get_survey(&survey);
+    CHECK(!survey.enabled);
+
+    bool stored = false;
+    CHECK_EQ(nrf24_survey_enable(true), ESP_OK);
+    nrf24_get_survey(&survey);
+    CHECK(survey.enabled);
+    CHECK(nvs_load_nrf24_survey(&stored));
+    CHECK(stored);
+
+    // One channel per step, a sweep over the 126 channels takes about 1.3 s
+    for (int i = 0; i < 40 && survey.sweeps == 0; i++) {
+        usleep(100 * 1000);
+        nrf24_get_survey(&survey);
+    }
+    CHECK(survey.sweeps > 0);
+
+    CHECK_EQ(nrf24_survey_enable(false), ESP_OK);
+    nrf24_get_survey(&survey);
+    CHECK(!survey.enabled);
+    CHECK(nvs_load_nrf24_survey(&stored));
+    CHECK(!stored);
+}
+
+static void test_scan_decodes_remote(void) {
+    harness_remote_t remote = test_remote();
+    CHECK(harness_remote_start(&remote));
+    esp_err_t err = nrf24_scan_xiaomi(3000, NULL);
+    harness_remote_stop_all();
+
+    const xiaomi_scan_result_t* result = nrf24_get_last_scan_result();
+    CHECK_EQ(err, ESP_OK);
+    CHECK(result->id_found);
+    CHECK(result->confirmed);
+    CHECK_EQ(result->remote_id, TEST_REMOTE_ID);
+    CHECK(result->found_count >= NRF24_SCAN_CONFIRM_FRAMES_DEFAULT);
+    CHECK(result->commands_mask & (1U << XIAOMI_CMD_POWER_TOGGLE));
+}
+
+static void test_scan_start_saves_remote(void) {
+    CHECK(nvs_save_xiaomi_id("0x000000"));
+    harness_remote_t remote = test_remote();
+    CHECK(harness_remote_start(&remote));
+    uint32_t scan_id = 0;
+    CHECK_EQ(nrf24_scan_start(3000, NULL, &scan_id), ESP_OK);
+
+    // The radio task stores the remote when the scan completes, no status poll is needed for it
+    uint32_t commits = host_nvs_commits();
+    for (int i = 0; i < 400 && host_nvs_commits() == commits; i++) {
+        usleep(10 * 1000);
+    }
+    harness_remote_stop_all();
+    char stored[16] = "";
+    CHECK(nvs_load_xiaomi_id(stored, sizeof(stored)));
+    CHECK(strcmp(stored, "0x701634") == 0);
+
+    nrf24_scan_status_t status;
+    CHECK_EQ(nrf24_scan_get_status(scan_id, &status), ESP_OK);
+    CHECK(status.done);
+    CHECK(status.scan.id_saved);
+
+    // Polls of the finished scan do not write again
+    commits = host_nvs_commits();
+    CHECK_EQ(nrf24_scan_get_status(scan_id, &status), ESP_OK);
+    CHECK_EQ(host_nvs_commits(), commits);
+}
+
+static void test_scan_counts_presses(void) {
+    // One long press repeats a single sequence number on every channel, however many frames that makes it is one
+    // press and the remote stays unconfirmed
+    harness_remote_t remote = test_remote();
+    remote.press_ms = 5000;
+    CHECK(harness_remote_start(&remote));
+    nrf24_scan_options_t options;
+    nrf24_scan_options_default(&options);
+    options.rule.channels = 0;
+    esp_err_t err = nrf24_scan_xiaomi(600, &options);
+    harness_remote_stop_all();
+
+    const xiaomi_scan_result_t* result = nrf24_get_last_scan_result();
+    CHECK_EQ(err, ESP_OK);
+    CHECK(result->id_found);
+    CHECK(!result->confirmed);
+    CHECK(result->found_count >= NRF24_SCAN_CONFIRM_FRAMES_DEFAULT);
+}
+
+/// @brief Scans the default channel list for its whole duration with a remote heard only on the third channel
+static xiaomi_scan_result_t test_scan_one_channel(uint8_t strategy) {
+    harness_remote_t remote = test_remote();
+    remote.channel_count = 1;
+    remote.channels[0] = xiaomi_channels[2];
+    CHECK(harness_remote_start(&remote));
+    nrf24_scan_options_t options;
+    nrf24_scan_options_default(&options);
+    options.strategy = strategy;
+    options.rule.frames = 0;
+    CHECK_EQ(nrf24_scan_xiaomi(1200, &options), ESP_OK);
+    harness_remote_stop_all();
+    return *nrf24_get_last_scan_result();
+}
+
+static void test_scan_strategies(void) {
+    xiaomi_scan_result_t even = test_scan_one_channel(NRF24_SCAN_ROUND_ROBIN);
+    xiaomi_scan_result_t adaptive = test_scan_one_channel(NRF24_SCAN_ADAPTIVE);
+    CHECK_EQ(even.strategy, NRF24_SCAN_ROUND_ROBIN);
+    CHECK_EQ(adaptive.strategy, NRF24_SCAN_ADAPTIVE);
+    CHECK_EQ(adaptive.channel_count, sizeof(xiaomi_channels));
+
+    // Round robin splits the time evenly, adaptive moves it to the busy channel and keeps exploring the others
+    uint32_t busy_even = even.channels[2].dwell_ms;
+    uint32_t busy_adaptive = adaptive.channels[2].dwell_ms;
+    for (size_t c = 0; c < sizeof(xiaomi_channels); c++) {
+        CHECK_EQ(adaptive.channels[c].channel, xiaomi_channels[c]);
+        CHECK(even.channels[c].dwell_ms * 100 >= even.listened_ms * 15);
+        CHECK(adaptive.channels[c].dwell_ms > 0);
+        if (c != 2) {
+            CHECK_EQ(adaptive.channels[c].frames, 0);
+            CHECK(busy_adaptive > adaptive.channels[c].dwell_ms * 3);
+        }
+    }
+    CHECK(busy_adaptive * 100 >= adaptive.listened_ms * 50);
+    CHECK(busy_adaptive > busy_even);
+    CHECK(adaptive.channels[2].frames > even.channels[2].frames);
+}
+
+static void test_rx_irq_wakes_scan(void) {
+    // A few frames in the middle of a dwell on one channel: RX_DR reaches the scan through the IRQ line of the
+    // model, so each frame is decoded right away instead of at the end of the 20 ms dwell
+    nrf24_scan_options_t options;
+    nrf24_scan_options_default(&options);
+    options.strategy = NRF24_SCAN_ADAPTIVE;
+    options.channel_count = 1;
+    options.channels[0] = xiaomi_channels[2];
+    options.rule.frames = 0;
+    options.rule.channels = 0;
+    uint32_t scan_id = 0;
+    CHECK_EQ(nrf24_scan_start(400, &options, &scan_id), ESP_OK);
+
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    uint8_t cmd = 0;
+    uint8_t param = 0;
+    xiaomi_command_encode(&toggle, &cmd, &param);
+    usleep(150 * 1000);
+    uint32_t edges = harness_irq_edges();
+    for (int i = 0; i < 3; i++) {
+        harness_remote_inject(xiaomi_channels[2], TEST_REMOTE_ID, 0x10, cmd, param);
+        usleep(2 * 1000);
+    }
+
+    nrf24_scan_status_t status = {0};
+    for (int i = 0; i < 100 && !status.done; i++) {
+        usleep(20 * 1000);
+        if (nrf24_scan_get_status(scan_id, &status) != ESP_OK) {
+            break;
+        }
+    }
+    CHECK(status.done);
+    CHECK(harness_irq_edges() > edges);
+    CHECK(status.scan.found_count >= 1);
+    CHECK_EQ(status.scan.remote_id, TEST_REMOTE_ID);
+    // The latency is only stamped by an IRQ edge
+    CHECK(status.scan.max_decode_latency_us > 0);
+    CHECK(status.scan.max_decode_latency_us < 5000);
+}
+
+/// @brief Puts a remote frame on air behind a 4-byte sync word, so it locks only the pipe listening for that word
+static void test_inject_behind(uint8_t channel, const uint8_t* sync, uint8_t seq) {
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    uint8_t cmd = 0;
+    uint8_t param = 0;
+    xiaomi_command_encode(&toggle, &cmd, &param);
+
+    uint8_t bits[4 + 64];
+    memcpy(bits, sync, 4);
+    size_t nbits = harness_remote_frame(TEST_REMOTE_ID, seq, cmd, param, &bits[4]);
+    harness_lock();
+    nrf24_emu_air_inject(harness_air(), channel, 2000, bits, 32 + nbits);
+    harness_unlock();
+}
+
+/// @brief Listens on one channel for 400 ms while frames behind the P1 and P5 sync words of the multi-pipe profile
+/// are on air
+static void test_listen_pipes_1_5(nrf24_stats_t* before, nrf24_stats_t* after) {
+    // Preamble and 3-byte address on air, first byte first
+    static const uint8_t sync_p1[4] = {0x55, 0x00, 0x00, 0x55};
+    static const uint8_t sync_p5[4] = {0x55, 0x00, 0x00, 0x22};
+
+    nrf24_scan_options_t options;
+    nrf24_scan_options_default(&options);
+    options.channel_count = 1;
+    options.channels[0] = xiaomi_channels[2];
+    options.rule.frames = 0;
+    options.rule.channels = 0;
+
+    nrf24_get_stats(before);
+    nrf24_job_t* scan = NULL;
+    CHECK_EQ(nrf24_submit_scan(400, &options, &scan), ESP_OK);
+    usleep(50 * 1000);
+    for (uint8_t seq = 0; seq < 20; seq++) {
+        test_inject_behind(xiaomi_channels[2], (seq & 1) ? sync_p5 : sync_p1, seq);
+        usleep(5 * 1000);
+    }
+    CHECK_EQ(nrf24_job_wait(scan, 2000), ESP_OK);
+    nrf24_job_release(scan);
+    nrf24_get_stats(after);
+}
+
+static void test_multipipe_profile(void) {
+    nrf24_stats_t before;
+    nrf24_stats_t after;
+    bool stored = false;
+
+    CHECK(!nrf24_capture_multipipe_enabled());
+    CHECK_EQ(nrf24_capture_multipipe(true), ESP_OK);
+    CHECK(nrf24_capture_multipipe_enabled());
+    CHECK(nvs_load_nrf24_multipipe(&stored));
+    CHECK(stored);
+
+    // Each payload is counted on the pipe whose sync word it followed, and both decode
+    test_listen_pipes_1_5(&before, &after);
+    CHECK(after.rx_pipe_payloads[1] > before.rx_pipe_payloads[1]);
+    CHECK(after.rx_pipe_payloads[5] > before.rx_pipe_payloads[5]);
+    CHECK(after.rx_pipe_decoded[1] > before.rx_pipe_decoded[1]);
+    CHECK(after.rx_pipe_decoded[5] > before.rx_pipe_decoded[5]);
+    CHECK_EQ(nrf24_get_last_scan_result()->remote_id, TEST_REMOTE_ID);
+
+    // The single pipe profile keeps pipes 1..5 closed
+    CHECK_EQ(nrf24_capture_multipipe(false), ESP_OK);
+    CHECK(!nrf24_capture_multipipe_enabled());
+    CHECK(nvs_load_nrf24_multipipe(&stored));
+    CHECK(!stored);
+    test_listen_pipes_1_5(&before, &after);
+    for (int pipe = 1; pipe < NRF24_RX_PIPES; pipe++) {
+        CHECK_EQ(after.rx_pipe_payloads[pipe], before.rx_pipe_payloads[pipe]);
+    }
+}
+
+static void test_scan_without_remote(void) {
+    CHECK_EQ(nrf24_scan_xiaomi(200, NULL), ESP_ERR_NOT_FOUND);
+    CHECK_EQ(nrf24_get_last_scan_result()->found_count, 0);
+}
+
+static void test_send_preempts_scan(void) {
+    nrf24_stats_t before;
+    nrf24_get_stats(&before);
+    nrf24_job_t* scan = NULL;
+    CHECK_EQ(nrf24_submit_scan(TEST_PREEMPT_SCAN_MS, NULL, &scan), ESP_OK);
+    usleep(300 * 1000);
+
+    // The burst cuts the dwell it lands in short instead of waiting for the scan
+    uint32_t id = TEST_REMOTE_ID;
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    CHECK_EQ(nrf24_send_xiaomi_burst(&id, 1, &toggle, 1), ESP_OK);
+    nrf24_stats_t stats;
+    nrf24_get_stats(&stats);
+    CHECK(stats.tx_wait_last_us < TEST_PREEMPT_WAIT_MAX_US);
+    CHECK(stats.tx_wait_max_us < TEST_PREEMPT_WAIT_MAX_US);
+    CHECK_EQ(stats.scan_preemptions - before.scan_preemptions, 1);
+
+    // Suspended time is not listening time, the resumed scan still listens for the whole duration, give or take the
+    // dwell the deadline falls in
+    CHECK_EQ(nrf24_job_wait(scan, TEST_PREEMPT_SCAN_MS + 2000), ESP_ERR_NOT_FOUND);
+    nrf24_job_release(scan);
+    const xiaomi_scan_result_t* result = nrf24_get_last_scan_result();
+    CHECK(result->listened_ms >= TEST_PREEMPT_SCAN_MS);
+    CHECK(result->listened_ms < TEST_PREEMPT_SCAN_MS + 2 * TEST_PREEMPT_DWELL_MS);
+}
+
+typedef struct {
+    uint8_t data[sizeof(nrf24_trace_header_t) + NRF24_TRACE_CAPACITY * sizeof(nrf24_trace_record_t)];
+    size_t len;
+    esp_err_t nested;
+} test_trace_dump_t;
+
+static esp_err_t test_trace_sink(void* ctx, const void* data, size_t len) {
+    test_trace_dump_t* dump = ctx;
+    if (dump->len + len > sizeof(dump->data)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(&dump->data[dump->len], data, len);
+    dump->len += len;
+
+    // A second export while this one streams is refused
+    dump->nested = nrf24_trace_export(test_trace_sink, dump);
+    return ESP_OK;
+}
+
+static void test_trace_export(void) {
+    static test_trace_dump_t dump;
+    CHECK_EQ(nrf24_trace_export(test_trace_sink, &dump), ESP_OK);
+    CHECK_EQ(dump.nested, ESP_ERR_INVALID_STATE);
+
+    nrf24_trace_header_t header;
+    CHECK(dump.len >= sizeof(header));
+    memcpy(&header, dump.data, sizeof(header));
+    CHECK_EQ(header.magic, NRF24_TRACE_MAGIC);
+    CHECK_EQ(header.version, NRF24_TRACE_VERSION);
+    CHECK_EQ(header.record_size, sizeof(nrf24_trace_record_t));
+    CHECK(header.count > 0);
+    CHECK_EQ(dump.len, sizeof(header) + header.count * sizeof(nrf24_trace_record_t));
+
+    // Records are in order on the esp_timer clock and none is newer than the dump
+    const nrf24_trace_record_t* records = (const nrf24_trace_record_t*)&dump.data[sizeof(header)];
+    uint32_t now = (uint32_t)header.timer_now_us;
+    for (uint32_t i = 0; i < header.count; i++) {
+        CHECK(records[i].event >= NRF24_TRACE_PROFILE && records[i].event <= NRF24_TRACE_DECODE_FAIL);
+        CHECK((int32_t)(now - records[i].time_us) >= 0);
+        if (i > 0) {
+            CHECK((int32_t)(records[i].time_us - records[i - 1].time_us) >= 0);
+        }
+    }
+}
+
+static void test_send_reaches_light(void) {
+    static nrf24_emu_t light;
+    CHECK(harness_light_init(&light, 43));
+
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    uint8_t cmd = 0;
+    uint8_t param = 0;
+    xiaomi_command_encode(&toggle, &cmd, &param);
+
+    nrf24_stats_t before;
+    nrf24_get_stats(&before);
+    uint32_t id = TEST_REMOTE_ID;
+    CHECK_EQ(nrf24_send_xiaomi_burst(&id, 1, &toggle, 1), ESP_OK);
+
+    // Two passes over the channels, so the light hears the frame twice
+    uint8_t frames[4][32];
+    size_t count = harness_light_read(&light, frames, 4);
+    CHECK_EQ(count, 2);
+    CHECK(memcmp(frames[0], frames[1], XIAOMI_FRAME_LEN) == 0);
+
+    bool matched = false;
+    for (unsigned seq = 0; seq < 256 && !matched; seq++) {
+        uint8_t expected[XIAOMI_FRAME_LEN];
+        xiaomi_build_frame(TEST_REMOTE_ID, (uint8_t)seq, cmd, param, expected);
+        matched = memcmp(frames[0], expected, XIAOMI_FRAME_LEN) == 0;
+    }
+    CHECK(matched);
+
+    // Every hop of both passes over the 4 channels completed, one frame each
+    nrf24_stats_t stats;
+    nrf24_get_stats(&stats);
+    CHECK(stats.tx_last_burst_us > 0);
+    CHECK_EQ(stats.tx_frames - before.tx_frames, 2 * sizeof(xiaomi_channels));
+}
+
+static void test_blind_toggle_records_power(void) {
+    const uint32_t id = 0x5A5A01;
+    const xiaomi_target_t on = {
+        .power = XIAOMI_POWER_ON,
+        .brightness = XIAOMI_LEVEL_UNKNOWN,
+        .temperature = XIAOMI_LEVEL_UNKNOWN,
+    };
+
+    size_t frames = 0;
+    CHECK_EQ(xiaomi_state_send(&id, 1, &on, &frames), ESP_OK);
+    CHECK_EQ(frames, 1);
+    xiaomi_state_t state;
+    CHECK(xiaomi_state_get(id, &state));
+    CHECK_EQ(state.power, XIAOMI_POWER_ON);
+
+    // A repeated on must not toggle the bar back off
+    CHECK_EQ(xiaomi_state_send(&id, 1, &on, &frames), ESP_OK);
+    CHECK_EQ(frames, 0);
+
+    // A toggle of the physical remote decoded by the sniffer corrects the recorded state, the next on sends again
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    xiaomi_state_apply(id, &toggle);
+    CHECK(xiaomi_state_get(id, &state));
+    CHECK_EQ(state.power, XIAOMI_POWER_OFF);
+    CHECK_EQ(xiaomi_state_send(&id, 1, &on, &frames), ESP_OK);
+    CHECK_EQ(frames, 1);
+}
+
+static void test_abandoned_send_stays_off_air(void) {
+    static nrf24_emu_t light;
+    CHECK(harness_light_init(&light, 43));
+
+    nrf24_stats_t before;
+    nrf24_get_stats(&before);
+
+    // Stall the radio task inside a connection check by holding the air, so the burst times out while queued
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    uint32_t id = TEST_REMOTE_ID;
+    harness_lock();
+    CHECK_EQ(nrf24_submit_check(NULL), ESP_OK);
+    usleep(50 * 1000);
+    CHECK_EQ(nrf24_send_xiaomi_burst(&id, 1, &toggle, 1), ESP_ERR_TIMEOUT);
+    harness_unlock();
+
+    CHECK_EQ(nrf24_check_connection(), ESP_OK);
+    uint8_t frames[4][32];
+    CHECK_EQ(harness_light_read(&light, frames, 4), 0);
+
+    nrf24_stats_t after;
+    nrf24_get_stats(&after);
+    CHECK_EQ(after.tx_frames, before.tx_frames);
+}
+
+static void test_hold_reserves_sequence_once(void) {
+    uint32_t id = TEST_REMOTE_ID;
+    uint32_t hold_id = 0;
+    uint32_t commits = host_nvs_commits();
+    CHECK_EQ(nrf24_hold_start(&id, 1, XIAOMI_CMD_HIGHER, 40, NRF24_HOLD_PERIOD_MIN_MS, &hold_id), ESP_OK);
+
+    nrf24_hold_status_t status = {0};
+    for (int i = 0; i < 300 && !status.done; i++) {
+        usleep(10 * 1000);
+        CHECK_EQ(nrf24_hold_get_status(hold_id, &status), ESP_OK);
+    }
+    CHECK(status.done);
+    CHECK_EQ(status.result, ESP_OK);
+    CHECK_EQ(status.steps_sent, 40);
+
+    // 40 steps span three blocks of sequence numbers, the hold reserves them with a single commit
+    CHECK_EQ(host_nvs_commits() - commits, 1);
+}
+
+static void test_hold_outlasts_queued_check(void) {
+    uint32_t id = TEST_REMOTE_ID;
+    uint32_t hold_id = 0;
+    CHECK_EQ(nrf24_hold_start(&id, 1, XIAOMI_CMD_HIGHER, 0, NRF24_HOLD_PERIOD_MIN_MS, &hold_id), ESP_OK);
+
+    // A second start is refused at once instead of waiting for the first hold to end
+    uint32_t other_id = 0;
+    CHECK_EQ(nrf24_hold_start(&id, 1, XIAOMI_CMD_LOWER, 0, NRF24_HOLD_PERIOD_MIN_MS, &other_id), ESP_ERR_INVALID_STATE);
+
+    // A command of the normal queue waits for the hold instead of ending it
+    nrf24_job_t* check = NULL;
+    CHECK_EQ(nrf24_submit_check(&check), ESP_OK);
+    usleep(200 * 1000);
+    nrf24_hold_status_t status = {0};
+    CHECK_EQ(nrf24_hold_get_status(hold_id, &status), ESP_OK);
+    CHECK(!status.done);
+    CHECK(status.steps_sent >= 5);
+    CHECK(!nrf24_job_poll(check, NULL));
+
+    // A send to the bars cuts it short, then the check runs
+    const xiaomi_action_t toggle = {.command = XIAOMI_CMD_POWER_TOGGLE};
+    CHECK_EQ(nrf24_send_xiaomi_burst(&id, 1, &toggle, 1), ESP_OK);
+    CHECK_EQ(nrf24_hold_get_status(hold_id, &status), ESP_OK);
+    CHECK(status.done);
+    CHECK_EQ(status.result, ESP_ERR_INVALID_STATE);
+    CHECK_EQ(nrf24_job_wait(check, 1000), ESP_OK);
+    nrf24_job_release(check);
+}
+
+int main(void) {
+    esp_log_level_set("*", ESP_LOG_WARN);
+    if (!harness_init()) {
+        fprintf(stderr, "harness init failed\n");
+        return 1;
+    }
+
+    RUN_TEST(test_check_connection);
+    RUN_TEST(test_survey_opt_in);
+    RUN_TEST(test_scan_decodes_remote);
+    RUN_TEST(test_scan_start_saves_remote);
+    RUN_TEST(test_scan_counts_presses);
+    RUN_TEST(test_scan_strategies);
+    RUN_TEST(test_rx_irq_wakes_scan);
+    RUN_TEST(test_multipipe_profile);
+    RUN_TEST(test_scan_without_remote);
+    RUN_TEST(test_send_preempts_scan);
+    RUN_TEST(test_trace_export);
+    RUN_TEST(test_send_reaches_light);
+    RUN_TEST(test_blind_toggle_records_power);
+    RUN_TEST(test_abandoned_send_stays_off_air);
+    RUN_TEST(test_hold_reserves_sequence_once);
+    RUN_TEST(test_hold_outlasts_queued_check);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,140 @@
+#include <string.h>
+
+#include "host_test.h"
+#include "xiaomi_topk.h"
+
+// The space-saving heavy hitter table against exact counts of the same stream
+
+#define TEST_STREAM_LEN 50000
+#define TEST_NOISE_KEYS 500
+#define TEST_HEAVY_KEYS 4
+
+static uint32_t test_random_state = 0x5EED70B7;
+
+static uint32_t test_random(void) {
+    test_random_state ^= test_random_state << 13;
+    test_random_state ^= test_random_state >> 17;
+    test_random_state ^= test_random_state << 5;
+    return test_random_state;
+}
+
+static void test_exact_below_capacity(void) {
+    static const uint32_t counts[] = {5, 1, 9, 3, 7};
+    xiaomi_topk_t topk;
+    xiaomi_topk_reset(&topk);
+
+    // Interleaved, so the order of first sight is not the order of the counts
+    for (uint32_t round = 0; round < 9; round++) {
+        for (size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); k++) {
+            if (round < counts[k]) {
+                xiaomi_topk_add(&topk, 0x1000 + k);
+            }
+        }
+    }
+    CHECK_EQ(topk.total, 25);
+    CHECK_EQ(topk.used, 5);
+
+    xiaomi_topk_entry_t out[XIAOMI_TOPK_SLOTS];
+    CHECK_EQ(xiaomi_topk_sorted(&topk, out, XIAOMI_TOPK_SLOTS), 5);
+    static const uint64_t order[] = {0x1002, 0x1004, 0x1000, 0x1003, 0x1001};
+    for (size_t i = 0; i < 5; i++) {
+        CHECK_EQ(out[i].key, order[i]);
+        CHECK_EQ(out[i].count, counts[order[i] - 0x1000]);
+        CHECK_EQ(out[i].error, 0);
+    }
+
+    // A short output gets the top of the list
+    CHECK_EQ(xiaomi_topk_sorted(&topk, out, 2), 2);
+    CHECK_EQ(out[0].key, 0x1002);
+    CHECK_EQ(out[1].key, 0x1004);
+
+    xiaomi_topk_reset(&topk);
+    CHECK_EQ(topk.total, 0);
+    CHECK_EQ(xiaomi_topk_sorted(&topk, out, XIAOMI_TOPK_SLOTS), 0);
+}
+
+static void test_takeover_inherits_error(void) {
+    xiaomi_topk_t topk;
+    xiaomi_topk_reset(&topk);
+    for (uint64_t key = 0; key < XIAOMI_TOPK_SLOTS; key++) {
+        xiaomi_topk_add(&topk, key);
+        xiaomi_topk_add(&topk, key);
+    }
+    // Evicts one of the count 2 keys and claims 3, of which 2 may belong to the evicted key
+    xiaomi_topk_add(&topk, 0xFF);
+    CHECK_EQ(topk.used, XIAOMI_TOPK_SLOTS);
+
+    xiaomi_topk_entry_t out[XIAOMI_TOPK_SLOTS];
+    CHECK_EQ(xiaomi_topk_sorted(&topk, out, XIAOMI_TOPK_SLOTS), XIAOMI_TOPK_SLOTS);
+    CHECK_EQ(out[0].key, 0xFF);
+    CHECK_EQ(out[0].count, 3);
+    CHECK_EQ(out[0].error, 2);
+
+    // Same count, the exact one ranks first
+    for (int i = 0; i < 3; i++) {
+        xiaomi_topk_add(&topk, out[1].key);
+    }
+    xiaomi_topk_entry_t tied = out[1];
+    xiaomi_topk_add(&topk, 0xFF);
+    xiaomi_topk_add(&topk, 0xFF);
+    CHECK_EQ(xiaomi_topk_sorted(&topk, out, XIAOMI_TOPK_SLOTS), XIAOMI_TOPK_SLOTS);
+    CHECK_EQ(out[0].key, tied.key);
+    CHECK_EQ(out[0].count, 5);
+    CHECK_EQ(out[0].error, 0);
+    CHECK_EQ(out[1].key, 0xFF);
+    CHECK_EQ(out[1].count, 5);
+}
+
+static void test_heavy_hitters_kept(void) {
+    // Four keys at 15 % each on top of a wide noise floor, every one is above total / XIAOMI_TOPK_SLOTS
+    static uint32_t truth[TEST_NOISE_KEYS + TEST_HEAVY_KEYS];
+    memset(truth, 0, sizeof(truth));
+    xiaomi_topk_t topk;
+    xiaomi_topk_reset(&topk);
+
+    for (uint32_t i = 0; i < TEST_STREAM_LEN; i++) {
+        uint32_t roll = test_random() % 100;
+        uint32_t key = (roll < 15 * TEST_HEAVY_KEYS) ? TEST_NOISE_KEYS + roll / 15
+                                                     : test_random() % TEST_NOISE_KEYS;
+        truth[key]++;
+        xiaomi_topk_add(&topk, key);
+    }
+    CHECK_EQ(topk.total, TEST_STREAM_LEN);
+
+    xiaomi_topk_entry_t out[XIAOMI_TOPK_SLOTS];
+    size_t count = xiaomi_topk_sorted(&topk, out, XIAOMI_TOPK_SLOTS);
+    CHECK_EQ(count, XIAOMI_TOPK_SLOTS);
+
+    // Every slot brackets the true count, and the counts add up to the stream length
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t actual = truth[out[i].key];
+        CHECK(out[i].count >= actual);
+        CHECK(out[i].count - out[i].error <= actual);
+        CHECK(out[i].error <= TEST_STREAM_LEN / XIAOMI_TOPK_SLOTS);
+        sum += out[i].count;
+    }
+    CHECK_EQ(sum, TEST_STREAM_LEN);
+
+    for (uint32_t key = 0; key < TEST_NOISE_KEYS + TEST_HEAVY_KEYS; key++) {
+        if (truth[key] <= TEST_STREAM_LEN / XIAOMI_TOPK_SLOTS) {
+            continue;
+        }
+        bool kept = false;
+        for (size_t i = 0; i < count; i++) {
+            kept |= out[i].key == key;
+        }
+        CHECK(kept);
+    }
+    // The heavy keys themselves made it past the threshold, otherwise the loop above checked nothing
+    for (uint32_t h = 0; h < TEST_HEAVY_KEYS; h++) {
+        CHECK(truth[TEST_NOISE_KEYS + h] > TEST_STREAM_LEN / XIAOMI_TOPK_SLOTS);
+    }
+}
+
+int main(void) {
+    RUN_TEST(test_exact_below_capacity);
+    RUN_TEST(test_takeover_inherits_error);
+    RUN_TEST(test_heavy_hitters_kept);
+    return HOST_TEST_RESULT();
+}